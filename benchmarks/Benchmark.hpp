@@ -0,0 +1,58 @@
+//===-- Benchmark.hpp ------------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Minimal timing helpers shared by the benchmarks
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace bwsl::benchmark {
+
+/// Prevent the compiler from optimizing away @p value
+template<class T>
+inline auto
+DoNotOptimize(T const& value) -> void
+{
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// Run @p f , which performs @p ops operations, @p repeat times and print the
+/// best time per operation in nanoseconds.
+template<class F>
+inline auto
+Measure(std::string const& name, std::size_t ops, F&& f, int repeat = 5)
+  -> double
+{
+  auto best = 1e300;
+  for (auto r = 0; r < repeat; r++) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::duration<double, std::nano>(stop - start);
+    best = std::min(best, elapsed.count() / static_cast<double>(ops));
+  }
+  std::cout << std::left << std::setw(40) << name << std::right
+            << std::setw(10) << std::fixed << std::setprecision(2) << best
+            << " ns/op\n";
+  return best;
+}
+
+} // namespace bwsl::benchmark
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
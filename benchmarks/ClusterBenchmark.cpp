@@ -0,0 +1,101 @@
+//===-- ClusterBenchmark.cpp -----------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Benchmark of the cluster updates at the Ising critical point
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include "Benchmark.hpp"
+#include <bwsl/ClusterUpdate.hpp>
+#include <bwsl/Lattice.hpp>
+#include <bwsl/ThreadPool.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace bwsl;
+using bwsl::benchmark::DoNotOptimize;
+using bwsl::benchmark::Measure;
+
+/// Time the updates of the Ising model on @p lattice at inverse temperature
+/// @p beta with @p numthreads threads
+auto
+run(std::string const& label,
+    Lattice const& lattice,
+    double beta,
+    std::size_t numthreads) -> void
+{
+  const auto n = lattice.GetNumSites();
+  const auto p = ClusterUpdate::GetBondProbability(beta);
+  const auto steps = 20UL;
+  auto pool = ThreadPool(numthreads);
+  auto update = ClusterUpdate(lattice.GetBondTable(), 2022UL);
+  auto spins = std::vector<std::int8_t>(n, 1);
+
+  // thermalize first, near criticality the clusters span the lattice
+  for (auto s = 0UL; s < steps; s++) {
+    update.SwendsenWang(pool, spins, p);
+  }
+
+  std::cout << label << " (" << n << " sites, " << pool.GetNumThreads()
+            << " threads)\n";
+
+  Measure("  Swendsen-Wang per site", steps * n, [&]() {
+    auto clusters = 0UL;
+    for (auto s = 0UL; s < steps; s++) {
+      clusters += update.SwendsenWang(pool, spins, p);
+    }
+    DoNotOptimize(clusters);
+  });
+
+  auto flipped = 0UL;
+  Measure("  Wolff per update", steps, [&]() {
+    flipped = 0UL;
+    for (auto s = 0UL; s < steps; s++) {
+      flipped += update.Wolff(pool, spins, p);
+    }
+    DoNotOptimize(flipped);
+  });
+  std::cout << "  average Wolff cluster " << flipped / steps << " sites\n";
+}
+
+int
+main()
+{
+  // critical couplings of the square and of the simple cubic Ising models
+  const auto square = 0.5 * std::log(1.0 + std::sqrt(2.0));
+  const auto cubic = 0.2216544;
+  const auto all = static_cast<std::size_t>(
+    std::max(1U, std::thread::hardware_concurrency()));
+
+  auto plane = Lattice(SquareLattice, { 512UL, 512UL });
+  auto space = Lattice(CubicLattice, { 64UL, 64UL, 64UL });
+  auto threads = std::vector<std::size_t>{ 1UL };
+  if (all > 1UL) {
+    threads.push_back(all);
+  }
+  for (auto numthreads : threads) {
+    run("SquareLattice 512x512", plane, square, numthreads);
+    run("CubicLattice 64x64x64", space, cubic, numthreads);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
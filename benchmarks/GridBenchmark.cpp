@@ -0,0 +1,91 @@
+//===-- GridBenchmark.cpp --------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Benchmark of the geometry queries of HyperCubicGrid
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include "Benchmark.hpp"
+#include <bwsl/HyperCubicGrid.hpp>
+
+// std
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace bwsl;
+using bwsl::benchmark::DoNotOptimize;
+using bwsl::benchmark::Measure;
+
+/// Time wrapping, mapping and jumps on @p grid
+template<class G>
+auto
+run(std::string const& label, G const& grid) -> void
+{
+  const auto n = grid.GetNumSites();
+  const auto npairs = 4000000UL;
+
+  std::cout << label << " (" << n << " sites)\n";
+
+  Measure("  EnforceBoundaries", npairs, [&]() {
+    auto c = grid.MakeCoords();
+    for (auto k = 0UL; k < npairs; k++) {
+      for (auto& x : c) {
+        x += static_cast<long>(k % 7UL) - 3L;
+      }
+      grid.EnforceBoundaries(c);
+      DoNotOptimize(c);
+    }
+  });
+
+  Measure("  GetMappedSite", npairs, [&]() {
+    auto sum = 0UL;
+    for (auto k = 0UL; k < npairs; k++) {
+      sum += grid.GetMappedSite(k % n, (k * 7919UL) % n);
+    }
+    DoNotOptimize(sum);
+  });
+
+  Measure("  GetUnMappedSite", npairs, [&]() {
+    auto sum = 0UL;
+    for (auto k = 0UL; k < npairs; k++) {
+      sum += grid.GetUnMappedSite(k % n, (k * 7919UL) % n);
+    }
+    DoNotOptimize(sum);
+  });
+
+  Measure("  GetJump", npairs, [&]() {
+    auto sum = 0L;
+    for (auto k = 0UL; k < npairs; k++) {
+      sum += grid.GetJump(k % n, (k * 7919UL) % n)[0];
+    }
+    DoNotOptimize(sum);
+  });
+}
+
+int
+main()
+{
+  // grids of similar size, the first one uses the power of two fast path
+  run("HyperCubicGrid 32x32x32",
+      HyperCubicGrid({ 32UL, 32UL, 32UL }, GridBoundaries::Closed));
+  run("HyperCubicGrid 31x31x31",
+      HyperCubicGrid({ 31UL, 31UL, 31UL }, GridBoundaries::Closed));
+  run("HyperCubicGrid3D 32x32x32",
+      HyperCubicGrid3D({ 32UL, 32UL, 32UL }, GridBoundaries::Closed));
+  run("HyperCubicGrid3D 31x31x31",
+      HyperCubicGrid3D({ 31UL, 31UL, 31UL }, GridBoundaries::Closed));
+
+  return EXIT_SUCCESS;
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
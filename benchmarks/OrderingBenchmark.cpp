@@ -0,0 +1,93 @@
+//===-- OrderingBenchmark.cpp ----------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Benchmark of lattice sweeps with different site orderings
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include "Benchmark.hpp"
+#include <bwsl/Lattice.hpp>
+
+// std
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace bwsl;
+using bwsl::benchmark::DoNotOptimize;
+using bwsl::benchmark::Measure;
+
+/// Time sweeps summing the neighbors of every site of a cubic lattice of side
+/// @p side numbered with @p ordering
+auto
+run(std::string const& label, std::size_t side, GridOrdering ordering) -> void
+{
+  auto options = LatticeOptions{};
+  options.ordering = ordering;
+  auto lattice = Lattice(
+    CubicLattice, { side, side, side }, GridBoundaries::Closed, options);
+  auto const& table = lattice.GetNeighborTable();
+  const auto n = lattice.GetNumSites();
+  const auto sweeps = 10UL;
+
+  auto spins = std::vector<double>(n);
+  for (auto i = 0UL; i < n; i++) {
+    spins[i] = (lattice.GetRowMajorIndex(i) % 3UL == 0UL) ? 1.0 : -1.0;
+  }
+
+  std::cout << label << " (" << n << " sites)\n";
+
+  Measure("  Neighbor sum sweep", sweeps * n, [&]() {
+    auto energy = 0.0;
+    for (auto s = 0UL; s < sweeps; s++) {
+      for (auto i = 0UL; i < n; i++) {
+        auto field = 0.0;
+        for (auto j : table.GetNeighbors(i)) {
+          field += spins[j];
+        }
+        energy += spins[i] * field;
+      }
+    }
+    DoNotOptimize(energy);
+  });
+
+  Measure("  Neighbor sum random order", sweeps * n, [&]() {
+    auto energy = 0.0;
+    for (auto s = 0UL; s < sweeps; s++) {
+      for (auto k = 0UL; k < n; k++) {
+        const auto i = (k * 7919UL) % n;
+        auto field = 0.0;
+        for (auto j : table.GetNeighbors(i)) {
+          field += spins[j];
+        }
+        energy += spins[i] * field;
+      }
+    }
+    DoNotOptimize(energy);
+  });
+}
+
+int
+main()
+{
+  // the slow axis of the row-major lattice is side^2 sites away
+  for (auto side : { 64UL, 96UL }) {
+    const auto name = std::to_string(side) + "^3";
+    run("Row-major " + name, side, GridOrdering::RowMajor);
+    run("Morton " + name, side, GridOrdering::Morton);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
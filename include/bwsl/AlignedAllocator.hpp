@@ -0,0 +1,96 @@
+//===-- AlignedAllocator.hpp -----------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the AlignedAllocator Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// std
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <vector>
+
+namespace bwsl {
+
+/// Default alignment in bytes, a cache line and a full AVX-512 register
+constexpr std::size_t DefaultAlignment = 64UL;
+
+///
+/// Allocator returning memory aligned to @p Alignment bytes.
+/// Used to store tables which are streamed in vectorized loops.
+///
+template<class T, std::size_t Alignment = DefaultAlignment>
+class AlignedAllocator
+{
+public:
+  static_assert(Alignment >= alignof(T), "Alignment too small for the type");
+  static_assert((Alignment & (Alignment - 1UL)) == 0UL,
+                "Alignment must be a power of two");
+
+  using value_type = T;
+
+  template<class U>
+  struct rebind
+  {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  /// Default constructor
+  AlignedAllocator() noexcept = default;
+
+  /// Converting constructor
+  template<class U>
+  AlignedAllocator(AlignedAllocator<U, Alignment> const& /*that*/) noexcept
+  {
+  }
+
+  /// Allocate memory for @p n objects
+  [[nodiscard]] auto allocate(std::size_t n) -> T*
+  {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    return static_cast<T*>(
+      ::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+  }
+
+  /// Release the memory
+  auto deallocate(T* p, std::size_t /*n*/) noexcept -> void
+  {
+    ::operator delete(p, std::align_val_t(Alignment));
+  }
+}; // class AlignedAllocator
+
+template<class T, class U, std::size_t Alignment>
+inline auto
+operator==(AlignedAllocator<T, Alignment> const& /*a*/,
+           AlignedAllocator<U, Alignment> const& /*b*/) -> bool
+{
+  return true;
+}
+
+template<class T, class U, std::size_t Alignment>
+inline auto
+operator!=(AlignedAllocator<T, Alignment> const& /*a*/,
+           AlignedAllocator<U, Alignment> const& /*b*/) -> bool
+{
+  return false;
+}
+
+/// Vector with aligned storage
+template<class T, std::size_t Alignment = DefaultAlignment>
+using aligned_vector = std::vector<T, AlignedAllocator<T, Alignment>>;
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,207 @@
+//===-- BondTable.hpp ------------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the BondTable Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/NeighborTable.hpp>
+#include <bwsl/Span.hpp>
+
+// std
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Bonds between the nearest neighbors of a lattice, each one stored once.
+///
+/// The bond `k` goes from `GetFirst(k)` to `GetSecond(k)` along the positive
+/// direction `2 m` of the Bravais lattice, `m = GetDirection(k)`. The bonds
+/// are numbered by their first site, and by direction for the same site, so
+/// that the bonds of a site are contiguous. Both slots of the neighbor table
+/// holding the bond, one for each site, map to it, hence observables on the
+/// bonds can be stored in plain arrays with one entry per bond.
+///
+/// With closed boundaries a bond can cross the boundaries of the grid, the
+/// crossed directions are stored as a bit mask.
+///
+class BondTable
+{
+public:
+  /// Type for the site and bond indices
+  using index_t = std::size_t;
+
+  /// Type of the directions
+  using direction_t = NeighborTable::slot_t;
+
+  /// Type of the masks of the crossed directions
+  using crossing_t = std::uint8_t;
+
+  /// View over the sites of all the bonds
+  using span_t = Span<index_t const>;
+
+  /// Value returned for slots which do not exist
+  static constexpr index_t NoBond = std::numeric_limits<index_t>::max();
+
+  /// Default constructor
+  BondTable() = default;
+
+  /// Build the bonds of the nearest neighbors in @p table , where
+  /// `crossing(a, slot)` is the mask of the directions of the grid crossed
+  /// going from site a to the neighbor in slot `slot`
+  template<class F>
+  BondTable(NeighborTable const& table, F&& crossing);
+
+  /// Copy constructor
+  BondTable(BondTable const& that) = default;
+
+  /// Move constructor
+  BondTable(BondTable&& that) = default;
+
+  /// Copy assignment operator
+  auto operator=(BondTable const& that) -> BondTable& = default;
+
+  /// Move assignment operator
+  auto operator=(BondTable&& that) -> BondTable& = default;
+
+  /// Default destructor
+  virtual ~BondTable() = default;
+
+  /// Get the number of sites
+  [[nodiscard]] auto GetNumSites() const -> std::size_t
+  {
+    return slotoffsets_.empty() ? 0UL : slotoffsets_.size() - 1UL;
+  }
+
+  /// Get the number of bonds
+  [[nodiscard]] auto GetNumBonds() const -> std::size_t
+  {
+    return first_.size();
+  }
+
+  /// Get the first site of bond @p k
+  [[nodiscard]] auto GetFirst(index_t k) const -> index_t
+  {
+    assert(k < first_.size());
+    return first_[k];
+  }
+
+  /// Get the second site of bond @p k
+  [[nodiscard]] auto GetSecond(index_t k) const -> index_t
+  {
+    assert(k < second_.size());
+    return second_[k];
+  }
+
+  /// Get the first sites of all the bonds
+  [[nodiscard]] auto GetFirsts() const -> span_t { return span_t(first_); }
+
+  /// Get the second sites of all the bonds
+  [[nodiscard]] auto GetSeconds() const -> span_t { return span_t(second_); }
+
+  /// Get the index m of the pair of directions `2 m` and `2 m + 1` of the
+  /// Bravais lattice along which bond @p k lies
+  [[nodiscard]] auto GetDirection(index_t k) const -> index_t
+  {
+    assert(k < direction_.size());
+    return direction_[k];
+  }
+
+  /// Get the mask of the directions of the grid crossed by bond @p k , bit
+  /// d is set if the bond crosses the boundaries along d
+  [[nodiscard]] auto GetCrossing(index_t k) const -> crossing_t
+  {
+    assert(k < crossing_.size());
+    return crossing_[k];
+  }
+
+  /// Check if bond @p k crosses the boundaries of the grid
+  [[nodiscard]] auto CrossesBoundary(index_t k) const -> bool
+  {
+    return GetCrossing(k) != crossing_t{ 0U };
+  }
+
+  /// Get the bond held in slot @p slot of the neighbor table of site @p a
+  [[nodiscard]] auto GetBond(index_t a, index_t slot) const -> index_t
+  {
+    assert(a < GetNumSites());
+    assert(slotoffsets_[a] + slot < slotoffsets_[a + 1UL]);
+    return bond_[slotoffsets_[a] + slot];
+  }
+
+  /// Get the bonds of site @p a , one for each slot of the neighbor table
+  [[nodiscard]] auto GetBonds(index_t a) const -> span_t
+  {
+    assert(a < GetNumSites());
+    return span_t(bond_.data() + slotoffsets_[a],
+                  slotoffsets_[a + 1UL] - slotoffsets_[a]);
+  }
+
+private:
+  /// First site of each bond
+  std::vector<index_t> first_{};
+
+  /// Second site of each bond
+  std::vector<index_t> second_{};
+
+  /// Direction of each bond
+  std::vector<direction_t> direction_{};
+
+  /// Crossed directions of each bond
+  std::vector<crossing_t> crossing_{};
+
+  /// Position in bond_ of the first slot of each site, and the end
+  std::vector<index_t> slotoffsets_{};
+
+  /// Bond of each slot of the neighbor table
+  std::vector<index_t> bond_{};
+}; // class BondTable
+
+template<class F>
+inline BondTable::BondTable(NeighborTable const& table, F&& crossing)
+{
+  const auto n = table.GetNumSites();
+  slotoffsets_.assign(n + 1UL, 0UL);
+  for (auto a = 0UL; a < n; a++) {
+    slotoffsets_[a + 1UL] = slotoffsets_[a] + table.GetCoordination(a);
+  }
+  bond_.assign(slotoffsets_.back(), NoBond);
+
+  // the bonds are the slots along the positive directions, the opposite slot
+  // of the other site maps to the same bond
+  for (auto a = 0UL; a < n; a++) {
+    for (auto slot = 0UL; slot < table.GetCoordination(a); slot++) {
+      const auto direction = table.GetDirection(a, slot);
+      if (direction % 2UL != 0UL) {
+        continue;
+      }
+      const auto k = first_.size();
+      const auto b = table.GetNeighbor(a, slot);
+      first_.push_back(a);
+      second_.push_back(b);
+      direction_.push_back(static_cast<direction_t>(direction / 2UL));
+      crossing_.push_back(static_cast<crossing_t>(crossing(a, slot)));
+      bond_[slotoffsets_[a] + slot] = k;
+      bond_[slotoffsets_[b] + table.GetOppositeSlot(a, slot)] = k;
+    }
+  }
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
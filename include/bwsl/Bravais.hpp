@@ -16,11 +16,18 @@
 #pragma once
 
 // bwsl
+#include <bwsl/Hash.hpp>
 #include <bwsl/MathUtils.hpp>
 
 // std
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 namespace bwsl {
@@ -28,6 +35,10 @@ namespace bwsl {
 ///
 /// Representation of an infinite bravais lattice.
 ///
+/// The primitive vectors and the neighbor directions are stored in arrays of
+/// fixed capacity, so that the common lattices can be defined as constexpr
+/// constants.
+///
 class Bravais
 {
 public:
@@ -40,37 +51,62 @@ public:
   /// Vector of coordinates
   using neighbors_t = std::vector<long>;
 
+  /// Maximum dimensionality supported
+  static constexpr size_t MaxDim = 8UL;
+
+  /// Maximum number of components of the neighbors directions
+  static constexpr size_t MaxNeighborsComponents = 128UL;
+
+  /// Default constructor
+  constexpr Bravais() = default;
+
   /// Construct an abstract lattice
   Bravais(size_t dim_,
           size_t gamma,
-          realvec_t pvectors,
-          realvec_t pivectors,
-          neighbors_t neighbors);
+          realvec_t const& pvectors,
+          realvec_t const& pivectors,
+          neighbors_t const& neighbors);
+
+  /// Construct an abstract lattice at compile time
+  constexpr Bravais(size_t dim,
+                    size_t gamma,
+                    std::initializer_list<double> pvectors,
+                    std::initializer_list<double> pivectors,
+                    std::initializer_list<long> neighbors);
 
   /// Copy constructor
-  Bravais(Bravais const& that) = default;
+  constexpr Bravais(Bravais const& that) = default;
 
   /// Copy constructor
-  Bravais(Bravais&& that) = default;
+  constexpr Bravais(Bravais&& that) = default;
 
   /// Default destructor
-  virtual ~Bravais() = default;
+  ~Bravais() = default;
 
   /// Copy assignment operator
-  auto operator=(Bravais const& that) -> Bravais& = default;
+  constexpr auto operator=(Bravais const& that) -> Bravais& = default;
 
   /// Copy assignment operator
-  auto operator=(Bravais&& that) -> Bravais& = default;
+  constexpr auto operator=(Bravais&& that) -> Bravais& = default;
 
   /// Get the dimensionality
-  [[nodiscard]] auto GetDim() const -> size_t { return dim_; };
+  [[nodiscard]] constexpr auto GetDim() const -> size_t { return dim_; };
 
   /// Get the coordination number
-  [[nodiscard]] auto GetGamma() const -> size_t { return gamma_; };
+  [[nodiscard]] constexpr auto GetGamma() const -> size_t { return gamma_; };
+
+  /// Get a hash of the parameters of the lattice, equal lattices have equal
+  /// hashes
+  [[nodiscard]] auto GetHash() const -> std::uint64_t;
 
   /// Get the real space position of a point
   [[nodiscard]] auto GetRealSpace(coords_t const& coords) const -> realvec_t;
 
+  /// Get the real space position of a point with fixed dimension
+  template<std::size_t D>
+  [[nodiscard]] auto GetRealSpace(std::array<long, D> const& coords) const
+    -> std::array<double, D>;
+
   /// Get the coordinates of a realspace vector on the lattice basis
   [[nodiscard]] auto GetInverseVector(realvec_t const& realspace) const
     -> realvec_t;
@@ -79,10 +115,21 @@ public:
   [[nodiscard]] auto GetReciprocalSpace(coords_t const& coords) const
     -> realvec_t;
 
+  /// Reciprocal space vector with fixed dimension
+  template<std::size_t D>
+  [[nodiscard]] auto GetReciprocalSpace(std::array<long, D> const& coords) const
+    -> std::array<double, D>;
+
   /// Get the real space vector connecting two points on the lattice
   [[nodiscard]] auto GetVector(coords_t const& first,
                                coords_t const& second) const -> realvec_t;
 
+  /// Get the real space vector connecting two points with fixed dimension
+  template<std::size_t D>
+  [[nodiscard]] auto GetVector(std::array<long, D> const& first,
+                               std::array<long, D> const& second) const
+    -> std::array<double, D>;
+
   /// Get the distance vector in real space between two points
   [[nodiscard]] auto GetDistance(coords_t const& first,
                                  coords_t const& second) const -> double;
@@ -91,11 +138,47 @@ public:
                                        coords_t const& second) const
     -> std::pair<double, realvec_t>;
 
+  /// Get the distance and the vector between two points with fixed dimension
+  template<std::size_t D>
+  [[nodiscard]] auto GetDistanceVector(std::array<long, D> const& first,
+                                       std::array<long, D> const& second) const
+    -> std::pair<double, std::array<double, D>>;
+
+  /// Get the metric of the primitive vectors, `G_ij = a_i . a_j` stored in
+  /// row-major order
+  [[nodiscard]] auto GetMetric() const -> std::vector<double>;
+
+  /// Get the displacements of the neighbors from a lattice point, indexed as
+  /// in GetNeighbor
+  [[nodiscard]] auto GetNeighborVectors() const -> std::vector<coords_t>;
+
   /// Get one of the neighbors of a lattice point
   [[nodiscard]] auto GetNeighbor(coords_t const& point, size_t idx) const
     -> Bravais::coords_t;
 
+  /// Get one of the neighbors of a lattice point with fixed dimension
+  template<std::size_t D>
+  [[nodiscard]] auto GetNeighbor(std::array<long, D> const& point,
+                                 size_t idx) const -> std::array<long, D>;
+
 protected:
+  /// Real space position of a point, for any type of containers
+  template<class R, class C>
+  [[nodiscard]] auto RealSpace(C const& coords) const -> R;
+
+  /// Reciprocal space vector, for any type of containers
+  template<class R, class C>
+  [[nodiscard]] auto ReciprocalSpace(C const& coords) const -> R;
+
+  /// Distance and vector between two points, for any type of containers
+  template<class R, class C>
+  [[nodiscard]] auto DistanceVector(C const& first, C const& second) const
+    -> std::pair<double, R>;
+
+  /// Neighbor of a point, for any type of containers
+  template<class C>
+  [[nodiscard]] auto Neighbor(C const& point, size_t idx) const -> C;
+
 private:
   /// Dimensionality
   size_t dim_{};
@@ -105,36 +188,66 @@ private:
 
   /// Direct lattice vectors
   /// it is a dxd matrix
-  realvec_t pvectors_{};
+  std::array<double, MaxDim * MaxDim> pvectors_{};
 
   /// Inverse of the pvectors_ matrix
-  realvec_t pivectors_{};
+  std::array<double, MaxDim * MaxDim> pivectors_{};
 
   /// Neighbors directions
-  neighbors_t neighbors_{};
+  std::array<long, MaxNeighborsComponents> neighbors_{};
 }; // class Bravais
 
 inline Bravais::Bravais(size_t dim,
                         size_t gamma,
-                        realvec_t pvectors,
-                        realvec_t pivectors,
-                        neighbors_t neighbors)
+                        realvec_t const& pvectors,
+                        realvec_t const& pivectors,
+                        neighbors_t const& neighbors)
   : dim_(dim)
   , gamma_(gamma)
-  , pvectors_(std::move(pvectors))
-  , pivectors_(std::move(pivectors))
-  , neighbors_(std::move(neighbors))
 {
-  assert(pvectors_.size() == square(dim));
-  assert(pivectors_.size() == square(dim));
-  assert(neighbors_.size() == gamma / 2UL * dim);
+  if (dim > MaxDim || neighbors.size() > MaxNeighborsComponents) {
+    throw std::length_error("Bravais lattice too large");
+  }
+  assert(pvectors.size() == square(dim));
+  assert(pivectors.size() == square(dim));
+  assert(neighbors.size() == gamma / 2UL * dim);
+  std::copy(pvectors.begin(), pvectors.end(), pvectors_.begin());
+  std::copy(pivectors.begin(), pivectors.end(), pivectors_.begin());
+  std::copy(neighbors.begin(), neighbors.end(), neighbors_.begin());
+}
+
+constexpr Bravais::Bravais(size_t dim,
+                           size_t gamma,
+                           std::initializer_list<double> pvectors,
+                           std::initializer_list<double> pivectors,
+                           std::initializer_list<long> neighbors)
+  : dim_(dim)
+  , gamma_(gamma)
+{
+  assert(dim <= MaxDim && neighbors.size() <= MaxNeighborsComponents);
+  assert(pvectors.size() == dim * dim);
+  assert(pivectors.size() == dim * dim);
+  assert(neighbors.size() == gamma / 2UL * dim);
+  auto i = 0UL;
+  for (auto x : pvectors) {
+    pvectors_[i++] = x;
+  }
+  i = 0UL;
+  for (auto x : pivectors) {
+    pivectors_[i++] = x;
+  }
+  i = 0UL;
+  for (auto x : neighbors) {
+    neighbors_[i++] = x;
+  }
 }
 
+template<class R, class C>
 inline auto
-Bravais::GetRealSpace(coords_t const& coords) const -> Bravais::realvec_t
+Bravais::RealSpace(C const& coords) const -> R
 {
   assert(coords.size() == dim_ && "Dimensions mismatch");
-  auto p = Bravais::realvec_t(dim_, 0.0);
+  auto p = make_filled<R>(dim_, 0.0);
   for (auto i = 0UL; i < dim_; i++) {
     for (auto j = 0UL; j < dim_; j++) {
       p[i] += coords[j] * pvectors_[i + j * dim_];
@@ -143,6 +256,31 @@ Bravais::GetRealSpace(coords_t const& coords) const -> Bravais::realvec_t
   return p;
 }
 
+inline auto
+Bravais::GetRealSpace(coords_t const& coords) const -> Bravais::realvec_t
+{
+  return RealSpace<realvec_t>(coords);
+}
+
+template<std::size_t D>
+inline auto
+Bravais::GetRealSpace(std::array<long, D> const& coords) const
+  -> std::array<double, D>
+{
+  return RealSpace<std::array<double, D>>(coords);
+}
+
+inline auto
+Bravais::GetHash() const -> std::uint64_t
+{
+  // only the components in use, the rest of the arrays is always zero
+  auto h = hash_value(static_cast<std::uint64_t>(dim_));
+  h = hash_value(static_cast<std::uint64_t>(gamma_), h);
+  h = hash_bytes(pvectors_.data(), dim_ * dim_ * sizeof(double), h);
+  h = hash_bytes(pivectors_.data(), dim_ * dim_ * sizeof(double), h);
+  return hash_bytes(neighbors_.data(), gamma_ / 2UL * dim_ * sizeof(long), h);
+}
+
 inline auto
 Bravais::GetInverseVector(realvec_t const& realspace) const
   -> Bravais::realvec_t
@@ -157,11 +295,12 @@ Bravais::GetInverseVector(realvec_t const& realspace) const
   return p;
 }
 
+template<class R, class C>
 inline auto
-Bravais::GetReciprocalSpace(coords_t const& coords) const -> Bravais::realvec_t
+Bravais::ReciprocalSpace(C const& coords) const -> R
 {
   assert(coords.size() == dim_ && "Dimensions mismatch");
-  auto p = Bravais::realvec_t(dim_, 0.0);
+  auto p = make_filled<R>(dim_, 0.0);
   for (auto i = 0UL; i < dim_; i++) {
     for (auto j = 0UL; j < dim_; j++) {
       p[i] += coords[j] * 2 * M_PI * pivectors_[i + j * dim_];
@@ -170,6 +309,20 @@ Bravais::GetReciprocalSpace(coords_t const& coords) const -> Bravais::realvec_t
   return p;
 }
 
+inline auto
+Bravais::GetReciprocalSpace(coords_t const& coords) const -> Bravais::realvec_t
+{
+  return ReciprocalSpace<realvec_t>(coords);
+}
+
+template<std::size_t D>
+inline auto
+Bravais::GetReciprocalSpace(std::array<long, D> const& coords) const
+  -> std::array<double, D>
+{
+  return ReciprocalSpace<std::array<double, D>>(coords);
+}
+
 inline auto
 Bravais::GetVector(coords_t const& first, coords_t const& second) const
   -> Bravais::realvec_t
@@ -182,6 +335,20 @@ Bravais::GetVector(coords_t const& first, coords_t const& second) const
   return GetRealSpace(p);
 }
 
+template<std::size_t D>
+inline auto
+Bravais::GetVector(std::array<long, D> const& first,
+                   std::array<long, D> const& second) const
+  -> std::array<double, D>
+{
+  auto p = std::array<long, D>{};
+  for (auto i = 0UL; i < D; i++) {
+    p[i] = second[i] - first[i];
+  }
+
+  return GetRealSpace(p);
+}
+
 inline auto
 Bravais::GetDistance(coords_t const& first, coords_t const& second) const
   -> double
@@ -195,9 +362,10 @@ Bravais::GetDistance(coords_t const& first, coords_t const& second) const
   return std::sqrt(d);
 }
 
+template<class R, class C>
 inline auto
-Bravais::GetDistanceVector(coords_t const& first, coords_t const& second) const
-  -> std::pair<double, Bravais::realvec_t>
+Bravais::DistanceVector(C const& first, C const& second) const
+  -> std::pair<double, R>
 {
   auto p = GetVector(first, second);
   auto d = 0.0;
@@ -209,8 +377,24 @@ Bravais::GetDistanceVector(coords_t const& first, coords_t const& second) const
 }
 
 inline auto
-Bravais::GetNeighbor(coords_t const& point, size_t idx) const
-  -> Bravais::coords_t
+Bravais::GetDistanceVector(coords_t const& first, coords_t const& second) const
+  -> std::pair<double, Bravais::realvec_t>
+{
+  return DistanceVector<realvec_t>(first, second);
+}
+
+template<std::size_t D>
+inline auto
+Bravais::GetDistanceVector(std::array<long, D> const& first,
+                           std::array<long, D> const& second) const
+  -> std::pair<double, std::array<double, D>>
+{
+  return DistanceVector<std::array<double, D>>(first, second);
+}
+
+template<class C>
+inline auto
+Bravais::Neighbor(C const& point, size_t idx) const -> C
 {
   auto aidx = idx / 2UL;
   auto sidx = idx % 2UL == 0UL ? 1 : -1;
@@ -222,35 +406,119 @@ Bravais::GetNeighbor(coords_t const& point, size_t idx) const
   return n;
 }
 
+inline auto
+Bravais::GetMetric() const -> std::vector<double>
+{
+  auto basis = std::vector<realvec_t>{};
+  for (auto d = 0UL; d < dim_; d++) {
+    auto unit = coords_t(dim_, 0L);
+    unit[d] = 1L;
+    basis.push_back(GetRealSpace(unit));
+  }
+  auto metric = std::vector<double>(dim_ * dim_, 0.0);
+  for (auto i = 0UL; i < dim_; i++) {
+    for (auto j = 0UL; j < dim_; j++) {
+      for (auto m = 0UL; m < dim_; m++) {
+        metric[i * dim_ + j] += basis[i][m] * basis[j][m];
+      }
+    }
+  }
+  return metric;
+}
+
+inline auto
+Bravais::GetNeighborVectors() const -> std::vector<coords_t>
+{
+  const auto origin = coords_t(dim_, 0L);
+  auto vectors = std::vector<coords_t>{};
+  vectors.reserve(gamma_);
+  for (auto idx = 0UL; idx < gamma_; idx++) {
+    vectors.push_back(Neighbor(origin, idx));
+  }
+  return vectors;
+}
+
+inline auto
+Bravais::GetNeighbor(coords_t const& point, size_t idx) const
+  -> Bravais::coords_t
+{
+  return Neighbor(point, idx);
+}
+
+template<std::size_t D>
+inline auto
+Bravais::GetNeighbor(std::array<long, D> const& point, size_t idx) const
+  -> std::array<long, D>
+{
+  return Neighbor(point, idx);
+}
+
 // clang-format off
-const auto ChainLattice = Bravais(
+inline constexpr auto ChainLattice = Bravais(
   1UL,
   2UL,
   { 1.0 },
   { 1.0 },
   { 1 }
 );
-const auto SquareLattice = Bravais(
+inline constexpr auto SquareLattice = Bravais(
   2UL,
   4UL,
   { 1.0, 0.0, 0.0, 1.0 },
   { 1.0, 0.0, 0.0, 1.0 },
   { 1, 0, 0, 1 }
 );
-const auto CubicLattice = Bravais(
+inline constexpr auto CubicLattice = Bravais(
   3UL,
   6UL,
   { 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 },
   { 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 },
   { 1, 0, 0, 0, 1, 0, 0, 0, 1 }
 );
-const auto TriangularLattice = Bravais(
+inline constexpr auto HyperCubicLattice4D = Bravais(
+  4UL,
+  8UL,
+  { 1.0, 0.0, 0.0, 0.0,
+    0.0, 1.0, 0.0, 0.0,
+    0.0, 0.0, 1.0, 0.0,
+    0.0, 0.0, 0.0, 1.0 },
+  { 1.0, 0.0, 0.0, 0.0,
+    0.0, 1.0, 0.0, 0.0,
+    0.0, 0.0, 1.0, 0.0,
+    0.0, 0.0, 0.0, 1.0 },
+  { 1, 0, 0, 0,
+    0, 1, 0, 0,
+    0, 0, 1, 0,
+    0, 0, 0, 1 }
+);
+inline constexpr auto HyperCubicLattice5D = Bravais(
+  5UL,
+  10UL,
+  { 1.0, 0.0, 0.0, 0.0, 0.0,
+    0.0, 1.0, 0.0, 0.0, 0.0,
+    0.0, 0.0, 1.0, 0.0, 0.0,
+    0.0, 0.0, 0.0, 1.0, 0.0,
+    0.0, 0.0, 0.0, 0.0, 1.0 },
+  { 1.0, 0.0, 0.0, 0.0, 0.0,
+    0.0, 1.0, 0.0, 0.0, 0.0,
+    0.0, 0.0, 1.0, 0.0, 0.0,
+    0.0, 0.0, 0.0, 1.0, 0.0,
+    0.0, 0.0, 0.0, 0.0, 1.0 },
+  { 1, 0, 0, 0, 0,
+    0, 1, 0, 0, 0,
+    0, 0, 1, 0, 0,
+    0, 0, 0, 1, 0,
+    0, 0, 0, 0, 1 }
+);
+// sqrt(3) / 2, -1 / sqrt(3) and 2 / sqrt(3) rounded to double precision
+inline constexpr auto TriangularLattice = Bravais(
   2UL,
   6UL,
-  { 1.0, 0.0, 0.5, std::sqrt(3.0) / 2.0 },
-  { 1.0, -1.0 / std::sqrt(3), 0, 2.0 / std::sqrt(3) },
+  { 1.0, 0.0, 0.5, 0.8660254037844386 },
+  { 1.0, -0.57735026918962584, 0, 1.1547005383792517 },
   { 1, 0, 0, 1, 1, -1 }
 );
+// clang-format on
 
 } // namespace bwsl
 
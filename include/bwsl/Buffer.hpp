@@ -0,0 +1,160 @@
+//===-- Buffer.hpp ---------------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the Buffer Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/AlignedAllocator.hpp>
+#include <bwsl/Span.hpp>
+
+// std
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Read only array of elements which either owns its storage or refers to
+/// memory owned by someone else, like a memory mapped file.
+///
+/// In the second case the owner of the memory is kept alive by a shared
+/// pointer, so that copies of the buffer remain valid. Owned elements are
+/// aligned to DefaultAlignment bytes.
+///
+template<class T>
+class Buffer
+{
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using const_iterator = T const*;
+
+  /// Default constructor
+  Buffer() = default;
+
+  /// Take ownership of the elements of @p data
+  explicit Buffer(aligned_vector<T> data)
+    : owned_(std::move(data))
+    , data_(owned_.data())
+    , size_(owned_.size())
+  {
+  }
+
+  /// Copy the elements of @p data in aligned storage
+  explicit Buffer(std::vector<T> const& data)
+    : Buffer(aligned_vector<T>(data.begin(), data.end()))
+  {
+  }
+
+  /// Refer to @p size elements at @p data owned by @p holder
+  Buffer(T const* data, size_type size, std::shared_ptr<void const> holder)
+    : data_(data)
+    , size_(size)
+    , holder_(std::move(holder))
+  {
+  }
+
+  /// Copy constructor
+  Buffer(Buffer const& that)
+    : owned_(that.owned_)
+    , data_(that.IsOwning() ? owned_.data() : that.data_)
+    , size_(that.size_)
+    , holder_(that.holder_)
+  {
+  }
+
+  /// Move constructor, the elements are not moved
+  Buffer(Buffer&& that) noexcept
+    : owned_(std::move(that.owned_))
+    , data_(std::exchange(that.data_, nullptr))
+    , size_(std::exchange(that.size_, 0UL))
+    , holder_(std::move(that.holder_))
+  {
+  }
+
+  /// Copy assignment operator
+  auto operator=(Buffer const& that) -> Buffer&
+  {
+    if (this != &that) {
+      *this = Buffer(that);
+    }
+    return *this;
+  }
+
+  /// Move assignment operator
+  auto operator=(Buffer&& that) noexcept -> Buffer&
+  {
+    owned_ = std::move(that.owned_);
+    data_ = std::exchange(that.data_, nullptr);
+    size_ = std::exchange(that.size_, 0UL);
+    holder_ = std::move(that.holder_);
+    return *this;
+  }
+
+  /// Default destructor
+  ~Buffer() = default;
+
+  /// Check if the buffer owns its elements
+  [[nodiscard]] auto IsOwning() const -> bool { return holder_ == nullptr; }
+
+  /// Get the number of elements
+  [[nodiscard]] auto size() const -> size_type { return size_; }
+
+  /// Check if the buffer is empty
+  [[nodiscard]] auto empty() const -> bool { return size_ == 0UL; }
+
+  /// Get the pointer to the first element
+  [[nodiscard]] auto data() const -> T const* { return data_; }
+
+  /// Access an element
+  [[nodiscard]] auto operator[](size_type i) const -> T const&
+  {
+    assert(i < size_);
+    return data_[i];
+  }
+
+  /// Iterator to the first element
+  [[nodiscard]] auto begin() const -> const_iterator { return data_; }
+
+  /// Iterator past the last element
+  [[nodiscard]] auto end() const -> const_iterator { return data_ + size_; }
+
+  /// Get a view over @p count elements starting at @p offset
+  [[nodiscard]] auto GetSpan(size_type offset, size_type count) const
+    -> Span<T const>
+  {
+    assert(offset + count <= size_);
+    return Span<T const>(data_ + offset, count);
+  }
+
+private:
+  /// Elements owned
+  aligned_vector<T> owned_{};
+
+  /// First element
+  T const* data_{ nullptr };
+
+  /// Number of elements
+  size_type size_{ 0UL };
+
+  /// Owner of the memory when the elements are not owned
+  std::shared_ptr<void const> holder_{};
+}; // class Buffer
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,390 @@
+//===-- ClusterLabeling.hpp ------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the ClusterLabeling Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/Bravais.hpp>
+#include <bwsl/NeighborTable.hpp>
+#include <bwsl/ThreadPool.hpp>
+#include <bwsl/UnionFind.hpp>
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Connected clusters of the occupied sites of a lattice.
+///
+/// The labeling is a Hoshen-Kopelman pass with a ConcurrentUnionFind: the
+/// sites are split in contiguous ranges of indices scanned in parallel and
+/// every occupied site is joined to its occupied neighbors, along any set of
+/// directions of the Bravais lattice and following the boundaries of the
+/// neighbor table. The clusters are then numbered by their smallest site,
+/// therefore the labels do not depend on the number of threads.
+///
+/// Each cluster is then walked from its smallest site assigning to its sites
+/// the coordinates unwrapped across the boundaries. A cluster *wraps* along
+/// a direction of the grid when two of its neighbors disagree on the
+/// unwrapped coordinates, that is when it contains a loop winding around the
+/// closed boundaries. A cluster *spans* along a direction when its unwrapped
+/// extent covers the size of the grid, with open boundaries when it touches
+/// both faces.
+///
+/// The labeling allocates its tables once, each call of Label then costs a
+/// pass over the lattice.
+///
+class ClusterLabeling
+{
+public:
+  /// Type for the site and cluster indices
+  using index_t = std::size_t;
+
+  /// Type of the masks of the directions of the grid
+  using mask_t = std::uint8_t;
+
+  /// Label of the empty sites
+  static constexpr index_t NoCluster = std::numeric_limits<index_t>::max();
+
+  /// Default constructor
+  ClusterLabeling() = default;
+
+  /// Prepare the labeling of the sites of @p lattice , which must outlive it
+  template<class Lattice>
+  explicit ClusterLabeling(Lattice const& lattice);
+
+  /// Copy constructor
+  ClusterLabeling(ClusterLabeling const& that) = delete;
+
+  /// Move constructor
+  ClusterLabeling(ClusterLabeling&& that) = default;
+
+  /// Copy assignment operator
+  auto operator=(ClusterLabeling const& that) -> ClusterLabeling& = delete;
+
+  /// Move assignment operator
+  auto operator=(ClusterLabeling&& that) -> ClusterLabeling& = default;
+
+  /// Default destructor
+  virtual ~ClusterLabeling() = default;
+
+  /// Label the clusters of the sites with non zero @p occupations , one for
+  /// each site. Return the number of clusters.
+  template<class T>
+  auto Label(ThreadPool& pool, std::vector<T> const& occupations)
+    -> std::size_t;
+
+  /// Get the number of sites
+  [[nodiscard]] auto GetNumSites() const -> std::size_t
+  {
+    return labels_.size();
+  }
+
+  /// Get the number of clusters
+  [[nodiscard]] auto GetNumClusters() const -> std::size_t
+  {
+    return sizes_.size();
+  }
+
+  /// Get the cluster of site @p i , or NoCluster if it is empty
+  [[nodiscard]] auto GetLabel(index_t i) const -> index_t
+  {
+    assert(i < labels_.size());
+    return labels_[i];
+  }
+
+  /// Get the cluster of every site
+  [[nodiscard]] auto GetLabels() const -> std::vector<index_t> const&
+  {
+    return labels_;
+  }
+
+  /// Get the number of sites of cluster @p c
+  [[nodiscard]] auto GetSize(index_t c) const -> std::size_t
+  {
+    assert(c < sizes_.size());
+    return sizes_[c];
+  }
+
+  /// Get the number of sites of every cluster
+  [[nodiscard]] auto GetSizes() const -> std::vector<std::size_t> const&
+  {
+    return sizes_;
+  }
+
+  /// Get the number of sites of the largest cluster
+  [[nodiscard]] auto GetLargestSize() const -> std::size_t
+  {
+    return sizes_.empty() ? 0UL
+                          : *std::max_element(sizes_.begin(), sizes_.end());
+  }
+
+  /// Get the fraction of the sites of the lattice in the largest cluster
+  [[nodiscard]] auto GetLargestFraction() const -> double
+  {
+    return labels_.empty() ? 0.0
+                           : static_cast<double>(GetLargestSize()) /
+                               static_cast<double>(labels_.size());
+  }
+
+  /// Get the mask of the directions along which cluster @p c wraps
+  [[nodiscard]] auto GetWrapping(index_t c) const -> mask_t
+  {
+    assert(c < wrapping_.size());
+    return wrapping_[c];
+  }
+
+  /// Check if cluster @p c wraps along the direction @p d
+  [[nodiscard]] auto IsWrapping(index_t c, std::size_t d) const -> bool
+  {
+    return ((GetWrapping(c) >> d) & 1U) != 0U;
+  }
+
+  /// Get the mask of the directions along which cluster @p c spans
+  [[nodiscard]] auto GetSpanning(index_t c) const -> mask_t
+  {
+    assert(c < spanning_.size());
+    return spanning_[c];
+  }
+
+  /// Check if cluster @p c spans along the direction @p d
+  [[nodiscard]] auto IsSpanning(index_t c, std::size_t d) const -> bool
+  {
+    return ((GetSpanning(c) >> d) & 1U) != 0U;
+  }
+
+  /// Check if any cluster wraps along the direction @p d
+  [[nodiscard]] auto Wraps(std::size_t d) const -> bool;
+
+  /// Check if any cluster spans along the direction @p d
+  [[nodiscard]] auto Spans(std::size_t d) const -> bool;
+
+protected:
+  /// Unwrap the coordinates of the sites of cluster @p c , starting from
+  /// its smallest site @p root , and find its wrapping and spanning
+  auto Unwrap(index_t c, index_t root) -> void;
+
+private:
+  /// Neighbors of the sites
+  NeighborTable const* table_{ nullptr };
+
+  /// Dimension of the grid
+  std::size_t dim_{ 0UL };
+
+  /// Sizes of the grid
+  std::vector<long> size_{};
+
+  /// Vectors of the directions of the Bravais lattice, one row for each
+  std::vector<long> directions_{};
+
+  /// Sets of the connected sites
+  ConcurrentUnionFind sets_{};
+
+  /// Cluster of each site
+  std::vector<index_t> labels_{};
+
+  /// Number of sites of each cluster
+  std::vector<std::size_t> sizes_{};
+
+  /// Position in order_ of the first site of each cluster
+  std::vector<index_t> offsets_{};
+
+  /// Sites of the clusters in the order they are walked
+  std::vector<index_t> order_{};
+
+  /// Unwrapped coordinates of every site, one row for each
+  std::vector<long> unwrapped_{};
+
+  /// Whether each site was reached while unwrapping its cluster
+  std::vector<std::uint8_t> reached_{};
+
+  /// Directions along which each cluster wraps
+  std::vector<mask_t> wrapping_{};
+
+  /// Directions along which each cluster spans
+  std::vector<mask_t> spanning_{};
+}; // class ClusterLabeling
+
+template<class Lattice>
+inline ClusterLabeling::ClusterLabeling(Lattice const& lattice)
+  : table_(&lattice.GetNeighborTable())
+  , dim_(lattice.GetDim())
+  , sets_(lattice.GetNumSites())
+  , labels_(lattice.GetNumSites(), NoCluster)
+  , order_(lattice.GetNumSites())
+  , unwrapped_(lattice.GetNumSites() * lattice.GetDim())
+  , reached_(lattice.GetNumSites(), 0U)
+{
+  assert(dim_ <= 8UL * sizeof(mask_t));
+  for (auto d = 0UL; d < dim_; d++) {
+    size_.push_back(static_cast<long>(lattice.GetSize()[d]));
+  }
+  for (auto const& v : lattice.GetBravais().GetNeighborVectors()) {
+    directions_.insert(directions_.end(), v.begin(), v.end());
+  }
+}
+
+template<class T>
+inline auto
+ClusterLabeling::Label(ThreadPool& pool, std::vector<T> const& occupations)
+  -> std::size_t
+{
+  auto const& table = *table_;
+  const auto n = labels_.size();
+  assert(occupations.size() == n);
+
+  pool.ParallelFor(0UL, n, [&](index_t i) {
+    sets_.Reset(i);
+    reached_[i] = 0U;
+  });
+  pool.ParallelFor(0UL, n, [&](index_t i) {
+    if (occupations[i] == T{}) {
+      return;
+    }
+    for (auto j : table.GetNeighbors(i)) {
+      if (j > i && occupations[j] != T{}) {
+        sets_.Unite(i, j);
+      }
+    }
+  });
+
+  // the roots are the smallest sites of the clusters, numbering them in
+  // order gives labels independent of the order of the unions
+  sizes_.clear();
+  for (auto i = 0UL; i < n; i++) {
+    if (occupations[i] != T{} && sets_.IsRoot(i)) {
+      labels_[i] = sizes_.size();
+      sizes_.push_back(0UL);
+    }
+  }
+  pool.ParallelFor(0UL, n, [&](index_t i) {
+    if (occupations[i] == T{}) {
+      labels_[i] = NoCluster;
+    } else if (!sets_.IsRoot(i)) {
+      labels_[i] = labels_[sets_.Find(i)];
+    }
+  });
+  for (auto i = 0UL; i < n; i++) {
+    if (labels_[i] != NoCluster) {
+      sizes_[labels_[i]]++;
+    }
+  }
+
+  // the clusters are walked in parallel, each one in its own part of order_
+  const auto numclusters = sizes_.size();
+  offsets_.assign(numclusters + 1UL, 0UL);
+  auto roots = std::vector<index_t>(numclusters);
+  for (auto c = 0UL; c < numclusters; c++) {
+    offsets_[c + 1UL] = offsets_[c] + sizes_[c];
+  }
+  for (auto i = 0UL; i < n; i++) {
+    if (labels_[i] != NoCluster && sets_.IsRoot(i)) {
+      roots[labels_[i]] = i;
+    }
+  }
+  wrapping_.assign(numclusters, mask_t{ 0U });
+  spanning_.assign(numclusters, mask_t{ 0U });
+  pool.ParallelFor(
+    0UL, numclusters, [&](index_t c) { Unwrap(c, roots[c]); }, 1UL);
+  return numclusters;
+}
+
+inline auto
+ClusterLabeling::Unwrap(index_t c, index_t root) -> void
+{
+  auto const& table = *table_;
+  const auto dim = dim_;
+  auto* queue = order_.data() + offsets_[c];
+  auto* origin = unwrapped_.data() + root * dim;
+  std::fill_n(origin, dim, 0L);
+  auto low = std::vector<long>(dim, 0L);
+  auto high = std::vector<long>(dim, 0L);
+  auto wrapping = 0U;
+
+  // breadth first from the root, the queue is the part of order_ owned by
+  // the cluster
+  queue[0] = root;
+  reached_[root] = 1U;
+  auto last = 1UL;
+
+  for (auto first = 0UL; first < last; first++) {
+    const auto a = queue[first];
+    auto const* pa = unwrapped_.data() + a * dim;
+    for (auto slot = 0UL; slot < table.GetCoordination(a); slot++) {
+      const auto b = table.GetNeighbor(a, slot);
+      if (labels_[b] != c) {
+        continue;
+      }
+      auto const* v = directions_.data() + table.GetDirection(a, slot) * dim;
+      auto* pb = unwrapped_.data() + b * dim;
+      if (reached_[b] == 0U) {
+        reached_[b] = 1U;
+        for (auto d = 0UL; d < dim; d++) {
+          pb[d] = pa[d] + v[d];
+          low[d] = std::min(low[d], pb[d]);
+          high[d] = std::max(high[d], pb[d]);
+        }
+        queue[last++] = b;
+        continue;
+      }
+      for (auto d = 0UL; d < dim; d++) {
+        if (pb[d] != pa[d] + v[d]) {
+          wrapping |= 1U << d;
+        }
+      }
+    }
+  }
+  assert(last == sizes_[c]);
+
+  auto spanning = 0U;
+  for (auto d = 0UL; d < dim; d++) {
+    if (high[d] - low[d] + 1L >= size_[d]) {
+      spanning |= 1U << d;
+    }
+  }
+  wrapping_[c] = static_cast<mask_t>(wrapping);
+  spanning_[c] = static_cast<mask_t>(spanning | wrapping);
+}
+
+inline auto
+ClusterLabeling::Wraps(std::size_t d) const -> bool
+{
+  for (auto c = 0UL; c < GetNumClusters(); c++) {
+    if (IsWrapping(c, d)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+inline auto
+ClusterLabeling::Spans(std::size_t d) const -> bool
+{
+  for (auto c = 0UL; c < GetNumClusters(); c++) {
+    if (IsSpanning(c, d)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,271 @@
+//===-- ClusterUpdate.hpp --------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the ClusterUpdate Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/BondTable.hpp>
+#include <bwsl/ThreadPool.hpp>
+#include <bwsl/UnionFind.hpp>
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Swendsen-Wang and Wolff cluster updates of Ising spins on the bonds of a
+/// lattice.
+///
+/// A bond between aligned spins is activated with probability `p`, which is
+/// `1 - exp(-2 beta J)` for the ferromagnetic Ising model, see
+/// GetBondProbability. Swendsen-Wang labels all the clusters of active bonds
+/// with a ConcurrentUnionFind, the bonds being processed in parallel, and
+/// flips each cluster with probability one half. Wolff grows the cluster of
+/// a random site breadth first, the sites of each generation being processed
+/// in parallel, and flips it.
+///
+/// The random numbers are not drawn from a generator shared by the threads.
+/// They are computed from the seed, the number of the update and the bond,
+/// site or cluster they are used for, so that each of them is an
+/// independent stream. The updates therefore do not depend on the number of
+/// threads nor on the order in which the threads process the bonds.
+///
+/// The spins are values of a signed type, +1 or -1, one for each site of the
+/// bond table, which must outlive the update.
+///
+class ClusterUpdate
+{
+public:
+  /// Type for the site and bond indices
+  using index_t = std::size_t;
+
+  /// Default constructor
+  ClusterUpdate() = default;
+
+  /// Create the update of the spins on the sites of @p bonds , with the
+  /// random numbers seeded by @p seed
+  ClusterUpdate(BondTable const& bonds, std::uint64_t seed);
+
+  /// Copy constructor
+  ClusterUpdate(ClusterUpdate const& that) = delete;
+
+  /// Move constructor
+  ClusterUpdate(ClusterUpdate&& that) = default;
+
+  /// Copy assignment operator
+  auto operator=(ClusterUpdate const& that) -> ClusterUpdate& = delete;
+
+  /// Move assignment operator
+  auto operator=(ClusterUpdate&& that) -> ClusterUpdate& = default;
+
+  /// Default destructor
+  virtual ~ClusterUpdate() = default;
+
+  /// Get the probability of activating a bond between aligned spins for the
+  /// Ising model with coupling @p coupling at inverse temperature @p beta
+  [[nodiscard]] static auto GetBondProbability(double beta,
+                                               double coupling = 1.0)
+    -> double
+  {
+    return -std::expm1(-2.0 * beta * coupling);
+  }
+
+  /// Get the number of updates done so far
+  [[nodiscard]] auto GetNumUpdates() const -> std::uint64_t
+  {
+    return updates_;
+  }
+
+  /// Get the cluster of site @p i found by the last Swendsen-Wang update,
+  /// the smallest site of the cluster
+  [[nodiscard]] auto GetCluster(index_t i) -> index_t
+  {
+    return clusters_.Find(i);
+  }
+
+  /// Update @p spins with the Swendsen-Wang algorithm, activating the bonds
+  /// with probability @p probability . Return the number of clusters.
+  template<class T>
+  auto SwendsenWang(ThreadPool& pool,
+                    std::vector<T>& spins,
+                    double probability) -> std::size_t;
+
+  /// Update @p spins with the Wolff algorithm, activating the bonds with
+  /// probability @p probability . Return the size of the flipped cluster.
+  template<class T>
+  auto Wolff(ThreadPool& pool, std::vector<T>& spins, double probability)
+    -> std::size_t;
+
+protected:
+  /// Get the uniform random number in [0, 1) used for the item @p index in
+  /// the current update
+  [[nodiscard]] auto GetUniform(std::uint64_t index) const -> double;
+
+private:
+  /// Generations of the Wolff clusters below this size are grown serially
+  static constexpr std::size_t SerialGrain = 256UL;
+
+  /// Bonds of the lattice
+  BondTable const* bonds_{ nullptr };
+
+  /// Seed of the random numbers
+  std::uint64_t seed_{ 0UL };
+
+  /// Number of updates done
+  std::uint64_t updates_{ 0UL };
+
+  /// Clusters of the Swendsen-Wang update
+  ConcurrentUnionFind clusters_{};
+
+  /// Sites already in the Wolff cluster
+  std::unique_ptr<std::atomic<std::uint8_t>[]> visited_{};
+
+  /// Sites of the Wolff cluster, in the order they were added
+  std::vector<index_t> cluster_{};
+}; // class ClusterUpdate
+
+inline ClusterUpdate::ClusterUpdate(BondTable const& bonds, std::uint64_t seed)
+  : bonds_(&bonds)
+  , seed_(seed)
+  , clusters_(bonds.GetNumSites())
+  , visited_(
+      std::make_unique<std::atomic<std::uint8_t>[]>(bonds.GetNumSites()))
+  , cluster_(bonds.GetNumSites())
+{
+  for (auto i = 0UL; i < bonds.GetNumSites(); i++) {
+    visited_[i].store(0U, std::memory_order_relaxed);
+  }
+}
+
+inline auto
+ClusterUpdate::GetUniform(std::uint64_t index) const -> double
+{
+  // splitmix64 finalizer applied to the seed, the update and the item
+  auto mix = [](std::uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27U)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31U);
+  };
+  const auto h = mix(mix(mix(seed_) ^ updates_) ^ index);
+  return static_cast<double>(h >> 11U) * 0x1.0p-53;
+}
+
+template<class T>
+inline auto
+ClusterUpdate::SwendsenWang(ThreadPool& pool,
+                            std::vector<T>& spins,
+                            double probability) -> std::size_t
+{
+  auto const& bonds = *bonds_;
+  const auto n = bonds.GetNumSites();
+  const auto numbonds = bonds.GetNumBonds();
+  assert(spins.size() == n);
+
+  pool.ParallelFor(0UL, n, [&](index_t i) { clusters_.Reset(i); });
+  pool.ParallelFor(0UL, numbonds, [&](index_t k) {
+    const auto a = bonds.GetFirst(k);
+    const auto b = bonds.GetSecond(k);
+    if (spins[a] == spins[b] && GetUniform(k) < probability) {
+      clusters_.Unite(a, b);
+    }
+  });
+
+  // the roots decide the flip of their cluster, the numbers after the bonds
+  // are used for them
+  auto numclusters = std::atomic<std::size_t>(0UL);
+  pool.ParallelFor(0UL, n, [&](index_t i) {
+    const auto root = clusters_.Find(i);
+    if (root == i) {
+      numclusters.fetch_add(1UL, std::memory_order_relaxed);
+    }
+    if (GetUniform(numbonds + root) < 0.5) {
+      spins[i] = static_cast<T>(-spins[i]);
+    }
+  });
+  updates_++;
+  return numclusters.load();
+}
+
+template<class T>
+inline auto
+ClusterUpdate::Wolff(ThreadPool& pool,
+                     std::vector<T>& spins,
+                     double probability) -> std::size_t
+{
+  auto const& bonds = *bonds_;
+  const auto n = bonds.GetNumSites();
+  const auto numbonds = bonds.GetNumBonds();
+  assert(spins.size() == n);
+  if (n == 0UL) {
+    return 0UL;
+  }
+
+  // each bond has a single random number in an update, hence the cluster is
+  // the component of the seed among the active bonds whatever the order of
+  // the growth
+  const auto seed = std::min(
+    n - 1UL,
+    static_cast<index_t>(GetUniform(numbonds) * static_cast<double>(n)));
+  const auto spin = spins[seed];
+  auto& cluster = cluster_;
+  auto size = std::atomic<std::size_t>(1UL);
+  cluster[0] = seed;
+  visited_[seed].store(1U, std::memory_order_relaxed);
+
+  auto first = 0UL;
+  auto last = 1UL;
+  while (first < last) {
+    pool.ParallelFor(
+      first,
+      last,
+      [&](std::size_t m) {
+        const auto a = cluster[m];
+        for (auto k : bonds.GetBonds(a)) {
+          const auto b =
+            bonds.GetFirst(k) == a ? bonds.GetSecond(k) : bonds.GetFirst(k);
+          if (spins[b] != spin || visited_[b].load(std::memory_order_relaxed) ||
+              GetUniform(k) >= probability) {
+            continue;
+          }
+          if (visited_[b].exchange(1U, std::memory_order_relaxed) == 0U) {
+            cluster[size.fetch_add(1UL, std::memory_order_relaxed)] = b;
+          }
+        }
+      },
+      SerialGrain);
+    first = last;
+    last = size.load();
+  }
+
+  pool.ParallelFor(0UL, last, [&](std::size_t m) {
+    const auto a = cluster[m];
+    spins[a] = static_cast<T>(-spins[a]);
+    visited_[a].store(0U, std::memory_order_relaxed);
+  });
+  updates_++;
+  return last;
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,249 @@
+//===-- DistanceShells.hpp -------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the DistanceShells Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/Span.hpp>
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Classification of the sites of a lattice in shells of equal distance from
+/// a reference site.
+///
+/// The shells are numbered by increasing distance, shell 0 holding only the
+/// reference site. When the metric of the Bravais lattice is integer up to a
+/// scale the shells are keyed on the exact squared norms `c^T G c` of the
+/// integer coordinates `c`, otherwise the squared distances are merged
+/// within a relative tolerance.
+///
+class DistanceShells
+{
+public:
+  /// Type of the shell indices
+  using shell_t = std::uint32_t;
+
+  /// View over the shell of every site
+  using span_t = Span<shell_t const>;
+
+  /// Relative tolerance used to merge squared distances
+  static constexpr double Tolerance = 1e-9;
+
+  /// Largest scale tried to make a metric integer
+  static constexpr long MaxMetricScale = 256L;
+
+  /// Default constructor
+  DistanceShells() = default;
+
+  /// Copy constructor
+  DistanceShells(DistanceShells const& that) = default;
+
+  /// Move constructor
+  DistanceShells(DistanceShells&& that) = default;
+
+  /// Copy assignment operator
+  auto operator=(DistanceShells const& that) -> DistanceShells& = default;
+
+  /// Move assignment operator
+  auto operator=(DistanceShells&& that) -> DistanceShells& = default;
+
+  /// Default destructor
+  virtual ~DistanceShells() = default;
+
+  /// Classify the sites from the exact squared norms @p norms , scaled by
+  /// @p scale with respect to the squared distances
+  [[nodiscard]] static auto FromNorms(std::vector<std::int64_t> const& norms,
+                                      long scale) -> DistanceShells;
+
+  /// Classify the sites from the squared distances @p squared merging those
+  /// closer than Tolerance
+  [[nodiscard]] static auto FromSquaredDistances(
+    std::vector<double> const& squared) -> DistanceShells;
+
+  /// Get the smallest integer m such that `m * metric` is an integer matrix,
+  /// or zero if there is none up to MaxMetricScale
+  [[nodiscard]] static auto GetMetricScale(std::vector<double> const& metric)
+    -> long;
+
+  /// Check if the shells come from exact squared norms
+  [[nodiscard]] auto IsExact() const -> bool { return scale_ != 0L; }
+
+  /// Get the number of sites
+  [[nodiscard]] auto GetNumSites() const -> std::size_t
+  {
+    return shells_.size();
+  }
+
+  /// Get the number of shells
+  [[nodiscard]] auto GetNumShells() const -> std::size_t
+  {
+    return multiplicity_.size();
+  }
+
+  /// Get the shell of site @p i
+  [[nodiscard]] auto GetShell(std::size_t i) const -> std::size_t
+  {
+    assert(i < shells_.size());
+    return shells_[i];
+  }
+
+  /// Get the shell of all the sites
+  [[nodiscard]] auto GetShells() const -> span_t { return span_t(shells_); }
+
+  /// Get the number of sites in shell @p k
+  [[nodiscard]] auto GetMultiplicity(std::size_t k) const -> std::size_t
+  {
+    assert(k < multiplicity_.size());
+    return multiplicity_[k];
+  }
+
+  /// Get the distance of the sites in shell @p k
+  [[nodiscard]] auto GetRadius(std::size_t k) const -> double
+  {
+    assert(k < radius_.size());
+    return radius_[k];
+  }
+
+  /// Get the exact squared norm of shell @p k , scaled as in FromNorms
+  [[nodiscard]] auto GetNorm(std::size_t k) const -> std::int64_t
+  {
+    assert(IsExact() && k < norms_.size());
+    return norms_[k];
+  }
+
+  /// Get the sites in shell @p k , by increasing index
+  [[nodiscard]] auto GetSites(std::size_t k) const -> std::vector<std::size_t>;
+
+protected:
+  /// Assign the shells to the sites sorting them by @p key and starting a
+  /// new shell whenever `same` is false for two consecutive keys
+  template<class T, class Same>
+  auto Classify(std::vector<T> const& key, Same&& same) -> std::vector<T>;
+
+private:
+  /// Scale of the norms, zero if the shells are not exact
+  long scale_{ 0L };
+
+  /// Shell of each site
+  std::vector<shell_t> shells_{};
+
+  /// Number of sites in each shell
+  std::vector<std::size_t> multiplicity_{};
+
+  /// Distance of each shell
+  std::vector<double> radius_{};
+
+  /// Exact squared norm of each shell
+  std::vector<std::int64_t> norms_{};
+}; // class DistanceShells
+
+template<class T, class Same>
+inline auto
+DistanceShells::Classify(std::vector<T> const& key, Same&& same)
+  -> std::vector<T>
+{
+  auto order = std::vector<std::size_t>(key.size());
+  std::iota(order.begin(), order.end(), 0UL);
+  std::stable_sort(order.begin(), order.end(), [&](auto a, auto b) {
+    return key[a] < key[b];
+  });
+
+  // the first key of every shell represents it
+  auto first = std::vector<T>{};
+  shells_.assign(key.size(), 0U);
+  multiplicity_.clear();
+  for (auto i : order) {
+    if (first.empty() || !same(first.back(), key[i])) {
+      first.push_back(key[i]);
+      multiplicity_.push_back(0UL);
+    }
+    shells_[i] = static_cast<shell_t>(first.size() - 1UL);
+    multiplicity_.back()++;
+  }
+  return first;
+}
+
+inline auto
+DistanceShells::FromNorms(std::vector<std::int64_t> const& norms, long scale)
+  -> DistanceShells
+{
+  assert(scale > 0L);
+  auto shells = DistanceShells();
+  shells.scale_ = scale;
+  shells.norms_ = shells.Classify(
+    norms, [](std::int64_t a, std::int64_t b) { return a == b; });
+  for (auto n : shells.norms_) {
+    shells.radius_.push_back(
+      std::sqrt(static_cast<double>(n) / static_cast<double>(scale)));
+  }
+  return shells;
+}
+
+inline auto
+DistanceShells::FromSquaredDistances(std::vector<double> const& squared)
+  -> DistanceShells
+{
+  auto shells = DistanceShells();
+  auto first = shells.Classify(squared, [](double a, double b) {
+    return b - a <= Tolerance * std::max(1.0, a);
+  });
+  for (auto x : first) {
+    shells.radius_.push_back(std::sqrt(x));
+  }
+  return shells;
+}
+
+inline auto
+DistanceShells::GetMetricScale(std::vector<double> const& metric) -> long
+{
+  for (auto m = 1L; m <= MaxMetricScale; m++) {
+    const auto integer =
+      std::all_of(metric.begin(), metric.end(), [m](double g) {
+        auto x = static_cast<double>(m) * g;
+        return std::abs(x - std::round(x)) <=
+               Tolerance * std::max(1.0, std::abs(x));
+      });
+    if (integer) {
+      return m;
+    }
+  }
+  return 0L;
+}
+
+inline auto
+DistanceShells::GetSites(std::size_t k) const -> std::vector<std::size_t>
+{
+  auto sites = std::vector<std::size_t>{};
+  sites.reserve(GetMultiplicity(k));
+  for (auto i = 0UL; i < shells_.size(); i++) {
+    if (shells_[i] == k) {
+      sites.push_back(i);
+    }
+  }
+  return sites;
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -36,6 +36,26 @@ public:
 private:
 }; // class BadParsing
 
+/// Exception for binary files of a lattice which cannot be used
+class BadLatticeFile : public std::exception
+{
+public:
+  /// Construct the exception with the reason of the failure
+  explicit BadLatticeFile(std::string message)
+    : message_(std::move(message))
+  {
+  }
+
+  [[nodiscard]] auto what() const noexcept -> const char* override
+  {
+    return message_.c_str();
+  }
+
+private:
+  /// Reason of the failure
+  std::string message_{};
+}; // class BadLatticeFile
+
 } // namespace bwsl::exception
 
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
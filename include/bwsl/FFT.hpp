@@ -0,0 +1,475 @@
+//===-- FFT.hpp ------------------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the FFT Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/MathUtils.hpp>
+
+// std
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Multidimensional mixed-radix Fast Fourier Transform.
+///
+/// The data is a row-major array over a grid of the given sizes, i.e. the
+/// same layout used by HyperCubicGrid for the site indices. The transform is
+/// unnormalized in both directions:
+///
+///   Forward:  X(q) = sum_x x(x) exp(-2 pi i sum_d q_d x_d / L_d)
+///   Backward: x(x) = sum_q X(q) exp(+2 pi i sum_d q_d x_d / L_d)
+///
+/// Every length is supported. Lengths are factorized in radices 4, 2, 3, 5,
+/// which have their own butterflies, and the remaining prime factors, which
+/// are handled with a generic butterfly.
+///
+class FFT
+{
+public:
+  /// Type of the complex numbers transformed
+  using complex_t = std::complex<double>;
+
+  /// Sizes of the grid
+  using gridsize_t = std::vector<size_t>;
+
+  /// Direction of the transform
+  enum class direction_t
+  {
+    Forward,
+    Backward,
+  };
+
+  /// Default constructor
+  FFT() = default;
+
+  /// Construct a plan for a grid with given sizes
+  explicit FFT(gridsize_t const& size);
+
+  /// Copy constructor
+  FFT(FFT const& that) = default;
+
+  /// Move constructor
+  FFT(FFT&& that) = default;
+
+  /// Copy assignment operator
+  auto operator=(FFT const& that) -> FFT& = default;
+
+  /// Move assignment operator
+  auto operator=(FFT&& that) -> FFT& = default;
+
+  /// Default destructor
+  virtual ~FFT() = default;
+
+  /// Get the sizes of the grid
+  [[nodiscard]] auto GetSize() const -> gridsize_t const& { return size_; }
+
+  /// Get the total number of points transformed
+  [[nodiscard]] auto GetNumPoints() const -> size_t { return numpoints_; }
+
+  /// Transform in place the data stored in row-major order
+  auto Transform(std::vector<complex_t>& data,
+                 direction_t direction = direction_t::Forward) const -> void;
+
+protected:
+  /// Plan for a one dimensional transform
+  struct Plan1D
+  {
+    /// Length of the transform
+    size_t n{ 0UL };
+
+    /// Pairs (radix, remaining length) for each stage
+    std::vector<size_t> factors{};
+
+    /// Forward twiddle factors exp(-2 pi i k / n)
+    std::vector<complex_t> twiddles{};
+  };
+
+  /// Build the plan for a one dimensional transform of length @p n
+  [[nodiscard]] static auto MakePlan(size_t n) -> Plan1D;
+
+  /// Recursive decimation in time step
+  static auto Work(Plan1D const& plan,
+                   complex_t* out,
+                   complex_t const* in,
+                   size_t fstride,
+                   size_t const* factors,
+                   bool inverse,
+                   std::vector<complex_t>& scratch) -> void;
+
+  /// Butterfly of radix 2
+  static auto Butterfly2(Plan1D const& plan,
+                         complex_t* out,
+                         size_t fstride,
+                         size_t m,
+                         bool inverse) -> void;
+
+  /// Butterfly of radix 3
+  static auto Butterfly3(Plan1D const& plan,
+                         complex_t* out,
+                         size_t fstride,
+                         size_t m,
+                         bool inverse) -> void;
+
+  /// Butterfly of radix 4
+  static auto Butterfly4(Plan1D const& plan,
+                         complex_t* out,
+                         size_t fstride,
+                         size_t m,
+                         bool inverse) -> void;
+
+  /// Butterfly of radix 5
+  static auto Butterfly5(Plan1D const& plan,
+                         complex_t* out,
+                         size_t fstride,
+                         size_t m,
+                         bool inverse) -> void;
+
+  /// Butterfly of generic radix @p p
+  static auto ButterflyGeneric(Plan1D const& plan,
+                               complex_t* out,
+                               size_t fstride,
+                               size_t m,
+                               size_t p,
+                               bool inverse,
+                               std::vector<complex_t>& scratch) -> void;
+
+private:
+  /// Size of the grid
+  gridsize_t size_{};
+
+  /// Total number of points
+  size_t numpoints_{ 0UL };
+
+  /// One dimensional plans, one for each axis
+  std::vector<Plan1D> plans_{};
+}; // class FFT
+
+inline FFT::FFT(gridsize_t const& size)
+  : size_(size)
+  , numpoints_(accumulate_product(size))
+{
+  for (auto n : size_) {
+    plans_.push_back(MakePlan(n));
+  }
+}
+
+inline auto
+FFT::MakePlan(size_t n) -> Plan1D
+{
+  assert(n > 0UL);
+
+  auto plan = Plan1D{};
+  plan.n = n;
+
+  // factorize preferring the radices with a specialized butterfly
+  auto rest = n;
+  auto p = 4UL;
+  while (rest > 1UL) {
+    while (rest % p != 0UL) {
+      switch (p) {
+        case 4UL:
+          p = 2UL;
+          break;
+        case 2UL:
+          p = 3UL;
+          break;
+        default:
+          p += 2UL;
+      }
+      if (p * p > rest) {
+        p = rest;
+      }
+    }
+    rest /= p;
+    plan.factors.push_back(p);
+    plan.factors.push_back(rest);
+  }
+
+  plan.twiddles.resize(n);
+  for (auto k = 0UL; k < n; k++) {
+    auto phase = -2.0 * M_PI * static_cast<double>(k) / static_cast<double>(n);
+    plan.twiddles[k] = std::polar(1.0, phase);
+  }
+
+  return plan;
+}
+
+inline auto
+FFT::Transform(std::vector<complex_t>& data, direction_t direction) const
+  -> void
+{
+  assert(data.size() == numpoints_);
+
+  const auto inverse = direction == direction_t::Backward;
+  const auto maxn = size_.empty() ? 0UL : max(size_);
+  auto line = std::vector<complex_t>(maxn);
+  auto out = std::vector<complex_t>(maxn);
+  auto scratch = std::vector<complex_t>{};
+
+  // transform along each axis, the stride of the last axis is 1
+  auto stride = numpoints_;
+  for (auto d = 0UL; d < size_.size(); d++) {
+    auto const& plan = plans_[d];
+    const auto n = plan.n;
+    stride /= n;
+
+    if (n == 1UL) {
+      continue;
+    }
+
+    // every line along axis d starts at an offset `outer * n * stride + inner`
+    const auto nouter = numpoints_ / (n * stride);
+    for (auto outer = 0UL; outer < nouter; outer++) {
+      for (auto inner = 0UL; inner < stride; inner++) {
+        auto* base = data.data() + outer * n * stride + inner;
+        for (auto k = 0UL; k < n; k++) {
+          line[k] = base[k * stride];
+        }
+        Work(plan, out.data(), line.data(), 1UL, plan.factors.data(), inverse,
+             scratch);
+        for (auto k = 0UL; k < n; k++) {
+          base[k * stride] = out[k];
+        }
+      }
+    }
+  }
+}
+
+inline auto
+FFT::Work(Plan1D const& plan,
+          complex_t* out,
+          complex_t const* in,
+          size_t fstride,
+          size_t const* factors,
+          bool inverse,
+          std::vector<complex_t>& scratch) -> void
+{
+  const auto p = factors[0];
+  const auto m = factors[1];
+
+  if (m == 1UL) {
+    for (auto q = 0UL; q < p; q++) {
+      out[q] = in[q * fstride];
+    }
+  } else {
+    // p transforms of length m over the decimated input
+    for (auto q = 0UL; q < p; q++) {
+      Work(plan, out + q * m, in + q * fstride, fstride * p, factors + 2,
+           inverse, scratch);
+    }
+  }
+
+  switch (p) {
+    case 2UL:
+      Butterfly2(plan, out, fstride, m, inverse);
+      break;
+    case 3UL:
+      Butterfly3(plan, out, fstride, m, inverse);
+      break;
+    case 4UL:
+      Butterfly4(plan, out, fstride, m, inverse);
+      break;
+    case 5UL:
+      Butterfly5(plan, out, fstride, m, inverse);
+      break;
+    default:
+      ButterflyGeneric(plan, out, fstride, m, p, inverse, scratch);
+  }
+}
+
+inline auto
+FFT::Butterfly2(Plan1D const& plan,
+                complex_t* out,
+                size_t fstride,
+                size_t m,
+                bool inverse) -> void
+{
+  auto* out2 = out + m;
+  for (auto k = 0UL; k < m; k++) {
+    auto tw = plan.twiddles[k * fstride];
+    auto t = out2[k] * (inverse ? std::conj(tw) : tw);
+    out2[k] = out[k] - t;
+    out[k] += t;
+  }
+}
+
+inline auto
+FFT::Butterfly3(Plan1D const& plan,
+                complex_t* out,
+                size_t fstride,
+                size_t m,
+                bool inverse) -> void
+{
+  auto const& tw = plan.twiddles;
+  // fstride * m * 3 is the length of the transform
+  const auto sin3 = (inverse ? -1.0 : 1.0) * tw[fstride * m].imag();
+  for (auto k = 0UL; k < m; k++) {
+    auto tw1 = tw[k * fstride];
+    auto tw2 = tw[2UL * k * fstride];
+    if (inverse) {
+      tw1 = std::conj(tw1);
+      tw2 = std::conj(tw2);
+    }
+
+    auto s1 = out[k + m] * tw1;
+    auto s2 = out[k + 2UL * m] * tw2;
+    auto sum = s1 + s2;
+    auto diff = (s1 - s2) * sin3;
+
+    // cos(2 pi / 3) = -1 / 2, the sine is in diff
+    auto half = out[k] - 0.5 * sum;
+    auto rot = complex_t(-diff.imag(), diff.real());
+
+    out[k] += sum;
+    out[k + m] = half + rot;
+    out[k + 2UL * m] = half - rot;
+  }
+}
+
+inline auto
+FFT::Butterfly4(Plan1D const& plan,
+                complex_t* out,
+                size_t fstride,
+                size_t m,
+                bool inverse) -> void
+{
+  auto const& tw = plan.twiddles;
+  for (auto k = 0UL; k < m; k++) {
+    auto tw1 = tw[k * fstride];
+    auto tw2 = tw[2UL * k * fstride];
+    auto tw3 = tw[3UL * k * fstride];
+    if (inverse) {
+      tw1 = std::conj(tw1);
+      tw2 = std::conj(tw2);
+      tw3 = std::conj(tw3);
+    }
+
+    auto s0 = out[k + m] * tw1;
+    auto s1 = out[k + 2UL * m] * tw2;
+    auto s2 = out[k + 3UL * m] * tw3;
+
+    auto s5 = out[k] - s1;
+    auto s4 = out[k] + s1;
+    auto s3 = s0 + s2;
+    auto s6 = s0 - s2;
+
+    // multiplication by -i (forward) or +i (backward)
+    auto rot = inverse ? complex_t(-s6.imag(), s6.real())
+                       : complex_t(s6.imag(), -s6.real());
+
+    out[k] = s4 + s3;
+    out[k + 2UL * m] = s4 - s3;
+    out[k + m] = s5 + rot;
+    out[k + 3UL * m] = s5 - rot;
+  }
+}
+
+inline auto
+FFT::Butterfly5(Plan1D const& plan,
+                complex_t* out,
+                size_t fstride,
+                size_t m,
+                bool inverse) -> void
+{
+  auto const& tw = plan.twiddles;
+  // exp(-/+ 2 pi i / 5) and exp(-/+ 4 pi i / 5)
+  auto ya = tw[fstride * m];
+  auto yb = tw[2UL * fstride * m];
+  if (inverse) {
+    ya = std::conj(ya);
+    yb = std::conj(yb);
+  }
+  for (auto k = 0UL; k < m; k++) {
+    auto tw1 = tw[k * fstride];
+    auto tw2 = tw[2UL * k * fstride];
+    auto tw3 = tw[3UL * k * fstride];
+    auto tw4 = tw[4UL * k * fstride];
+    if (inverse) {
+      tw1 = std::conj(tw1);
+      tw2 = std::conj(tw2);
+      tw3 = std::conj(tw3);
+      tw4 = std::conj(tw4);
+    }
+
+    auto s0 = out[k];
+    auto s1 = out[k + m] * tw1;
+    auto s2 = out[k + 2UL * m] * tw2;
+    auto s3 = out[k + 3UL * m] * tw3;
+    auto s4 = out[k + 4UL * m] * tw4;
+
+    // the symmetric and antisymmetric combinations of the opposite inputs
+    auto s7 = s1 + s4;
+    auto s10 = s1 - s4;
+    auto s8 = s2 + s3;
+    auto s9 = s2 - s3;
+
+    auto s5 = s0 + s7 * ya.real() + s8 * yb.real();
+    auto s6 = complex_t(s10.imag() * ya.imag() + s9.imag() * yb.imag(),
+                        -s10.real() * ya.imag() - s9.real() * yb.imag());
+    auto s11 = s0 + s7 * yb.real() + s8 * ya.real();
+    auto s12 = complex_t(-s10.imag() * yb.imag() + s9.imag() * ya.imag(),
+                         s10.real() * yb.imag() - s9.real() * ya.imag());
+
+    out[k] = s0 + s7 + s8;
+    out[k + m] = s5 - s6;
+    out[k + 4UL * m] = s5 + s6;
+    out[k + 2UL * m] = s11 + s12;
+    out[k + 3UL * m] = s11 - s12;
+  }
+}
+
+inline auto
+FFT::ButterflyGeneric(Plan1D const& plan,
+                      complex_t* out,
+                      size_t fstride,
+                      size_t m,
+                      size_t p,
+                      bool inverse,
+                      std::vector<complex_t>& scratch) -> void
+{
+  auto const& tw = plan.twiddles;
+  const auto n = plan.n;
+  scratch.resize(p);
+
+  for (auto u = 0UL; u < m; u++) {
+    for (auto q = 0UL; q < p; q++) {
+      scratch[q] = out[u + q * m];
+    }
+
+    for (auto q = 0UL; q < p; q++) {
+      const auto k = u + q * m;
+      const auto step = fstride * k % n;
+      auto twidx = 0UL;
+      auto acc = scratch[0];
+      for (auto r = 1UL; r < p; r++) {
+        twidx += step;
+        if (twidx >= n) {
+          twidx -= n;
+        }
+        auto t = inverse ? std::conj(tw[twidx]) : tw[twidx];
+        acc += scratch[r] * t;
+      }
+      out[k] = acc;
+    }
+  }
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,127 @@
+//===-- FastDivision.hpp ---------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the FastDivisor Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// std
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace bwsl {
+
+///
+/// Unsigned integer division by a divisor known only at run time, but used
+/// many times.
+///
+/// The quotient is computed with a multiplication by a precomputed magic
+/// number and two shifts (Granlund and Montgomery, "Division by invariant
+/// integers using multiplication", 1994), the same scheme used by libdivide.
+/// Powers of two reduce to a single shift.
+///
+class FastDivisor
+{
+public:
+  /// Type of the operands
+  using value_t = std::uint64_t;
+
+  /// Default constructor, divides by one
+  FastDivisor() = default;
+
+  /// Construct a divisor for @p d
+  explicit FastDivisor(value_t d);
+
+  /// Copy constructor
+  FastDivisor(FastDivisor const& that) = default;
+
+  /// Move constructor
+  FastDivisor(FastDivisor&& that) = default;
+
+  /// Copy assignment operator
+  auto operator=(FastDivisor const& that) -> FastDivisor& = default;
+
+  /// Move assignment operator
+  auto operator=(FastDivisor&& that) -> FastDivisor& = default;
+
+  /// Default destructor
+  ~FastDivisor() = default;
+
+  /// Get the divisor
+  [[nodiscard]] auto GetDivisor() const -> value_t { return divisor_; }
+
+  /// Compute n / d
+  [[nodiscard]] auto Divide(value_t n) const -> value_t
+  {
+    if (magic_ == 0UL) {
+      return n >> shift_;
+    }
+    const auto t = MulHi(magic_, n);
+    return (t + ((n - t) >> 1U)) >> shift_;
+  }
+
+  /// Compute n % d
+  [[nodiscard]] auto Modulo(value_t n) const -> value_t
+  {
+    return n - Divide(n) * divisor_;
+  }
+
+protected:
+  /// Upper 64 bits of the product of @p a and @p b
+  [[nodiscard]] static auto MulHi(value_t a, value_t b) -> value_t;
+
+private:
+  /// Divisor
+  value_t divisor_{ 1UL };
+
+  /// Magic multiplier, zero for powers of two
+  value_t magic_{ 0UL };
+
+  /// Final shift
+  unsigned shift_{ 0U };
+}; // class FastDivisor
+
+inline FastDivisor::FastDivisor(value_t d)
+  : divisor_(d)
+{
+  assert(d != 0UL && "Division by zero");
+
+  // floor(log2(d))
+  auto lg = 0U;
+  while (lg < 63U && (d >> (lg + 1U)) != 0UL) {
+    lg++;
+  }
+
+  if ((d & (d - 1UL)) == 0UL) {
+    shift_ = lg;
+    return;
+  }
+
+  // with l = ceil(log2(d)) the multiplier is floor(2^64 (2^l - d) / d) + 1
+  __extension__ typedef unsigned __int128 wide_t;
+  const auto l = lg + 1U;
+  const auto num = ((wide_t(1) << l) - d) << 64U;
+  magic_ = static_cast<value_t>(num / d) + 1UL;
+  shift_ = l - 1U;
+}
+
+inline auto
+FastDivisor::MulHi(value_t a, value_t b) -> value_t
+{
+  __extension__ typedef unsigned __int128 wide_t;
+  return static_cast<value_t>((static_cast<wide_t>(a) * b) >> 64U);
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,94 @@
+//===-- Hash.hpp -----------------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Non cryptographic hashes and checksums
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace bwsl {
+
+/// Initial value of the 64 bits FNV-1a hash
+inline constexpr std::uint64_t HashSeed = 0xcbf29ce484222325ULL;
+
+///
+/// 64 bits FNV-1a hash of @p size bytes at @p data , continuing from @p seed .
+/// Hashes of consecutive pieces can be chained passing the previous hash as
+/// the seed.
+///
+inline auto
+hash_bytes(void const* data, std::size_t size, std::uint64_t seed = HashSeed)
+  -> std::uint64_t
+{
+  constexpr auto prime = 0x100000001b3ULL;
+  auto const* bytes = static_cast<unsigned char const*>(data);
+  auto h = seed;
+  for (auto i = 0UL; i < size; i++) {
+    h ^= bytes[i];
+    h *= prime;
+  }
+  return h;
+}
+
+///
+/// Hash of the object representation of @p value , continuing from @p seed .
+/// Only meaningful for types without padding.
+///
+template<class T>
+inline auto
+hash_value(T const& value, std::uint64_t seed = HashSeed) -> std::uint64_t
+{
+  return hash_bytes(&value, sizeof(T), seed);
+}
+
+///
+/// Checksum of @p size bytes at @p data , continuing from @p seed .
+/// It works on 64 bits words, with a multiplication and a rotation per word,
+/// and is meant to detect corrupted or truncated files, not to resist
+/// attacks. Checksums of consecutive pieces can be chained as long as all the
+/// pieces but the last have a size multiple of eight.
+///
+inline auto
+checksum_bytes(void const* data,
+               std::size_t size,
+               std::uint64_t seed = HashSeed) -> std::uint64_t
+{
+  constexpr auto prime = 0x9e3779b97f4a7c15ULL;
+  auto const* bytes = static_cast<unsigned char const*>(data);
+  auto h = seed;
+  auto mix = [&h](std::uint64_t w) {
+    h ^= w * prime;
+    h = (h << 31U) | (h >> 33U);
+    h *= prime;
+  };
+
+  const auto nwords = size / sizeof(std::uint64_t);
+  for (auto i = 0UL; i < nwords; i++) {
+    auto w = std::uint64_t{};
+    std::memcpy(&w, bytes + i * sizeof(w), sizeof(w));
+    mix(w);
+  }
+  if (const auto rest = size % sizeof(std::uint64_t); rest != 0UL) {
+    auto w = std::uint64_t{};
+    std::memcpy(&w, bytes + nwords * sizeof(w), rest);
+    mix(w ^ rest);
+  }
+  return h;
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -15,59 +15,128 @@
 #pragma once
 
 // bwsl
+#include <bwsl/FastDivision.hpp>
 #include <bwsl/MathUtils.hpp>
 #include <bwsl/Pairs.hpp>
 
 /// std
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace bwsl {
 
+/// Value of the dimension for grids whose dimension is known only at run time
+inline constexpr std::size_t DynamicDim = 0UL;
+
+/// Type of the boundaries
+enum class GridBoundaries
+{
+  Open,
+  Closed,
+};
+
+/// Numbering of the sites
+enum class GridOrdering
+{
+  /// Row-major order, the last dimension is contiguous
+  RowMajor,
+  /// Order of the Morton (Z-order) curve, which keeps the sites close along
+  /// any dimension close in memory
+  Morton,
+};
+
+template<std::size_t D>
+class BasicGridSiteRange;
+
 ///
 /// Hypercubic Grid
 ///
-class HyperCubicGrid
+/// With a dimension @p D fixed at compile time the coordinates and the sizes
+/// are stored in std::array, so that no geometry query allocates memory and
+/// the loops over the dimensions can be unrolled. With `D == DynamicDim` the
+/// dimension is given by the sizes passed to the constructor.
+///
+/// Sites are numbered in row-major order by default. The strides of the
+/// dimensions are precomputed and the divisions needed to obtain the
+/// coordinates of a site are performed with a multiplication by a magic
+/// number (see FastDivisor). Loops over all the sites should use GetSites(),
+/// which updates the coordinates incrementally without any division.
+///
+/// When all the sizes are powers of two the coordinates are wrapped with a
+/// bit mask and, with closed boundaries, GetMappedSite, GetUnMappedSite and
+/// GetJump work directly on the bit fields of the indices.
+///
+/// With GridOrdering::Morton the sites are numbered along the Morton curve
+/// instead, so that the neighbors along the slow dimensions of large grids
+/// are not far apart in memory. Sizes which are not powers of two are
+/// handled by skipping the points of the curve outside the grid. The
+/// permutation to and from the row-major numbering is stored, shared by the
+/// copies of the grid, and used to convert indices and coordinates.
+///
+template<std::size_t D>
+class BasicHyperCubicGrid
 {
 public:
   /// Coordinates
-  using coords_t = std::vector<long>;
+  using coords_t = std::conditional_t<D == DynamicDim,
+                                      std::vector<long>,
+                                      std::array<long, D>>;
 
   /// Sizes of the grid
-  using gridsize_t = std::vector<size_t>;
+  using gridsize_t = std::conditional_t<D == DynamicDim,
+                                        std::vector<size_t>,
+                                        std::array<size_t, D>>;
 
   /// Type for the site indices
   using index_t = size_t;
 
   /// Type of the boundaries
-  enum class boundaries_t
-  {
-    Open,
-    Closed,
-  };
+  using boundaries_t = GridBoundaries;
+
+  /// Precomputed divisors, one for each dimension
+  using divisors_t = std::conditional_t<D == DynamicDim,
+                                        std::vector<FastDivisor>,
+                                        std::array<FastDivisor, D>>;
 
   /// Default constructor
-  HyperCubicGrid() = default;
+  BasicHyperCubicGrid() = default;
 
   /// Copy constructor
-  HyperCubicGrid(const HyperCubicGrid&) = default;
+  BasicHyperCubicGrid(const BasicHyperCubicGrid&) = default;
 
   /// Move constructor
-  HyperCubicGrid(HyperCubicGrid&&) = default;
+  BasicHyperCubicGrid(BasicHyperCubicGrid&&) = default;
 
   /// Copy assignment operator
-  auto operator=(const HyperCubicGrid&) -> HyperCubicGrid& = default;
+  auto operator=(const BasicHyperCubicGrid&) -> BasicHyperCubicGrid& = default;
 
   /// Move assignment operator
-  auto operator=(HyperCubicGrid&&) -> HyperCubicGrid& = default;
+  auto operator=(BasicHyperCubicGrid&&) -> BasicHyperCubicGrid& = default;
 
   /// Constructor
-  HyperCubicGrid(gridsize_t const& size, boundaries_t boundaries);
+  BasicHyperCubicGrid(gridsize_t const& size,
+                      boundaries_t boundaries,
+                      GridOrdering ordering = GridOrdering::RowMajor);
 
   /// Default destructor
-  virtual ~HyperCubicGrid() = default;
+  virtual ~BasicHyperCubicGrid() = default;
 
   /// Get the number of dimension of the grid
-  [[nodiscard]] auto GetDim() const -> size_t { return dim_; }
+  [[nodiscard]] auto GetDim() const -> size_t
+  {
+    if constexpr (D == DynamicDim) {
+      return dim_;
+    } else {
+      return D;
+    }
+  }
 
   /// Check if the grid has open boundaries
   [[nodiscard]] auto HasOpenBoundaries() const -> bool
@@ -82,11 +151,60 @@ public:
   }
 
   /// Get the size of the grid
-  [[nodiscard]] auto GetSize() const -> std::vector<size_t> const&
+  [[nodiscard]] auto GetSize() const -> gridsize_t const&
   {
     return size_;
   }
 
+  /// Get the strides of the dimensions, the difference between the row-major
+  /// indices of two sites whose coordinates differ by one along a single
+  /// dimension.
+  [[nodiscard]] auto GetStrides() const -> gridsize_t const&
+  {
+    return strides_;
+  }
+
+  /// Check if all the sizes of the grid are powers of two
+  [[nodiscard]] auto HasPowerOfTwoSizes() const -> bool { return pow2_; }
+
+  /// Get the numbering of the sites
+  [[nodiscard]] auto GetOrdering() const -> GridOrdering { return ordering_; }
+
+  /// Check if the sites are numbered in row-major order
+  [[nodiscard]] auto IsRowMajor() const -> bool
+  {
+    return ordering_ == GridOrdering::RowMajor;
+  }
+
+  /// Get the row-major index of site @p i
+  [[nodiscard]] auto GetRowMajorIndex(index_t i) const -> index_t
+  {
+    assert(IndexIsValid(i));
+    return IsRowMajor() ? i : permutation_->torowmajor[i];
+  }
+
+  /// Get the site with row-major index @p r
+  [[nodiscard]] auto GetIndexFromRowMajor(index_t r) const -> index_t
+  {
+    assert(IndexIsValid(r));
+    return IsRowMajor() ? r : permutation_->fromrowmajor[r];
+  }
+
+  /// Reorder @p values , one for each site, in row-major order, for example
+  /// to write them
+  template<class T>
+  [[nodiscard]] auto ToRowMajor(std::vector<T> const& values) const
+    -> std::vector<T>;
+
+  /// Reorder @p values , one for each site in row-major order, in the order
+  /// of the sites
+  template<class T>
+  [[nodiscard]] auto FromRowMajor(std::vector<T> const& values) const
+    -> std::vector<T>;
+
+  /// Get a range over all the sites, visited in order of increasing index
+  [[nodiscard]] auto GetSites() const -> BasicGridSiteRange<D>;
+
   /// Get the site i mapping (a, b) to (0, i)
   [[nodiscard]] auto GetMappedSite(index_t a, index_t b) const -> index_t;
 
@@ -132,14 +250,46 @@ public:
   [[nodiscard]] auto GetJump(size_t a, size_t b) const -> coords_t;
 
   /// Get this
-  [[nodiscard]] auto GetGrid() const -> HyperCubicGrid { return *this; }
+  [[nodiscard]] auto GetGrid() const -> BasicHyperCubicGrid { return *this; }
+
+  /// Get coordinates with all the components equal to @p value
+  [[nodiscard]] auto MakeCoords(long value = 0L) const -> coords_t
+  {
+    return make_filled<coords_t>(GetDim(), value);
+  }
 
 protected:
   /// Check the dimensions
   template<class C>
   auto HasSameDimension(C const& v) const -> bool
   {
-    return v.size() == dim_;
+    return v.size() == GetDim();
+  }
+
+  /// Bring the coordinates inside the grid as with closed boundaries
+  auto Wrap(coords_t& coords) const -> void;
+
+  /// Check if the indices are made of the bit fields of the coordinates
+  [[nodiscard]] auto HasBitFields() const -> bool
+  {
+    return pow2_ && IsRowMajor() && HasClosedBoundaries();
+  }
+
+  /// Convert a row-major index to coordinates
+  [[nodiscard]] auto RowMajorCoordinates(index_t offset) const -> coords_t;
+
+  /// Convert coordinates to a row-major index
+  [[nodiscard]] auto RowMajorIndex(coords_t const& coords) const -> index_t;
+
+  /// Compute the permutation between the Morton order and the row-major one
+  auto ComputeMortonOrder() -> void;
+
+  /// Difference between the coordinates of @p b and @p a along the
+  /// dimension @p i , with closed boundaries and power of two sizes
+  [[nodiscard]] auto FieldDifference(index_t a, index_t b, size_t i) const
+    -> index_t
+  {
+    return ((b >> shifts_[i]) - (a >> shifts_[i])) & masks_[i];
   }
 
 private:
@@ -149,6 +299,21 @@ private:
   /// Size of the grid
   gridsize_t size_{};
 
+  /// Strides of each dimension
+  gridsize_t strides_{};
+
+  /// Divisors for the strides
+  divisors_t divisors_{};
+
+  /// Whether all the sizes are powers of two
+  bool pow2_{ false };
+
+  /// Masks `size - 1` for each dimension, used when pow2_ is set
+  gridsize_t masks_{};
+
+  /// Logarithm of the strides, used when pow2_ is set
+  gridsize_t shifts_{};
+
   /// Number of sites on the grid
   size_t numsites_{ 0UL };
 
@@ -157,70 +322,268 @@ private:
 
   /// Boundary conditions
   boundaries_t boundaries_{ boundaries_t::Open };
-}; // class HyperCubicGrid
 
-inline HyperCubicGrid::HyperCubicGrid(gridsize_t const& size,
-                                      boundaries_t boundaries)
+  /// Numbering of the sites
+  GridOrdering ordering_{ GridOrdering::RowMajor };
+
+  /// Permutation between the numbering of the sites and the row-major one
+  struct Permutation
+  {
+    /// Row-major index of each site
+    std::vector<index_t> torowmajor{};
+
+    /// Site of each row-major index
+    std::vector<index_t> fromrowmajor{};
+  };
+
+  /// Permutation, only with an ordering other than the row-major one
+  std::shared_ptr<Permutation const> permutation_{};
+}; // class BasicHyperCubicGrid
+
+/// Hypercubic grid with the dimension known at run time
+using HyperCubicGrid = BasicHyperCubicGrid<DynamicDim>;
+
+/// Hypercubic grids with the dimension fixed at compile time
+using HyperCubicGrid1D = BasicHyperCubicGrid<1UL>;
+using HyperCubicGrid2D = BasicHyperCubicGrid<2UL>;
+using HyperCubicGrid3D = BasicHyperCubicGrid<3UL>;
+
+template<std::size_t D>
+inline BasicHyperCubicGrid<D>::BasicHyperCubicGrid(gridsize_t const& size,
+                                                   boundaries_t boundaries,
+                                                   GridOrdering ordering)
   : dim_(size.size())
   , size_(size)
+  , strides_(make_filled<gridsize_t>(size.size(), 1UL))
+  , divisors_(make_filled<divisors_t>(size.size(), FastDivisor()))
+  , masks_(make_filled<gridsize_t>(size.size(), 0UL))
+  , shifts_(make_filled<gridsize_t>(size.size(), 0UL))
   , numsites_(accumulate_product(size))
   , numpairs_(pairs::GetNumPairs(numsites_))
   , boundaries_(boundaries)
+  , ordering_(ordering)
+{
+  for (auto i = dim_; i-- > 1UL;) {
+    strides_[i - 1UL] = strides_[i] * size_[i];
+  }
+  for (auto i = 0UL; i < dim_; i++) {
+    divisors_[i] = FastDivisor(strides_[i]);
+  }
+
+  pow2_ = std::all_of(size_.begin(), size_.end(), [](size_t s) {
+    return s != 0UL && (s & (s - 1UL)) == 0UL;
+  });
+  if (pow2_) {
+    for (auto i = 0UL; i < dim_; i++) {
+      masks_[i] = size_[i] - 1UL;
+      while ((1UL << shifts_[i]) < strides_[i]) {
+        shifts_[i]++;
+      }
+    }
+  }
+
+  if (ordering_ == GridOrdering::Morton) {
+    ComputeMortonOrder();
+  }
+}
+
+template<std::size_t D>
+inline auto
+BasicHyperCubicGrid<D>::ComputeMortonOrder() -> void
 {
+  auto bits = 0UL;
+  for (auto s : size_) {
+    while ((1UL << bits) < s) {
+      bits++;
+    }
+  }
+  assert(bits * GetDim() <= 64UL && "grid too large for the Morton order");
+
+  // the key interleaves the bits of the coordinates, the last dimension
+  // taking the lowest bit of each group as in the row-major order
+  auto keys = std::vector<std::pair<std::uint64_t, index_t>>{};
+  keys.reserve(numsites_);
+  for (auto r = 0UL; r < numsites_; r++) {
+    const auto coords = RowMajorCoordinates(r);
+    auto key = std::uint64_t{ 0 };
+    for (auto b = 0UL; b < bits; b++) {
+      for (auto d = 0UL; d < GetDim(); d++) {
+        const auto c = static_cast<std::uint64_t>(coords[d]);
+        key |= ((c >> b) & 1U) << (b * GetDim() + GetDim() - 1UL - d);
+      }
+    }
+    keys.emplace_back(key, r);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  auto permutation = std::make_shared<Permutation>();
+  permutation->torowmajor.resize(numsites_);
+  permutation->fromrowmajor.resize(numsites_);
+  for (auto i = 0UL; i < numsites_; i++) {
+    permutation->torowmajor[i] = keys[i].second;
+    permutation->fromrowmajor[keys[i].second] = i;
+  }
+  permutation_ = std::move(permutation);
 }
 
+template<std::size_t D>
+template<class T>
 inline auto
-HyperCubicGrid::GetCoordinates(index_t offset) const -> coords_t
+BasicHyperCubicGrid<D>::ToRowMajor(std::vector<T> const& values) const
+  -> std::vector<T>
 {
-  return index_to_array<coords_t, gridsize_t>(offset, size_);
+  assert(values.size() == numsites_);
+  if (IsRowMajor()) {
+    return values;
+  }
+  auto ordered = std::vector<T>(numsites_);
+  for (auto i = 0UL; i < numsites_; i++) {
+    ordered[permutation_->torowmajor[i]] = values[i];
+  }
+  return ordered;
 }
 
+template<std::size_t D>
+template<class T>
 inline auto
-HyperCubicGrid::GetIndex(coords_t const& coords) const -> index_t
+BasicHyperCubicGrid<D>::FromRowMajor(std::vector<T> const& values) const
+  -> std::vector<T>
 {
-  return array_to_index(coords, size_);
+  assert(values.size() == numsites_);
+  if (IsRowMajor()) {
+    return values;
+  }
+  auto ordered = std::vector<T>(numsites_);
+  for (auto i = 0UL; i < numsites_; i++) {
+    ordered[i] = values[permutation_->torowmajor[i]];
+  }
+  return ordered;
+}
+
+template<std::size_t D>
+inline auto
+BasicHyperCubicGrid<D>::GetCoordinates(index_t offset) const -> coords_t
+{
+  assert(IndexIsValid(offset));
+  return RowMajorCoordinates(GetRowMajorIndex(offset));
 }
 
+template<std::size_t D>
 inline auto
-HyperCubicGrid::GetMappedSite(index_t a, index_t b) const -> index_t
+BasicHyperCubicGrid<D>::GetIndex(coords_t const& coords) const -> index_t
 {
+  const auto r = RowMajorIndex(coords);
+  return IsRowMajor() ? r : permutation_->fromrowmajor[r];
+}
+
+template<std::size_t D>
+inline auto
+BasicHyperCubicGrid<D>::RowMajorCoordinates(index_t offset) const -> coords_t
+{
+  auto coords = MakeCoords();
+  if (GetDim() == 0UL) {
+    return coords;
+  }
+
+  // the last dimension has unit stride
+  const auto last = GetDim() - 1UL;
+  for (auto i = 0UL; i < last; i++) {
+    const auto q = divisors_[i].Divide(offset);
+    coords[i] = static_cast<long>(q);
+    offset -= q * strides_[i];
+  }
+  coords[last] = static_cast<long>(offset);
+  return coords;
+}
+
+template<std::size_t D>
+inline auto
+BasicHyperCubicGrid<D>::RowMajorIndex(coords_t const& coords) const -> index_t
+{
+  assert(HasSameDimension(coords));
+  auto index = 0UL;
+  for (auto i = 0UL; i < GetDim(); i++) {
+    index += strides_[i] * static_cast<index_t>(coords[i]);
+  }
+  return index;
+}
+
+template<std::size_t D>
+inline auto
+BasicHyperCubicGrid<D>::GetMappedSite(index_t a, index_t b) const -> index_t
+{
+  if (HasBitFields()) {
+    auto index = 0UL;
+    for (auto i = 0UL; i < GetDim(); i++) {
+      index |= FieldDifference(a, b, i) << shifts_[i];
+    }
+    return index;
+  }
+
   auto cb = GetCoordinates(b);
   subtract_into(cb, GetCoordinates(a));
   EnforceBoundaries(cb);
   return GetIndex(cb);
 }
 
+template<std::size_t D>
 inline auto
-HyperCubicGrid::GetUnMappedSite(index_t i, index_t a) const -> index_t
+BasicHyperCubicGrid<D>::GetUnMappedSite(index_t i, index_t a) const -> index_t
 {
+  if (HasBitFields()) {
+    auto index = 0UL;
+    for (auto d = 0UL; d < GetDim(); d++) {
+      auto sum = (a >> shifts_[d]) + (i >> shifts_[d]);
+      index |= (sum & masks_[d]) << shifts_[d];
+    }
+    return index;
+  }
+
   auto ca = GetCoordinates(a);
   sum_into(ca, GetCoordinates(i));
   EnforceBoundaries(ca);
   return GetIndex(ca);
 }
 
+template<std::size_t D>
 inline auto
-HyperCubicGrid::EnforceBoundaries(coords_t& coords) const -> void
+BasicHyperCubicGrid<D>::EnforceBoundaries(coords_t& coords) const -> void
 {
-  assert(coords.size() == dim_);
   if (HasClosedBoundaries()) {
-    for (auto i = 0UL; i < dim_; i++) {
-      auto s = static_cast<long>(size_[i]);
-      while (coords[i] < 0) {
-        coords[i] += s;
-      }
-      while (coords[i] >= static_cast<long>(s)) {
-        coords[i] -= s;
-      }
+    Wrap(coords);
+  }
+}
+
+template<std::size_t D>
+inline auto
+BasicHyperCubicGrid<D>::Wrap(coords_t& coords) const -> void
+{
+  assert(HasSameDimension(coords));
+  if (pow2_) {
+    // in two's complement the mask also wraps negative values
+    for (auto i = 0UL; i < GetDim(); i++) {
+      coords[i] &= static_cast<long>(masks_[i]);
+    }
+    return;
+  }
+
+  for (auto i = 0UL; i < GetDim(); i++) {
+    auto s = static_cast<long>(size_[i]);
+    while (coords[i] < 0) {
+      coords[i] += s;
+    }
+    while (coords[i] >= static_cast<long>(s)) {
+      coords[i] -= s;
     }
   }
 }
 
+template<std::size_t D>
 inline auto
-HyperCubicGrid::IsOnGrid(coords_t const& coords) const -> bool
+BasicHyperCubicGrid<D>::IsOnGrid(coords_t const& coords) const -> bool
 {
-  assert(coords.size() == dim_);
-  for (auto i = 0UL; i < dim_; i++) {
+  assert(HasSameDimension(coords));
+  for (auto i = 0UL; i < GetDim(); i++) {
     if (coords[i] < 0L || static_cast<size_t>(coords[i]) >= size_[i]) {
       return false;
     }
@@ -228,23 +591,38 @@ HyperCubicGrid::IsOnGrid(coords_t const& coords) const -> bool
   return true;
 }
 
+template<std::size_t D>
 inline auto
-HyperCubicGrid::GetPairIndex(index_t a, index_t b) const -> index_t
+BasicHyperCubicGrid<D>::GetPairIndex(index_t a, index_t b) const -> index_t
 {
   return bwsl::pairs::GetPairIndex(a, b, numsites_);
 }
 
+template<std::size_t D>
 inline auto
-HyperCubicGrid::GetIndividualIndices(size_t pair) const
+BasicHyperCubicGrid<D>::GetIndividualIndices(size_t pair) const
   -> std::pair<index_t, index_t>
 {
   return bwsl::pairs::GetPair(pair, numsites_);
 }
 
+template<std::size_t D>
 inline auto
-HyperCubicGrid::GetJump(size_t a, size_t b) const -> coords_t
+BasicHyperCubicGrid<D>::GetJump(size_t a, size_t b) const -> coords_t
 {
   assert(IndexIsValid(a) && IndexIsValid(b));
+
+  // the difference modulo the size is in [0, L), the jumps in (-L/2, L/2]
+  if (HasBitFields()) {
+    auto jump = MakeCoords();
+    for (auto i = 0UL; i < GetDim(); i++) {
+      auto c = static_cast<long>(FieldDifference(a, b, i));
+      auto s = static_cast<long>(size_[i]);
+      jump[i] = c > s / 2L ? c - s : c;
+    }
+    return jump;
+  }
+
   auto cb = GetCoordinates(b);
   subtract_into(cb, GetCoordinates(a));
 
@@ -267,6 +645,140 @@ HyperCubicGrid::GetJump(size_t a, size_t b) const -> coords_t
   return cb;
 }
 
+///
+/// Iterator over the sites of a BasicHyperCubicGrid.
+///
+/// It works like an odometer: the coordinates are kept along with the index
+/// and incremented starting from the last dimension, carrying over to the
+/// previous one when the size is reached.
+///
+template<std::size_t D>
+class BasicGridSiteIterator
+{
+public:
+  /// Type of the grid
+  using grid_t = BasicHyperCubicGrid<D>;
+
+  /// Site visited
+  struct site_t
+  {
+    /// Index of the site
+    typename grid_t::index_t index;
+
+    /// Coordinates of the site
+    typename grid_t::coords_t coords;
+  };
+
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = site_t;
+  using difference_type = std::ptrdiff_t;
+  using pointer = site_t const*;
+  using reference = site_t const&;
+
+  /// Default constructor
+  BasicGridSiteIterator() = default;
+
+  /// Construct an iterator pointing to the site @p index of @p grid
+  BasicGridSiteIterator(grid_t const& grid, typename grid_t::index_t index)
+    : grid_(&grid)
+    , site_{ index,
+             index < grid.GetNumSites() ? grid.GetCoordinates(index)
+                                        : grid.MakeCoords() }
+  {
+  }
+
+  /// Get the current site
+  auto operator*() const -> reference { return site_; }
+
+  /// Access the current site
+  auto operator->() const -> pointer { return &site_; }
+
+  /// Move to the next site
+  auto operator++() -> BasicGridSiteIterator&
+  {
+    auto const& size = grid_->GetSize();
+    site_.index++;
+    if (!grid_->IsRowMajor()) {
+      if (site_.index < grid_->GetNumSites()) {
+        site_.coords = grid_->GetCoordinates(site_.index);
+      }
+      return *this;
+    }
+    for (auto i = grid_->GetDim(); i-- > 0UL;) {
+      if (++site_.coords[i] < static_cast<long>(size[i])) {
+        break;
+      }
+      site_.coords[i] = 0L;
+    }
+    return *this;
+  }
+
+  /// Move to the next site
+  auto operator++(int) -> BasicGridSiteIterator
+  {
+    auto old = *this;
+    ++(*this);
+    return old;
+  }
+
+  /// Check if two iterators point to the same site
+  auto operator==(BasicGridSiteIterator const& that) const -> bool
+  {
+    return site_.index == that.site_.index;
+  }
+
+  /// Check if two iterators point to different sites
+  auto operator!=(BasicGridSiteIterator const& that) const -> bool
+  {
+    return site_.index != that.site_.index;
+  }
+
+private:
+  /// Grid visited
+  grid_t const* grid_{ nullptr };
+
+  /// Current site
+  site_t site_{};
+}; // class BasicGridSiteIterator
+
+///
+/// Range with all the sites of a BasicHyperCubicGrid, to be used in range
+/// based for loops. The grid must outlive the range.
+///
+template<std::size_t D>
+class BasicGridSiteRange
+{
+public:
+  /// Type of the iterators
+  using iterator = BasicGridSiteIterator<D>;
+
+  /// Construct the range for @p grid
+  explicit BasicGridSiteRange(BasicHyperCubicGrid<D> const& grid)
+    : grid_(&grid)
+  {
+  }
+
+  /// Iterator to the first site
+  [[nodiscard]] auto begin() const -> iterator { return iterator(*grid_, 0UL); }
+
+  /// Iterator past the last site
+  [[nodiscard]] auto end() const -> iterator
+  {
+    return iterator(*grid_, grid_->GetNumSites());
+  }
+
+private:
+  /// Grid visited
+  BasicHyperCubicGrid<D> const* grid_{ nullptr };
+}; // class BasicGridSiteRange
+
+template<std::size_t D>
+inline auto
+BasicHyperCubicGrid<D>::GetSites() const -> BasicGridSiteRange<D>
+{
+  return BasicGridSiteRange<D>(*this);
+}
+
 } // namespace bwsl
 
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
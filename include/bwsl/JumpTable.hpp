@@ -0,0 +1,158 @@
+//===-- JumpTable.hpp ------------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the JumpTable Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/NeighborTable.hpp>
+#include <bwsl/Span.hpp>
+
+// std
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Displacement and winding of the hops to the nearest neighbors, one row
+/// for each slot of a NeighborTable.
+///
+/// The displacement of the hop from a site to the neighbor in a slot is the
+/// vector of the Bravais lattice of the slot, in lattice coordinates. The
+/// winding is the number of times the hop crosses the closed boundaries
+/// along each direction of the grid, with the sign of the crossing. The
+/// winding of a path is the sum of the windings of its hops, which is what
+/// BasicLattice::GetWinding computes from the sum of the jumps, without
+/// building any coordinates.
+///
+class JumpTable
+{
+public:
+  /// Type for the site indices
+  using index_t = std::size_t;
+
+  /// Type of the components of the displacements and of the windings
+  using jump_t = std::int32_t;
+
+  /// View over the components of a row
+  using span_t = Span<jump_t const>;
+
+  /// Default constructor
+  JumpTable() = default;
+
+  /// Build the rows of the slots of @p table in dimension @p dim , where
+  /// `fill(a, slot, displacement, winding)` writes the components of the
+  /// row of slot `slot` of site a
+  template<class F>
+  JumpTable(NeighborTable const& table, std::size_t dim, F&& fill);
+
+  /// Copy constructor
+  JumpTable(JumpTable const& that) = default;
+
+  /// Move constructor
+  JumpTable(JumpTable&& that) = default;
+
+  /// Copy assignment operator
+  auto operator=(JumpTable const& that) -> JumpTable& = default;
+
+  /// Move assignment operator
+  auto operator=(JumpTable&& that) -> JumpTable& = default;
+
+  /// Default destructor
+  virtual ~JumpTable() = default;
+
+  /// Get the dimension
+  [[nodiscard]] auto GetDim() const -> std::size_t { return dim_; }
+
+  /// Get the number of sites
+  [[nodiscard]] auto GetNumSites() const -> std::size_t
+  {
+    return slotoffsets_.empty() ? 0UL : slotoffsets_.size() - 1UL;
+  }
+
+  /// Get the row of slot @p slot of site @p a
+  [[nodiscard]] auto GetRow(index_t a, index_t slot) const -> index_t
+  {
+    assert(a < GetNumSites());
+    assert(slotoffsets_[a] + slot < slotoffsets_[a + 1UL]);
+    return slotoffsets_[a] + slot;
+  }
+
+  /// Get the displacement of the hop from site @p a along slot @p slot
+  [[nodiscard]] auto GetDisplacement(index_t a, index_t slot) const -> span_t
+  {
+    return span_t(displacement_.data() + GetRow(a, slot) * dim_, dim_);
+  }
+
+  /// Get the winding of the hop from site @p a along slot @p slot
+  [[nodiscard]] auto GetWinding(index_t a, index_t slot) const -> span_t
+  {
+    return span_t(winding_.data() + GetRow(a, slot) * dim_, dim_);
+  }
+
+  /// Check if the hop from site @p a along slot @p slot crosses the
+  /// boundaries
+  [[nodiscard]] auto CrossesBoundary(index_t a, index_t slot) const -> bool
+  {
+    for (auto w : GetWinding(a, slot)) {
+      if (w != 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  /// Dimension
+  std::size_t dim_{ 0UL };
+
+  /// Row of the first slot of each site, and the end
+  std::vector<index_t> slotoffsets_{};
+
+  /// Displacements, one row for each slot
+  std::vector<jump_t> displacement_{};
+
+  /// Windings, one row for each slot
+  std::vector<jump_t> winding_{};
+}; // class JumpTable
+
+template<class F>
+inline JumpTable::JumpTable(NeighborTable const& table,
+                            std::size_t dim,
+                            F&& fill)
+  : dim_(dim)
+{
+  const auto n = table.GetNumSites();
+  slotoffsets_.assign(n + 1UL, 0UL);
+  for (auto a = 0UL; a < n; a++) {
+    slotoffsets_[a + 1UL] = slotoffsets_[a] + table.GetCoordination(a);
+  }
+  displacement_.assign(slotoffsets_.back() * dim_, jump_t{ 0 });
+  winding_.assign(slotoffsets_.back() * dim_, jump_t{ 0 });
+  for (auto a = 0UL; a < n; a++) {
+    for (auto slot = 0UL; slot < table.GetCoordination(a); slot++) {
+      const auto row = GetRow(a, slot);
+      fill(a,
+           slot,
+           displacement_.data() + row * dim_,
+           winding_.data() + row * dim_);
+    }
+  }
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -15,11 +15,30 @@
 #pragma once
 
 // bwsl
+#include <bwsl/AlignedAllocator.hpp>
 #include <bwsl/Approx.hpp>
+#include <bwsl/BondTable.hpp>
 #include <bwsl/Bravais.hpp>
+#include <bwsl/Buffer.hpp>
+#include <bwsl/DistanceShells.hpp>
+#include <bwsl/Exceptions.hpp>
+#include <bwsl/FFT.hpp>
+#include <bwsl/Hash.hpp>
 #include <bwsl/HyperCubicGrid.hpp>
+#include <bwsl/JumpTable.hpp>
+#include <bwsl/LatticeFile.hpp>
+#include <bwsl/LatticeSymmetry.hpp>
 #include <bwsl/MathUtils.hpp>
+#include <bwsl/MinimumImage.hpp>
+#include <bwsl/NeighborTable.hpp>
+#include <bwsl/Orbits.hpp>
 #include <bwsl/Pairs.hpp>
+#include <bwsl/PlaquetteTable.hpp>
+#include <bwsl/SharedSegment.hpp>
+#include <bwsl/SiteColoring.hpp>
+#include <bwsl/Span.hpp>
+#include <bwsl/ThreadPool.hpp>
+#include <bwsl/TranslationMap.hpp>
 
 // fmt
 #include <fmt/format.h>
@@ -27,58 +46,373 @@
 
 // std
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <set>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace bwsl {
 
+///
+/// Tables of a Lattice, which can be combined with `|` in a set of tables
+///
+enum class LatticeTable : unsigned
+{
+  None = 0U,
+  Positions = 1U << 0U,
+  Vectors = 1U << 1U,
+  Distances = 1U << 2U,
+  Neighbors = 1U << 3U,
+  Momenta = 1U << 4U,
+  All = (1U << 5U) - 1U,
+};
+
+/// Union of two sets of tables
+constexpr auto
+operator|(LatticeTable a, LatticeTable b) -> LatticeTable
+{
+  return static_cast<LatticeTable>(static_cast<unsigned>(a) |
+                                   static_cast<unsigned>(b));
+}
+
+/// Intersection of two sets of tables
+constexpr auto
+operator&(LatticeTable a, LatticeTable b) -> LatticeTable
+{
+  return static_cast<LatticeTable>(static_cast<unsigned>(a) &
+                                   static_cast<unsigned>(b));
+}
+
+/// Check if the set @p tables contains the table @p table
+constexpr auto
+has_table(LatticeTable tables, LatticeTable table) -> bool
+{
+  return (tables & table) == table;
+}
+
+///
+/// Options for the construction of a Lattice
+///
+struct LatticeOptions
+{
+  /// Tables computed by the constructor
+  LatticeTable tables{ LatticeTable::All };
+
+  /// Whether the tables not computed by the constructor are stored at their
+  /// first use. Otherwise each query computes its entry from the Bravais
+  /// lattice and the coordinates, using no memory at all. The neighbors are
+  /// stored in any case.
+  bool materialize{ true };
+
+  /// Storage of the translations used by GetMappedSite and GetUnMappedSite.
+  /// The tables are private to each lattice, they are neither saved in
+  /// lattice files nor shared among processes, hence they are built only on
+  /// request. TranslationMode::Auto picks the fastest one fitting in the
+  /// budget.
+  TranslationMode translations{ TranslationMode::None };
+
+  /// Memory budget in bytes for the translation tables
+  std::size_t translationbudget{ DefaultTranslationBudget };
+
+  /// Numbering of the sites. The Morton order keeps the neighbors close in
+  /// memory on large lattices, BasicHyperCubicGrid::ToRowMajor converts the
+  /// values of the sites for output.
+  GridOrdering ordering{ GridOrdering::RowMajor };
+
+  /// Number of threads used to build the tables, zero to use all the
+  /// hardware threads. The tables do not depend on the number of threads.
+  std::size_t numthreads{ 1UL };
+
+  /// Whether the checksum of a lattice file is verified when loading it.
+  /// Verifying reads the whole file, skipping it makes loading independent
+  /// of the size of the lattice.
+  bool verifychecksum{ true };
+
+  /// Seconds waited by LoadOrBuildShared for another process building the
+  /// shared tables, after which the lattice is built privately
+  double sharedtimeout{ 60.0 };
+};
+
 ///
 /// Representation of a Lattice.
 ///
-class Lattice : public HyperCubicGrid
+/// As for the BasicHyperCubicGrid the dimension @p D can be fixed at compile
+/// time, in which case coordinates and real space vectors are std::array.
+///
+template<std::size_t D>
+class BasicLattice : public BasicHyperCubicGrid<D>
 {
 public:
+  /// Type of the underlying grid
+  using grid_t = BasicHyperCubicGrid<D>;
+
+  /// Coordinates
+  using coords_t = typename grid_t::coords_t;
+
+  /// Sizes of the grid
+  using gridsize_t = typename grid_t::gridsize_t;
+
+  /// Type for the site indices
+  using index_t = typename grid_t::index_t;
+
+  /// Type of the boundaries
+  using boundaries_t = typename grid_t::boundaries_t;
+
   /// Vector of offsets
   using vectorindex_t = std::vector<index_t>;
 
-  /// Vector of neighbors
-  using neighbors_t = std::vector<vectorindex_t>;
+  /// Table of nearest neighbors
+  using neighbors_t = NeighborTable;
+
+  /// View over the neighbors of a site
+  using neighborspan_t = NeighborTable::span_t;
 
   /// Shorthand for real valued vectors
-  using realvec_t = std::vector<double>;
+  using realvec_t = std::conditional_t<D == DynamicDim,
+                                       std::vector<double>,
+                                       std::array<double, D>>;
+
+  /// Real values, one for each site or momentum of the lattice
+  using values_t = std::vector<double>;
+
+  /// Table of real space vectors stored as one plane for each component.
+  /// The component d of the vector of site i is the element
+  /// `d * GetPlaneStride() + i`.
+  using table_t = Buffer<double>;
+
+  /// Storage of the tables being built
+  using tabledata_t = aligned_vector<double>;
+
+  /// View over one component of a table, one element for each site
+  using plane_t = Span<double const>;
+
+  using grid_t::GetCoordinates;
+  using grid_t::GetDim;
+  using grid_t::GetIndex;
+  using grid_t::GetNumSites;
+  using grid_t::GetRowMajorIndex;
+  using grid_t::GetSize;
+  using grid_t::HasClosedBoundaries;
+  using grid_t::HasOpenBoundaries;
+  using grid_t::IndexIsValid;
+  using grid_t::IsOnGrid;
+  using grid_t::MakeCoords;
 
   /// Default constructor
-  Lattice() = default;
+  BasicLattice() = default;
 
   /// Construct a lattice with given size from an infinite bravais lattice
-  Lattice(Bravais const& bravais,
-          gridsize_t const& size,
-          boundaries_t boundaries = boundaries_t::Closed);
+  BasicLattice(Bravais const& bravais,
+               gridsize_t const& size,
+               boundaries_t boundaries = boundaries_t::Closed,
+               LatticeOptions const& options = LatticeOptions{});
 
   /// Copy constructor
-  Lattice(Lattice const& that) = default;
+  BasicLattice(BasicLattice const& that) = default;
 
   /// Move constructor
-  Lattice(Lattice&& that) = default;
+  BasicLattice(BasicLattice&& that) = default;
 
   /// Copy assignment operator
-  auto operator=(Lattice const& that) -> Lattice& = default;
+  auto operator=(BasicLattice const& that) -> BasicLattice& = default;
 
   /// Move assignment operator
-  auto operator=(Lattice&& that) -> Lattice& = default;
+  auto operator=(BasicLattice&& that) -> BasicLattice& = default;
 
   /// Default destructor
-  ~Lattice() override = default;
+  ~BasicLattice() override = default;
+
+  /// Value returned by GetNeighborSlot for sites which are not neighbors
+  static constexpr index_t NoSlot = NeighborTable::NoSlot;
+
+  /// Get the Bravais lattice
+  [[nodiscard]] auto GetBravais() const -> Bravais const& { return bravais_; }
+
+  /// Get the distance between the planes of the tables, a multiple of the
+  /// number of sites keeping all the planes aligned to DefaultAlignment
+  [[nodiscard]] auto GetPlaneStride() const -> std::size_t
+  {
+    constexpr auto n = DefaultAlignment / sizeof(double);
+    return (GetNumSites() + n - 1UL) / n * n;
+  }
+
+  /// Get the component @p d of the positions of all the sites, without
+  /// copying them. The table is stored if it is not already.
+  [[nodiscard]] auto GetPositions(std::size_t d) const -> plane_t
+  {
+    return GetPlane(Positions(), d);
+  }
+
+  /// Get the component @p d of the vectors from site 0 to all the sites,
+  /// the element i is `GetVector(0, i)[d]`. The table is stored if it is
+  /// not already.
+  [[nodiscard]] auto GetVectors(std::size_t d) const -> plane_t
+  {
+    return GetPlane(Vectors(), d);
+  }
+
+  /// Get the distances from site 0 to all the sites, the element i is
+  /// `GetDistance(0, i)`. The table is stored if it is not already.
+  [[nodiscard]] auto GetDistances() const -> plane_t
+  {
+    return Distances().GetSpan(0UL, GetNumSites());
+  }
+
+  /// Get the component @p d of all the momenta. The table is stored if it
+  /// is not already.
+  [[nodiscard]] auto GetMomenta(std::size_t d) const -> plane_t
+  {
+    assert(HasClosedBoundaries());
+    return GetPlane(Momenta(), d);
+  }
+
+  /// Check if the entries of @p table are stored, either because computed
+  /// by the constructor or because they are stored at their first use
+  [[nodiscard]] auto IsStored(LatticeTable table) const -> bool
+  {
+    return materialize_ || has_table(precomputed_, table);
+  }
 
   /// Get nearest neighbors of site i
-  [[nodiscard]] auto GetNeighbors(index_t i) const -> vectorindex_t const&
+  [[nodiscard]] auto GetNeighbors(index_t i) const -> neighborspan_t
+  {
+    return Neighbors().GetNeighbors(i);
+  }
+
+  /// Get the neighbor of site @p a in slot @p slot
+  [[nodiscard]] auto GetNeighbor(index_t a, index_t slot) const -> index_t
+  {
+    return Neighbors().GetNeighbor(a, slot);
+  }
+
+  /// Get the slot of site @p a holding the neighbor @p b , or NoSlot
+  [[nodiscard]] auto GetNeighborSlot(index_t a, index_t b) const -> index_t
+  {
+    return Neighbors().GetSlot(a, b);
+  }
+
+  /// Get the slot of `GetNeighbor(a, slot)` which points back to @p a
+  [[nodiscard]] auto GetOppositeSlot(index_t a, index_t slot) const -> index_t
+  {
+    return Neighbors().GetOppositeSlot(a, slot);
+  }
+
+  /// Get the direction of the bravais lattice of the slot @p slot of site @p a
+  [[nodiscard]] auto GetNeighborDirection(index_t a, index_t slot) const
+    -> index_t
+  {
+    return Neighbors().GetDirection(a, slot);
+  }
+
+  /// Get the table with the nearest neighbors of all the sites
+  [[nodiscard]] auto GetNeighborTable() const -> neighbors_t const&
   {
-    return neighbors_[i];
+    return Neighbors();
+  }
+
+  /// Get the site i mapping (a, b) to (0, i).
+  /// It uses the translation table when available.
+  [[nodiscard]] auto GetMappedSite(index_t a, index_t b) const -> index_t
+  {
+    return translations_.IsEnabled() ? translations_.GetMappedSite(a, b)
+                                     : grid_t::GetMappedSite(a, b);
+  }
+
+  /// Get the site i mapping (0, i) to (a, b).
+  /// It uses the translation table when available.
+  [[nodiscard]] auto GetUnMappedSite(index_t i, index_t a) const -> index_t
+  {
+    return translations_.IsEnabled() ? translations_.GetUnMappedSite(i, a)
+                                     : grid_t::GetUnMappedSite(i, a);
+  }
+
+  /// Get the classification of the sites in shells of equal distance from
+  /// site 0, only with closed boundaries. It is computed at the first use.
+  [[nodiscard]] auto GetDistanceShells() const -> DistanceShells const&;
+
+  /// Get the distance shell of site @p b seen from site @p a
+  [[nodiscard]] auto GetShell(index_t a, index_t b) const -> index_t
+  {
+    return GetDistanceShells().GetShell(GetMappedSite(a, b));
+  }
+
+  /// Get the neighbors of all the sites in the distance shell @p k , with
+  /// the same layout of GetNeighborTable(). The slots `2 m` and `2 m + 1`
+  /// hold opposite vectors, hence a site opposite to itself, at half the
+  /// size of the lattice, fills both slots of a pair and the coordination can
+  /// exceed the multiplicity of the shell. Each table is computed at its
+  /// first use.
+  [[nodiscard]] auto GetShellNeighborTable(std::size_t k) const
+    -> neighbors_t const&;
+
+  /// Get the point group of the lattice with closed boundaries. It is
+  /// computed at the first use, together with the orbits below.
+  [[nodiscard]] auto GetSymmetry() const -> LatticeSymmetry const&
+  {
+    return Symmetries().symmetry;
+  }
+
+  /// Get the orbits of the mapped sites under the point group, the pairs
+  /// (a, b) with equal `GetPairOrbit(a, b)` are equivalent
+  [[nodiscard]] auto GetSiteOrbits() const -> Orbits const&
+  {
+    return Symmetries().siteorbits;
+  }
+
+  /// Get the orbits of the momenta under the point group, for example to
+  /// store the structure factor once for each irreducible momentum
+  [[nodiscard]] auto GetMomentumOrbits() const -> Orbits const&
+  {
+    return Symmetries().momentumorbits;
+  }
+
+  /// Get the orbit of the pair of sites @p a and @p b , modulo translations
+  /// and the point group
+  [[nodiscard]] auto GetPairOrbit(index_t a, index_t b) const -> index_t
+  {
+    return GetSiteOrbits().GetOrbit(GetMappedSite(a, b));
+  }
+
+  /// Get a coloring of the sites where the neighbors have different colors,
+  /// for example to update the sites of each color in parallel with
+  /// SiteColoring::Sweep. It is computed at the first use.
+  [[nodiscard]] auto GetColoring() const -> SiteColoring const&;
+
+  /// Get the bonds between nearest neighbors, each one stored once, with
+  /// the bond of every slot of GetNeighborTable(). It is computed at the
+  /// first use.
+  [[nodiscard]] auto GetBondTable() const -> BondTable const&;
+
+  /// Get the elementary plaquettes, the triangles of directions whose
+  /// difference is also a direction and otherwise the squares spanned by
+  /// two directions. With open boundaries only the plaquettes inside the
+  /// grid are kept. It is computed at the first use.
+  [[nodiscard]] auto GetPlaquetteTable() const -> PlaquetteTable const&;
+
+  /// Get the displacement and the winding of the hop along every slot of
+  /// GetNeighborTable(), to follow the winding of a path with a
+  /// BasicWindingAccumulator. It is computed at the first use.
+  [[nodiscard]] auto GetJumpTable() const -> JumpTable const&;
+
+  /// Get the table of the translations
+  [[nodiscard]] auto GetTranslationMap() const -> TranslationMap const&
+  {
+    return translations_;
   }
 
   /// Distance betweeen two sites of the lattice
@@ -90,7 +424,7 @@ public:
   /// Given an accumulator for the winding number return the total winding.
   /// The total winding is defined as the number of times we jump around the
   /// boundaries.
-  [[nodiscard]] auto GetWinding(coords_t jump) const -> coords_t;
+  [[nodiscard]] auto GetWinding(coords_t const& jump) const -> coords_t;
 
   /// Get the real space coordinates of site @p a .
   [[nodiscard]] auto GetPosition(index_t a) const -> realvec_t;
@@ -108,18 +442,63 @@ public:
   [[nodiscard]] auto GetCoordination() const -> index_t;
 
   /// Get an allowed momentum
-  [[nodiscard]] auto GetMomentum(size_t a) const -> realvec_t;
+  [[nodiscard]] auto GetMomentum(index_t a) const -> realvec_t;
 
-  /// Compute the structure factor given the occupations of the sites
+  /// Compute the structure factor given the occupations of the sites.
+  /// With closed boundaries it uses a Fast Fourier Transform over the grid
+  /// and costs O(N log N).
   template<class T>
   auto AccumulateSk(std::vector<T> const& occupations,
-                    realvec_t& sk,
+                    values_t& sk,
                     double mult = 1.0) const -> void;
 
+  /// Compute the structure factor given the occupations of the sites summing
+  /// explicitly over all the momenta and all the sites, O(N^2).
+  template<class T>
+  auto AccumulateSkDirect(std::vector<T> const& occupations,
+                          values_t& sk,
+                          double mult = 1.0) const -> void;
+
+  /// Add the structure factor given the occupations of the sites to @p sk ,
+  /// averaged over the orbits of the momenta. @p sk has one element for
+  /// each orbit of GetMomentumOrbits().
+  template<class T>
+  auto AccumulateSkReduced(std::vector<T> const& occupations,
+                           values_t& sk,
+                           double mult = 1.0) const -> void;
+
   /// Compute the structure factor given the occupations of the sites
   template<class T>
   [[nodiscard]] auto ComputeSk(std::vector<T> const& occupations,
-                               double mult = 1.0) const -> realvec_t;
+                               double mult = 1.0) const -> values_t;
+
+  /// Add the density correlation `C(r) = (1/N) sum_a n_a n_b`, where
+  /// `r = GetMappedSite(a, b)`, to @p cr , which has one element for each
+  /// site r. It uses a Fast Fourier Transform over the grid and costs
+  /// O(N log N), only with closed boundaries.
+  template<class T>
+  auto AccumulateCorrelation(std::vector<T> const& occupations,
+                             values_t& cr,
+                             double mult = 1.0) const -> void;
+
+  /// Add the density correlation to @p cr summing explicitly over all the
+  /// pairs of sites, O(N^2).
+  template<class T>
+  auto AccumulateCorrelationDirect(std::vector<T> const& occupations,
+                                   values_t& cr,
+                                   double mult = 1.0) const -> void;
+
+  /// Add the density correlation to @p cr averaged over the distance
+  /// shells. @p cr has one element for each shell of GetDistanceShells().
+  template<class T>
+  auto AccumulateCorrelationReduced(std::vector<T> const& occupations,
+                                    values_t& cr,
+                                    double mult = 1.0) const -> void;
+
+  /// Compute the density correlation given the occupations of the sites
+  template<class T>
+  [[nodiscard]] auto ComputeCorrelation(std::vector<T> const& occupations,
+                                        double mult = 1.0) const -> values_t;
 
   /// Save the distances on a file
   auto SaveDistances(const std::string& fname) const -> void;
@@ -136,11 +515,350 @@ public:
   /// Save the distances on a file
   auto SaveTriples(const std::string& fname) const -> void;
 
+  /// Save all the tables of the lattice on the binary file @p fname .
+  /// Throw std::runtime_error if the file cannot be written.
+  auto Save(std::string const& fname) const -> void;
+
+  /// Load a lattice saved with Save from the file @p fname .
+  /// The file is mapped in memory and the tables are used in place, without
+  /// copying them. The parameters must be those of the saved lattice,
+  /// otherwise exception::BadLatticeFile is thrown, as it is for corrupted
+  /// files. The translation tables and the plan of the FFT are built again.
+  [[nodiscard]] static auto Load(std::string const& fname,
+                                 Bravais const& bravais,
+                                 gridsize_t const& size,
+                                 boundaries_t boundaries = boundaries_t::Closed,
+                                 LatticeOptions const& options =
+                                   LatticeOptions{}) -> BasicLattice;
+
+  /// Load the lattice from the cache directory @p cachedir , or build it and
+  /// store it in the cache if it is missing or cannot be used. The name of
+  /// the file is derived from the parameters. Failing to store the lattice
+  /// is not an error, the directory must already exist.
+  [[nodiscard]] static auto LoadOrBuild(std::string const& cachedir,
+                                        Bravais const& bravais,
+                                        gridsize_t const& size,
+                                        boundaries_t boundaries =
+                                          boundaries_t::Closed,
+                                        LatticeOptions const& options =
+                                          LatticeOptions{}) -> BasicLattice;
+
+  /// Get the name of the file in @p cachedir used by LoadOrBuild
+  [[nodiscard]] static auto GetCacheFileName(
+    std::string const& cachedir,
+    Bravais const& bravais,
+    gridsize_t const& size,
+    boundaries_t boundaries,
+    GridOrdering ordering = GridOrdering::RowMajor) -> std::string;
+
+  /// Attach to the tables of the lattice in a POSIX shared memory segment,
+  /// so that all the processes of a node using the same lattice share one
+  /// copy of them. The first process builds the tables into the segment,
+  /// the others wait for it to be published and use it read only.
+  /// A segment abandoned by a dead process, or written by an incompatible
+  /// version, is replaced. If the segment cannot be used within
+  /// `options.sharedtimeout` seconds, or shared memory is not available, the
+  /// lattice is built privately.
+  /// The segment outlives the processes, it can be removed with
+  /// `SharedSegment::Remove(GetSharedName(bravais, size, boundaries))`.
+  [[nodiscard]] static auto LoadOrBuildShared(Bravais const& bravais,
+                                              gridsize_t const& size,
+                                              boundaries_t boundaries =
+                                                boundaries_t::Closed,
+                                              LatticeOptions const& options =
+                                                LatticeOptions{})
+    -> BasicLattice;
+
+  /// Get the name of the shared memory segment used by LoadOrBuildShared
+  [[nodiscard]] static auto GetSharedName(
+    Bravais const& bravais,
+    gridsize_t const& size,
+    boundaries_t boundaries,
+    GridOrdering ordering = GridOrdering::RowMajor) -> std::string;
+
 protected:
+  using grid_t::HasSameDimension;
+  using grid_t::Wrap;
+
+  /// Construct the lattice building the tables with the threads of @p pool
+  BasicLattice(Bravais const& bravais,
+               gridsize_t const& size,
+               boundaries_t boundaries,
+               LatticeOptions const& options,
+               ThreadPool&& pool);
+
+  /// Construct the lattice with the tables of the lattice file @p file
+  BasicLattice(LatticeFile const& file,
+               Bravais const& bravais,
+               gridsize_t const& size,
+               boundaries_t boundaries,
+               LatticeOptions const& options);
+
+  /// Check that the lattice file @p file , named @p name , holds the lattice
+  /// with the given parameters and construct it.
+  /// Throw exception::BadLatticeFile otherwise.
+  [[nodiscard]] static auto FromLatticeFile(LatticeFile const& file,
+                                            std::string const& name,
+                                            Bravais const& bravais,
+                                            gridsize_t const& size,
+                                            boundaries_t boundaries,
+                                            LatticeOptions const& options)
+    -> BasicLattice;
+
+  /// Hash of the parameters of a lattice
+  [[nodiscard]] static auto GetKey(Bravais const& bravais,
+                                   gridsize_t const& size,
+                                   boundaries_t boundaries,
+                                   GridOrdering ordering) -> std::uint64_t;
+
+  /// Get the lattice file with all the tables, to be written
+  [[nodiscard]] auto MakeLatticeFile() const -> LatticeFile;
+
+  /// Write the image of the lattice file in a new shared segment
+  auto Share(SharedSegment& segment) const -> void;
+
+  /// Get the vector of site @p i from the table @p table
+  [[nodiscard]] auto GetRow(table_t const& table, index_t i) const
+    -> realvec_t
+  {
+    auto v = MakeRealVec();
+    const auto stride = GetPlaneStride();
+    for (auto d = 0UL; d < GetDim(); d++) {
+      v[d] = table[d * stride + i];
+    }
+    return v;
+  }
+
+  /// Get the plane @p d of the table @p table
+  [[nodiscard]] auto GetPlane(table_t const& table, std::size_t d) const
+    -> plane_t
+  {
+    assert(d < GetDim());
+    return table.GetSpan(d * GetPlaneStride(), GetNumSites());
+  }
+
+  /// Get a real space vector with all the components equal to @p value
+  [[nodiscard]] auto MakeRealVec(double value = 0.0) const -> realvec_t
+  {
+    return make_filled<realvec_t>(GetDim(), value);
+  }
+
+  /// Tables derived from the others, always computed at their first use
+  enum class DerivedTable : std::size_t
+  {
+    Shells,
+    Symmetries,
+    Coloring,
+    Bonds,
+    Plaquettes,
+    Jumps,
+  };
+
+  /// Number of tables in LatticeTable
+  static constexpr std::size_t NumLatticeTables = 5UL;
+
+  /// Number of tables stored at their first use
+  static constexpr std::size_t NumLazyTables = NumLatticeTables + 6UL;
+
+  /// Point group with the orbits of the sites and of the momenta
+  struct SymmetryTables
+  {
+    /// Point group
+    LatticeSymmetry symmetry{};
+
+    /// Orbits of the mapped sites
+    Orbits siteorbits{};
+
+    /// Orbits of the momenta
+    Orbits momentumorbits{};
+  };
+
+  /// Tables stored at their first use, shared by the copies of the lattice
+  struct LazyTables
+  {
+    /// Flags of the tables already stored, indexed by GetTableIndex
+    std::array<std::once_flag, NumLazyTables> once{};
+
+    /// Same as the members of the lattice
+    table_t position{};
+    table_t vectors{};
+    Buffer<double> distance{};
+    neighbors_t neighbors{};
+    table_t momenta{};
+
+    /// Distance shells
+    DistanceShells shells{};
+
+    /// Lock on the neighbors of the shells
+    std::mutex shellmutex{};
+
+    /// Neighbors of the shells already computed
+    std::map<std::size_t, neighbors_t> shelltables{};
+
+    /// Point group and orbits
+    SymmetryTables symmetries{};
+
+    /// Coloring of the sites
+    SiteColoring coloring{};
+
+    /// Bonds of the nearest neighbors
+    BondTable bonds{};
+
+    /// Elementary plaquettes
+    PlaquetteTable plaquettes{};
+
+    /// Displacements and windings of the neighbor slots
+    JumpTable jumps{};
+  };
+
+  /// Get the point group and the orbits, finding them the first time
+  [[nodiscard]] auto Symmetries() const -> SymmetryTables const&;
+
+  /// Index of a single table
+  [[nodiscard]] static constexpr auto GetTableIndex(LatticeTable table)
+    -> std::size_t
+  {
+    auto index = 0UL;
+    for (auto bits = static_cast<unsigned>(table); bits > 1U; bits >>= 1U) {
+      index++;
+    }
+    return index;
+  }
+
+  /// Index of a derived table
+  [[nodiscard]] static constexpr auto GetTableIndex(DerivedTable table)
+    -> std::size_t
+  {
+    return NumLatticeTables + static_cast<std::size_t>(table);
+  }
+
+  /// Get the table stored in @p member of the lazy tables, with flag
+  /// @p index , calling @p compute the first time
+  template<class T, class F>
+  [[nodiscard]] auto GetLazyTable(std::size_t index,
+                                  T LazyTables::*member,
+                                  F&& compute) const -> T const&
+  {
+    auto& lazy = *lazy_;
+    std::call_once(lazy.once[index], [&]() { lazy.*member = T(compute()); });
+    return lazy.*member;
+  }
+
+  /// Get the table @p table , which is @p precomputed if it was computed by
+  /// the constructor, otherwise it is stored in @p member of the lazy tables
+  /// calling @p compute with a thread pool the first time. This happens also
+  /// for tables which are not materialized, for example when saving them.
+  template<class T, class F>
+  [[nodiscard]] auto GetTable(LatticeTable table,
+                              T const& precomputed,
+                              T LazyTables::*member,
+                              F&& compute) const -> T const&
+  {
+    if (has_table(precomputed_, table)) {
+      return precomputed;
+    }
+    return GetLazyTable(GetTableIndex(table), member, [&]() {
+      auto pool = ThreadPool(numthreads_);
+      return compute(pool);
+    });
+  }
+
+  /// Get the table of the positions
+  [[nodiscard]] auto Positions() const -> table_t const&
+  {
+    return GetTable(LatticeTable::Positions,
+                    position_,
+                    &LazyTables::position,
+                    [this](ThreadPool& pool) {
+                      return ComputePositions(pool);
+                    });
+  }
+
+  /// Get the table of the vectors
+  [[nodiscard]] auto Vectors() const -> table_t const&
+  {
+    return GetTable(LatticeTable::Vectors,
+                    vectors_,
+                    &LazyTables::vectors,
+                    [this](ThreadPool& pool) { return ComputeVectors(pool); });
+  }
+
+  /// Get the table of the distances
+  [[nodiscard]] auto Distances() const -> Buffer<double> const&
+  {
+    return GetTable(LatticeTable::Distances,
+                    distance_,
+                    &LazyTables::distance,
+                    [this](ThreadPool& pool) {
+                      return ComputeDistances(pool);
+                    });
+  }
+
+  /// Get the table of the neighbors
+  [[nodiscard]] auto Neighbors() const -> neighbors_t const&
+  {
+    return GetTable(LatticeTable::Neighbors,
+                    neighbors_,
+                    &LazyTables::neighbors,
+                    [this](ThreadPool& pool) {
+                      return ComputeNeighbors(pool);
+                    });
+  }
+
+  /// Get the table of the momenta
+  [[nodiscard]] auto Momenta() const -> table_t const&
+  {
+    return GetTable(LatticeTable::Momenta,
+                    momenta_,
+                    &LazyTables::momenta,
+                    [this](ThreadPool& pool) { return ComputeMomenta(pool); });
+  }
+
+  /// Compute the real space position of site @p i
+  [[nodiscard]] auto ComputePosition(index_t i) const -> realvec_t;
+
+  /// Classify the sites in distance shells, with exact squared norms if the
+  /// metric of the Bravais lattice allows it
+  [[nodiscard]] auto ComputeDistanceShells(ThreadPool& pool) const
+    -> DistanceShells;
+
+  /// Find the point group and the orbits of the sites and of the momenta
+  [[nodiscard]] auto ComputeSymmetries(ThreadPool& pool) const
+    -> SymmetryTables;
+
+  /// Color the sites, with the periodic coloring using the fewest colors
+  /// unless SiteColoring::FromNeighbors finds one using less
+  [[nodiscard]] auto ComputeColoring(ThreadPool& pool) const -> SiteColoring;
+
+  /// Enumerate the bonds of the nearest neighbors
+  [[nodiscard]] auto ComputeBonds() const -> BondTable;
+
+  /// Enumerate the elementary plaquettes
+  [[nodiscard]] auto ComputePlaquettes() const -> PlaquetteTable;
+
+  /// Compute the displacements and the windings of the neighbor slots
+  [[nodiscard]] auto ComputeJumps() const -> JumpTable;
+
+  /// Compute the neighbors of all the sites in the distance shell @p k
+  [[nodiscard]] auto ComputeShellNeighbors(std::size_t k,
+                                           ThreadPool& pool) const
+    -> neighbors_t;
+
+  /// Compute the vector from site 0 to site @p i , with the minimum image
+  /// convention for closed boundaries
+  [[nodiscard]] auto ComputeVector(index_t i) const -> realvec_t;
+
+  /// Compute the momentum @p i
+  [[nodiscard]] auto ComputeMomentum(index_t i) const -> realvec_t;
+
+  /// Compute a table with the vectors `f(i)` for all the sites
+  template<class F>
+  [[nodiscard]] auto ComputeRows(ThreadPool& pool, F&& f) const
+    -> tabledata_t;
+
   /// Compute the positions of all the lattice points
   /// NOTE: the positions stored are in real space.
-  [[nodiscard]] auto ComputePositions(Bravais const& bravais) const
-    -> std::vector<realvec_t>;
+  [[nodiscard]] auto ComputePositions(ThreadPool& pool) const -> tabledata_t;
 
   /// Compute the distance vectors.
   /// It is composed of vectors in real space between site 0 and site i.
@@ -149,248 +867,861 @@ protected:
   /// that it represents the shortest distance between the first site and all
   /// the periodic images of the second one (or vice versa).
   /// [minimum distance convention]
-  [[nodiscard]] auto ComputeVectors(Bravais const& bravais) const
-    -> std::vector<realvec_t>;
+  /// The shortest image is found with MinimumImage, for any dimension and
+  /// any shape of the cell. Among images with the same length the one inside
+  /// the grid is preferred.
+  [[nodiscard]] auto ComputeVectors(ThreadPool& pool) const -> tabledata_t;
 
   /// Compute the vector of distances respecting the minimum
   /// distance convention (if with closed boundaries).
   /// It is composed of magnitudes of distance vectors computed using
   /// ComputeVectors() above.
-  [[nodiscard]] auto ComputeDistances(Bravais const& /*bravais*/) const
-    -> realvec_t;
+  [[nodiscard]] auto ComputeDistances(ThreadPool& pool) const -> tabledata_t;
 
-  /// Create the vector storing vector of neighbors for each lattice site.
-  /// The vector of neighbors store the site indices of neighbors.
+  /// Create the table storing the neighbors of each lattice site.
+  /// The table stores the site indices of neighbors and the direction of the
+  /// bravais lattice of each of them.
   /// It also takes into account the boundary conditions.
-  [[nodiscard]] auto ComputeNeighbors(Bravais const& bravais) const
-    -> neighbors_t;
+  [[nodiscard]] auto ComputeNeighbors(ThreadPool& pool) const -> neighbors_t;
 
   /// Compute the allowed momenta
-  [[nodiscard]] auto ComputeMomenta(Bravais const& bravais) const
-    -> std::vector<realvec_t>;
+  [[nodiscard]] auto ComputeMomenta(ThreadPool& pool) const -> tabledata_t;
+
+  /// Compute the primitive vectors of the reciprocal lattice, one row each
+  [[nodiscard]] auto ComputeReciprocal() const -> values_t;
+
+  /// Compute for each momentum the index of the corresponding component in
+  /// the output of the FFT over the grid.
+  [[nodiscard]] auto ComputeMomentaFFT() const -> vectorindex_t;
 
 private:
+  /// Precomputed translations
+  TranslationMap translations_{};
+
+  /// Bravais lattice
+  Bravais bravais_{};
+
+  /// Search of the minimum images
+  MinimumImage images_{};
+
+  /// Primitive vectors of the reciprocal lattice, one row each
+  values_t reciprocal_{};
+
+  /// Tables computed by the constructor
+  LatticeTable precomputed_{ LatticeTable::All };
+
+  /// Whether the other tables are stored at their first use
+  bool materialize_{ true };
+
+  /// Number of threads used to build the tables
+  std::size_t numthreads_{ 1UL };
+
+  /// Tables stored at their first use
+  std::shared_ptr<LazyTables> lazy_{};
+
   /// Positions of all the sites
   /// Assuming that the first site has position `(0,0)`
-  std::vector<realvec_t> position_{};
+  table_t position_{};
 
   /// All the distance vectors between pairs of sites
-  std::vector<realvec_t> vectors_{};
+  table_t vectors_{};
 
   /// All the distances on the lattice with minimum image convention
-  realvec_t distance_{};
+  Buffer<double> distance_{};
 
-  /// vector of nearest neighbors
+  /// table of nearest neighbors
   neighbors_t neighbors_{};
 
   /// Allowed values momenta
-  std::vector<realvec_t> momenta_{};
-}; // class Lattice
+  table_t momenta_{};
+
+  /// Plan for the FFT over the grid
+  FFT fft_{};
+
+  /// Index in the output of the FFT for each momentum
+  Buffer<index_t> momentafft_{};
+}; // class BasicLattice
+
+/// Lattice with the dimension known at run time
+using Lattice = BasicLattice<DynamicDim>;
+
+/// Lattices with the dimension fixed at compile time
+using Lattice1D = BasicLattice<1UL>;
+using Lattice2D = BasicLattice<2UL>;
+using Lattice3D = BasicLattice<3UL>;
+
+template<std::size_t D>
+inline BasicLattice<D>::BasicLattice(Bravais const& bravais,
+                                     gridsize_t const& size,
+                                     boundaries_t boundaries,
+                                     LatticeOptions const& options)
+  : BasicLattice(bravais,
+                 size,
+                 boundaries,
+                 options,
+                 ThreadPool(options.numthreads))
+{
+}
 
-inline Lattice::Lattice(Bravais const& bravais,
-                        gridsize_t const& size,
-                        boundaries_t boundaries)
-  : HyperCubicGrid(size, boundaries)
-  , position_(ComputePositions(bravais))
-  , vectors_(ComputeVectors(bravais))
-  , distance_(ComputeDistances(bravais))
-  , neighbors_(ComputeNeighbors(bravais))
-  , momenta_(ComputeMomenta(bravais))
+template<std::size_t D>
+inline BasicLattice<D>::BasicLattice(Bravais const& bravais,
+                                     gridsize_t const& size,
+                                     boundaries_t boundaries,
+                                     LatticeOptions const& options,
+                                     ThreadPool&& pool)
+  : grid_t(size, boundaries, options.ordering)
+  , translations_(*this, options.translations, options.translationbudget)
+  , bravais_(bravais)
+  , images_(HasClosedBoundaries() ? MinimumImage(bravais, GetSize())
+                                  : MinimumImage())
+  , reciprocal_(ComputeReciprocal())
+  , precomputed_(options.tables)
+  , materialize_(options.materialize)
+  , numthreads_(options.numthreads)
+  , lazy_(std::make_shared<LazyTables>())
 {
+  assert(bravais.GetDim() == GetDim());
+
+  // the tables are computed in the order of their dependencies
+  auto precompute = [this](LatticeTable table) {
+    return has_table(precomputed_, table);
+  };
+  if (precompute(LatticeTable::Positions)) {
+    position_ = table_t(ComputePositions(pool));
+  }
+  if (precompute(LatticeTable::Vectors)) {
+    vectors_ = table_t(ComputeVectors(pool));
+  }
+  if (precompute(LatticeTable::Distances)) {
+    distance_ = Buffer<double>(ComputeDistances(pool));
+  }
+  if (precompute(LatticeTable::Neighbors)) {
+    neighbors_ = ComputeNeighbors(pool);
+  }
+  if (precompute(LatticeTable::Momenta)) {
+    momenta_ = table_t(ComputeMomenta(pool));
+  }
+  if (HasClosedBoundaries()) {
+    fft_ = FFT({ size.begin(), size.end() });
+    momentafft_ = Buffer<index_t>(ComputeMomentaFFT());
+  }
 }
 
+template<std::size_t D>
+inline BasicLattice<D>::BasicLattice(LatticeFile const& file,
+                                     Bravais const& bravais,
+                                     gridsize_t const& size,
+                                     boundaries_t boundaries,
+                                     LatticeOptions const& options)
+  : grid_t(size, boundaries, options.ordering)
+  , translations_(*this, options.translations, options.translationbudget)
+  , bravais_(bravais)
+  , images_(HasClosedBoundaries() ? MinimumImage(bravais, GetSize())
+                                  : MinimumImage())
+  , reciprocal_(ComputeReciprocal())
+  , numthreads_(options.numthreads)
+  , lazy_(std::make_shared<LazyTables>())
+  , position_(file.GetSection<double>(LatticeSection::Positions))
+  , vectors_(file.GetSection<double>(LatticeSection::Vectors))
+  , distance_(file.GetSection<double>(LatticeSection::Distances))
+  , neighbors_(GetNumSites(),
+               file.GetHeader().neighborstride,
+               file.GetSection<index_t>(LatticeSection::NeighborOffsets),
+               file.GetSection<index_t>(LatticeSection::NeighborIndices),
+               file.GetSection<NeighborTable::slot_t>(
+                 LatticeSection::NeighborDirections),
+               file.GetSection<NeighborTable::slot_t>(
+                 LatticeSection::NeighborOpposite))
+  , momenta_(file.GetSection<double>(LatticeSection::Momenta))
+  , fft_(HasClosedBoundaries() ? FFT({ size.begin(), size.end() }) : FFT())
+  , momentafft_(file.GetSection<index_t>(LatticeSection::MomentaFFT))
+{
+}
+
+template<std::size_t D>
 inline void
-Lattice::EnforceBoundaries(coords_t& coords) const
+BasicLattice<D>::EnforceBoundaries(coords_t& coords) const
 {
-  for (auto i = 0UL; i < GetDim(); i++) {
-    auto s = GetSize()[i];
-    while (coords[i] < 0) {
-      coords[i] += s;
-    }
-    while (coords[i] >= static_cast<long>(s)) {
-      coords[i] -= s;
-    }
-  }
+  Wrap(coords);
 }
 
+template<std::size_t D>
 inline auto
-Lattice::GetDistance(size_t a, size_t b) const -> double
+BasicLattice<D>::GetDistance(index_t a, index_t b) const -> double
 {
   assert(IndexIsValid(a) && IndexIsValid(b));
   auto s = GetMappedSite(a, b);
-  return distance_[s];
+  if (IsStored(LatticeTable::Distances)) {
+    return Distances()[s];
+  }
+  return std::sqrt(sum_squared<realvec_t, double>(GetVector(0UL, s)));
 }
 
+template<std::size_t D>
 inline auto
-Lattice::GetVector(size_t a, size_t b) const -> realvec_t
+BasicLattice<D>::GetVector(index_t a, index_t b) const -> realvec_t
 {
   assert(IndexIsValid(a) && IndexIsValid(b));
   auto s = GetMappedSite(a, b);
-  return vectors_[s];
+  return IsStored(LatticeTable::Vectors) ? GetRow(Vectors(), s)
+                                         : ComputeVector(s);
 }
 
+template<std::size_t D>
 inline auto
-Lattice::GetMomentum(size_t a) const -> realvec_t
+BasicLattice<D>::GetMomentum(index_t a) const -> realvec_t
 {
   assert(IndexIsValid(a));
-  return momenta_[a];
+  return IsStored(LatticeTable::Momenta) ? GetRow(Momenta(), a)
+                                         : ComputeMomentum(a);
 }
 
+template<std::size_t D>
 inline auto
-Lattice::GetWinding(coords_t jumps) const -> coords_t
+BasicLattice<D>::GetWinding(coords_t const& jumps) const -> coords_t
 {
   assert(HasSameDimension(jumps));
 
+  auto winding = jumps;
   std::transform(jumps.begin(),
                  jumps.end(),
                  GetSize().cbegin(),
-                 jumps.begin(),
+                 winding.begin(),
                  std::divides<typename coords_t::value_type>());
 
-  return jumps;
+  return winding;
 }
 
+template<std::size_t D>
 inline auto
-Lattice::GetPosition(index_t a) const -> Lattice::realvec_t
+BasicLattice<D>::GetPosition(index_t a) const -> realvec_t
 {
   assert(IndexIsValid(a));
-  return position_[a];
+  return IsStored(LatticeTable::Positions) ? GetRow(Positions(), a)
+                                           : ComputePosition(a);
 }
 
+template<std::size_t D>
 inline auto
-Lattice::AreNeighbors(index_t a, index_t b) const -> bool
+BasicLattice<D>::AreNeighbors(index_t a, index_t b) const -> bool
 {
-  assert(a < neighbors_.size());
+  assert(IndexIsValid(a));
+  return Neighbors().GetSlot(a, b) != NoSlot;
+}
 
-  auto result = std::find(neighbors_[a].begin(), neighbors_[a].end(), b);
+template<std::size_t D>
+inline auto
+BasicLattice<D>::ComputePosition(index_t i) const -> realvec_t
+{
+  return bravais_.GetVector(GetCoordinates(0UL), GetCoordinates(i));
+}
 
-  return result != neighbors_[a].end();
+template<std::size_t D>
+inline auto
+BasicLattice<D>::ComputeVector(index_t i) const -> realvec_t
+{
+  // with closed boundary conditions search the shortest periodic image
+  auto ci = GetCoordinates(i);
+  if (HasClosedBoundaries()) {
+    images_.Reduce(ci);
+  }
+  return bravais_.GetDistanceVector(GetCoordinates(0UL), ci).second;
 }
 
+template<std::size_t D>
 inline auto
-Lattice::ComputePositions(Bravais const& bravais) const
-  -> std::vector<Lattice::realvec_t>
+BasicLattice<D>::GetDistanceShells() const -> DistanceShells const&
 {
-  auto p = std::vector<realvec_t>{};
-  auto c0 = GetCoordinates(0);
-  for (auto i = 0UL; i < GetNumSites(); i++) {
-    auto x = bravais.GetVector(c0, GetCoordinates(i));
-    p.push_back(x);
+  assert(HasClosedBoundaries());
+  return GetLazyTable(
+    GetTableIndex(DerivedTable::Shells), &LazyTables::shells, [this]() {
+      auto pool = ThreadPool(numthreads_);
+      return ComputeDistanceShells(pool);
+    });
+}
+
+template<std::size_t D>
+inline auto
+BasicLattice<D>::GetShellNeighborTable(std::size_t k) const
+  -> neighbors_t const&
+{
+  assert(k > 0UL && k < GetDistanceShells().GetNumShells());
+  auto& lazy = *lazy_;
+  auto lock = std::lock_guard<std::mutex>(lazy.shellmutex);
+  auto found = lazy.shelltables.find(k);
+  if (found == lazy.shelltables.end()) {
+    auto pool = ThreadPool(numthreads_);
+    found = lazy.shelltables.emplace(k, ComputeShellNeighbors(k, pool)).first;
   }
+  return found->second;
+}
 
-  return p;
+template<std::size_t D>
+inline auto
+BasicLattice<D>::GetColoring() const -> SiteColoring const&
+{
+  return GetLazyTable(
+    GetTableIndex(DerivedTable::Coloring), &LazyTables::coloring, [this]() {
+      auto pool = ThreadPool(numthreads_);
+      return ComputeColoring(pool);
+    });
 }
 
+template<std::size_t D>
 inline auto
-Lattice::ComputeDistances(Bravais const& /*bravais*/) const
-  -> Lattice::realvec_t
+BasicLattice<D>::GetBondTable() const -> BondTable const&
 {
-  auto p = realvec_t{};
-  std::transform(vectors_.begin(),
-                 vectors_.end(),
-                 std::back_inserter(p),
-                 [](realvec_t const& x) -> double {
-                   return sqrt(sum_squared<realvec_t, double>(x));
-                 });
-  return p;
+  return GetLazyTable(GetTableIndex(DerivedTable::Bonds),
+                      &LazyTables::bonds,
+                      [this]() { return ComputeBonds(); });
 }
 
+template<std::size_t D>
 inline auto
-Lattice::ComputeVectors(Bravais const& bravais) const
-  -> std::vector<Lattice::realvec_t>
+BasicLattice<D>::GetPlaquetteTable() const -> PlaquetteTable const&
 {
-  auto p = std::vector<realvec_t>(GetNumSites(), realvec_t(GetDim(), 0.0));
-  const auto imgsize = gridsize_t(GetDim(), 3);
-  const auto nimg = accumulate_product(imgsize);
+  return GetLazyTable(GetTableIndex(DerivedTable::Plaquettes),
+                      &LazyTables::plaquettes,
+                      [this]() { return ComputePlaquettes(); });
+}
 
-  const auto c0 = GetCoordinates(0UL);
-  for (auto site = 0UL; site < GetNumSites(); site++) {
-    auto cs = GetCoordinates(site);
+template<std::size_t D>
+inline auto
+BasicLattice<D>::GetJumpTable() const -> JumpTable const&
+{
+  return GetLazyTable(GetTableIndex(DerivedTable::Jumps),
+                      &LazyTables::jumps,
+                      [this]() { return ComputeJumps(); });
+}
 
-    // minimum distance found
-    auto [mindist, minvec] = bravais.GetDistanceVector(c0, cs);
+template<std::size_t D>
+inline auto
+BasicLattice<D>::ComputeBonds() const -> BondTable
+{
+  auto const& table = Neighbors();
+  return BondTable(table, [&](index_t a, index_t slot) {
+    const auto c =
+      bravais_.GetNeighbor(GetCoordinates(a), table.GetDirection(a, slot));
+    auto mask = 0U;
+    for (auto d = 0UL; d < GetDim() && HasClosedBoundaries(); d++) {
+      if (c[d] < 0L || c[d] >= static_cast<long>(GetSize()[d])) {
+        mask |= 1U << d;
+      }
+    }
+    return mask;
+  });
+}
+
+template<std::size_t D>
+inline auto
+BasicLattice<D>::ComputeJumps() const -> JumpTable
+{
+  using jump_t = JumpTable::jump_t;
+  auto const& table = Neighbors();
+  const auto vectors = bravais_.GetNeighborVectors();
+  return JumpTable(
+    table,
+    GetDim(),
+    [&](index_t a, index_t slot, jump_t* displacement, jump_t* winding) {
+      const auto direction = table.GetDirection(a, slot);
+      auto const& v = vectors[direction];
+      const auto c = bravais_.GetNeighbor(GetCoordinates(a), direction);
+      for (auto d = 0UL; d < GetDim(); d++) {
+        const auto size = static_cast<long>(GetSize()[d]);
+        displacement[d] = static_cast<jump_t>(v[d]);
+        // floor of the division, the neighbor can be far from the grid
+        const auto w = c[d] >= 0L ? c[d] / size : -((size - 1L - c[d]) / size);
+        winding[d] = HasClosedBoundaries() ? static_cast<jump_t>(w) : 0;
+      }
+    });
+}
 
-    // search for the minimum distance across the first shell of
-    // periodic images if we are with closed boundary condition
-    if (HasClosedBoundaries()) {
-      for (auto k = 0UL; k < nimg; k++) {
-        auto img = index_to_array<coords_t, gridsize_t>(k, imgsize);
-        auto csm = coords_t(cs);
-        for (auto m = 0UL; m < GetDim(); m++) {
-          csm[m] += (img[m] - 1) * GetSize()[m];
+template<std::size_t D>
+inline auto
+BasicLattice<D>::ComputePlaquettes() const -> PlaquetteTable
+{
+  using point_t = Bravais::coords_t;
+  const auto dim = GetDim();
+  const auto gamma = bravais_.GetGamma();
+  const auto steps = bravais_.GetNeighborVectors();
+  auto find = [&](point_t const& v) {
+    return static_cast<std::size_t>(
+      std::find(steps.begin(), steps.end(), v) - steps.begin());
+  };
+  auto combine = [&](point_t u, point_t const& v, long sign) {
+    for (auto d = 0UL; d < dim; d++) {
+      u[d] += sign * v[d];
+    }
+    return u;
+  };
+
+  // the shapes are loops of directions starting from their lexicographically
+  // smallest corner, a loop and its reverse are the same shape
+  auto shapes = std::vector<std::vector<std::size_t>>{};
+  auto keys = std::set<std::vector<point_t>>{};
+  auto consider = [&](std::vector<point_t> loop) {
+    std::rotate(loop.begin(),
+                std::min_element(loop.begin(), loop.end()),
+                loop.end());
+    const auto base = loop.front();
+    for (auto& c : loop) {
+      c = combine(c, base, -1L);
+    }
+    auto key = loop;
+    std::sort(key.begin(), key.end());
+    if (!keys.insert(key).second) {
+      return;
+    }
+    auto shape = std::vector<std::size_t>{};
+    for (auto m = 0UL; m < loop.size(); m++) {
+      shape.push_back(
+        find(combine(loop[(m + 1UL) % loop.size()], loop[m], -1L)));
+    }
+    shapes.push_back(shape);
+  };
+  const auto origin = point_t(dim, 0L);
+  for (auto x = 0UL; x < gamma; x++) {
+    for (auto y = 0UL; y < gamma; y++) {
+      if (x / 2UL == y / 2UL) {
+        continue;
+      }
+      if (find(combine(steps[y], steps[x], -1L)) < gamma) {
+        consider({ origin, steps[x], steps[y] });
+      } else if (find(combine(steps[y], steps[x], 1L)) == gamma) {
+        consider({ origin,
+                   steps[x],
+                   combine(steps[x], steps[y], 1L),
+                   steps[y] });
+      }
+    }
+  }
+
+  // one plaquette of each shape is anchored to every site
+  auto const& table = Neighbors();
+  auto const& bonds = GetBondTable();
+  auto offsets = vectorindex_t(1UL, 0UL);
+  auto corners = vectorindex_t{};
+  auto edges = vectorindex_t{};
+  for (auto a = 0UL; a < GetNumSites(); a++) {
+    for (auto const& shape : shapes) {
+      auto c = GetCoordinates(a);
+      auto inside = true;
+      for (auto m = 0UL; m < shape.size() && inside; m++) {
+        const auto corner = GetIndex(c);
+        c = bravais_.GetNeighbor(c, shape[m]);
+        inside = HasClosedBoundaries() || IsOnGrid(c);
+        if (inside) {
+          EnforceBoundaries(c);
+          auto slot = 0UL;
+          while (table.GetDirection(corner, slot) != shape[m]) {
+            slot++;
+          }
+          corners.push_back(corner);
+          edges.push_back(bonds.GetBond(corner, slot));
         }
-        auto [dist, vec] = bravais.GetDistanceVector(c0, csm);
+      }
+      if (inside) {
+        offsets.push_back(corners.size());
+      } else {
+        corners.resize(offsets.back());
+        edges.resize(offsets.back());
+      }
+    }
+  }
+  return PlaquetteTable(GetNumSites(),
+                        std::move(offsets),
+                        std::move(corners),
+                        std::move(edges));
+}
 
-        if (dist < mindist) {
-          mindist = dist;
-          minvec = vec;
+template<std::size_t D>
+inline auto
+BasicLattice<D>::ComputeColoring(ThreadPool& pool) const -> SiteColoring
+{
+  // the periodic colorings `c(x) = w . x mod k` are proper when no
+  // direction of the neighbors has `w . v = 0 mod k` and, with closed
+  // boundaries, when the sizes keep the color, `L_d w_d = 0 mod k`. They
+  // give the checkerboard of the hypercubic lattices and the three
+  // sublattices of the triangular one.
+  const auto dim = GetDim();
+  const auto vectors = bravais_.GetNeighborVectors();
+  auto directions = std::vector<Bravais::coords_t>{};
+  for (auto idx = 0UL; idx < vectors.size(); idx += 2UL) {
+    directions.push_back(vectors[idx]);
+  }
+  auto modulo = [](long x, long k) { return ((x % k) + k) % k; };
+  auto valid = [&](std::vector<long> const& w, long k) {
+    for (auto d = 0UL; d < dim && HasClosedBoundaries(); d++) {
+      if (modulo(static_cast<long>(GetSize()[d]) * w[d], k) != 0L) {
+        return false;
+      }
+    }
+    for (auto const& v : directions) {
+      auto x = 0L;
+      for (auto d = 0UL; d < dim; d++) {
+        x += v[d] * w[d];
+      }
+      if (modulo(x, k) == 0L) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  const auto maxcolors = static_cast<long>(bravais_.GetGamma()) + 1L;
+  for (auto k = 2L; k <= maxcolors; k++) {
+    auto w = std::vector<long>(dim, 0L);
+    for (;;) {
+      if (valid(w, k)) {
+        auto colors = std::vector<SiteColoring::color_t>(GetNumSites());
+        pool.ParallelFor(0UL, GetNumSites(), [&](index_t i) {
+          const auto c = GetCoordinates(i);
+          auto x = 0L;
+          for (auto d = 0UL; d < dim; d++) {
+            x += static_cast<long>(c[d]) * w[d];
+          }
+          colors[i] = static_cast<SiteColoring::color_t>(modulo(x, k));
+        });
+        auto coloring = SiteColoring(std::move(colors));
+        assert(coloring.IsProper(Neighbors()));
+
+        // two colors cannot be improved, otherwise the greedy coloring may
+        // use fewer, for example on odd sizes
+        if (k > 2L) {
+          auto greedy = SiteColoring::FromNeighbors(Neighbors());
+          if (greedy.GetNumColors() < coloring.GetNumColors()) {
+            return greedy;
+          }
         }
+        return coloring;
+      }
+      auto d = 0UL;
+      while (d < dim && w[d] == k - 1L) {
+        w[d++] = 0L;
+      }
+      if (d == dim) {
+        break;
+      }
+      w[d]++;
+    }
+  }
+  return SiteColoring::FromNeighbors(Neighbors());
+}
+
+template<std::size_t D>
+inline auto
+BasicLattice<D>::ComputeDistanceShells(ThreadPool& pool) const
+  -> DistanceShells
+{
+  const auto dim = GetDim();
+  const auto metric = bravais_.GetMetric();
+
+  const auto scale = DistanceShells::GetMetricScale(metric);
+  if (scale == 0L) {
+    auto squared = values_t(GetNumSites());
+    pool.ParallelFor(0UL, GetNumSites(), [&](index_t i) {
+      squared[i] = sum_squared<realvec_t, double>(GetVector(0UL, i));
+    });
+    return DistanceShells::FromSquaredDistances(squared);
+  }
+
+  // the squared norms of the shortest images in lattice coordinates are
+  // integers once the metric is scaled
+  auto gint = std::vector<std::int64_t>(dim * dim);
+  for (auto i = 0UL; i < dim * dim; i++) {
+    gint[i] = std::llround(static_cast<double>(scale) * metric[i]);
+  }
+  auto norms = std::vector<std::int64_t>(GetNumSites());
+  pool.ParallelFor(0UL, GetNumSites(), [&](index_t s) {
+    auto c = GetCoordinates(s);
+    images_.Reduce(c);
+    auto norm = std::int64_t{ 0 };
+    for (auto i = 0UL; i < dim; i++) {
+      for (auto j = 0UL; j < dim; j++) {
+        norm += c[i] * gint[i * dim + j] * c[j];
       }
     }
-    p[site] = minvec;
+    norms[s] = norm;
+  });
+  return DistanceShells::FromNorms(norms, scale);
+}
+
+template<std::size_t D>
+inline auto
+BasicLattice<D>::ComputeShellNeighbors(std::size_t k, ThreadPool& pool) const
+  -> neighbors_t
+{
+  // the vectors of the shell are paired with their opposite, as the
+  // directions of the Bravais lattice, so that the opposite of slot m is
+  // slot m ^ 1 for every site
+  auto displacements = vectorindex_t{};
+  auto paired = std::vector<bool>(GetNumSites(), false);
+  for (auto s : GetDistanceShells().GetSites(k)) {
+    if (!paired[s]) {
+      auto opposite = GetMappedSite(s, 0UL);
+      displacements.push_back(s);
+      displacements.push_back(opposite);
+      paired[s] = true;
+      paired[opposite] = true;
+    }
   }
+
+  const auto stride = displacements.size();
+  auto indices = aligned_vector<index_t>(GetNumSites() * stride);
+  pool.ParallelFor(0UL, GetNumSites(), [&](index_t a) {
+    for (auto m = 0UL; m < stride; m++) {
+      indices[a * stride + m] = GetUnMappedSite(displacements[m], a);
+    }
+  });
+  return neighbors_t(GetNumSites(),
+                     stride,
+                     Buffer<index_t>(),
+                     Buffer<index_t>(std::move(indices)),
+                     Buffer<NeighborTable::slot_t>(),
+                     Buffer<NeighborTable::slot_t>());
+}
+
+template<std::size_t D>
+inline auto
+BasicLattice<D>::Symmetries() const -> SymmetryTables const&
+{
+  assert(HasClosedBoundaries());
+  return GetLazyTable(GetTableIndex(DerivedTable::Symmetries),
+                      &LazyTables::symmetries,
+                      [this]() {
+                        auto pool = ThreadPool(numthreads_);
+                        return ComputeSymmetries(pool);
+                      });
+}
+
+template<std::size_t D>
+inline auto
+BasicLattice<D>::ComputeSymmetries(ThreadPool& pool) const -> SymmetryTables
+{
+  auto tables = SymmetryTables{};
+  tables.symmetry = LatticeSymmetry(bravais_, GetSize());
+  auto const& symmetry = tables.symmetry;
+  const auto numoperations = symmetry.GetNumOperations();
+
+  // site 0 is at the origin, the images of the mapped sites are wrapped
+  // into the lattice
+  auto images = vectorindex_t(GetNumSites() * numoperations);
+  pool.ParallelFor(0UL, GetNumSites(), [&](index_t i) {
+    auto c = GetCoordinates(i);
+    for (auto g = 0UL; g < numoperations; g++) {
+      auto image = symmetry.Apply(g, c);
+      EnforceBoundaries(image);
+      images[i * numoperations + g] = GetIndex(image);
+    }
+  });
+  tables.siteorbits =
+    Orbits(GetNumSites(), numoperations, [&](std::size_t g, index_t i) {
+      return images[i * numoperations + g];
+    });
+
+  // the momentum of site i has reciprocal coordinates q_d / L_d with
+  // q_d = c_d - L_d / 2, they are scaled by the least common multiple of the
+  // sizes to stay integers under the dual operations
+  auto scale = 1L;
+  for (auto l : GetSize()) {
+    scale = std::lcm(scale, static_cast<long>(l));
+  }
+  pool.ParallelFor(0UL, GetNumSites(), [&](index_t i) {
+    auto c = GetCoordinates(i);
+    auto q = c;
+    for (auto d = 0UL; d < GetDim(); d++) {
+      auto l = static_cast<long>(GetSize()[d]);
+      q[d] = (c[d] - l / 2L) * (scale / l);
+    }
+    for (auto g = 0UL; g < numoperations; g++) {
+      auto image = symmetry.ApplyDual(g, q);
+      for (auto d = 0UL; d < GetDim(); d++) {
+        auto l = static_cast<long>(GetSize()[d]);
+        assert((image[d] * l) % scale == 0L);
+        image[d] = image[d] * l / scale + l / 2L;
+      }
+      EnforceBoundaries(image);
+      images[i * numoperations + g] = GetIndex(image);
+    }
+  });
+  tables.momentumorbits =
+    Orbits(GetNumSites(), numoperations, [&](std::size_t g, index_t i) {
+      return images[i * numoperations + g];
+    });
+  return tables;
+}
+
+template<std::size_t D>
+inline auto
+BasicLattice<D>::ComputeMomentum(index_t i) const -> realvec_t
+{
+  // in a lattice with periodic boundary conditions the number
+  // of reciprocal lattice vectors are the same number as the
+  // sites of the direct lattice.
+  // The momenta are k = sum_d (c_d - L_d / 2) / L_d b_d where b_d are the
+  // primitive vectors of the reciprocal lattice, so that for every site
+  // k.x = 2 pi sum_d (c_d - L_d / 2) x_d / L_d in lattice coordinates.
+  assert(HasClosedBoundaries());
+  auto kappa = MakeRealVec();
+  auto ci = GetCoordinates(i);
+  for (auto d = 0UL; d < GetDim(); d++) {
+    auto s = static_cast<long>(GetSize()[d]);
+    auto q = static_cast<double>(ci[d] - s / 2L) / static_cast<double>(s);
+    for (auto m = 0UL; m < GetDim(); m++) {
+      kappa[m] += q * reciprocal_[d * GetDim() + m];
+    }
+  }
+  return kappa;
+}
+
+template<std::size_t D>
+template<class F>
+inline auto
+BasicLattice<D>::ComputeRows(ThreadPool& pool, F&& f) const -> tabledata_t
+{
+  const auto stride = GetPlaneStride();
+  auto p = tabledata_t(GetDim() * stride, 0.0);
+  pool.ParallelFor(0UL, GetNumSites(), [&](index_t i) {
+    auto x = f(i);
+    for (auto d = 0UL; d < GetDim(); d++) {
+      p[d * stride + i] = x[d];
+    }
+  });
   return p;
 }
 
+template<std::size_t D>
 inline auto
-Lattice::ComputeNeighbors(Bravais const& bravais) const -> Lattice::neighbors_t
+BasicLattice<D>::ComputePositions(ThreadPool& pool) const -> tabledata_t
 {
-  auto p = neighbors_t{};
-  const auto gamma = bravais.GetGamma();
+  return ComputeRows(pool, [this](index_t i) { return ComputePosition(i); });
+}
 
-  for (auto i = 0UL; i < GetNumSites(); i++) {
-    auto nn = gridsize_t{};
+template<std::size_t D>
+inline auto
+BasicLattice<D>::ComputeDistances(ThreadPool& pool) const -> tabledata_t
+{
+  // the vectors are computed again if they are not precomputed, to avoid
+  // storing them
+  const auto stored = has_table(precomputed_, LatticeTable::Vectors);
+  auto p = tabledata_t(GetNumSites());
+  pool.ParallelFor(0UL, GetNumSites(), [&](index_t i) {
+    auto x = stored ? GetRow(vectors_, i) : ComputeVector(i);
+    p[i] = std::sqrt(sum_squared<realvec_t, double>(x));
+  });
+  return p;
+}
+
+template<std::size_t D>
+inline auto
+BasicLattice<D>::ComputeVectors(ThreadPool& pool) const -> tabledata_t
+{
+  return ComputeRows(pool, [this](index_t i) { return ComputeVector(i); });
+}
+
+template<std::size_t D>
+inline auto
+BasicLattice<D>::ComputeNeighbors(ThreadPool& pool) const -> neighbors_t
+{
+  const auto gamma = bravais_.GetGamma();
+  assert(gamma <= 1UL + std::numeric_limits<NeighborTable::slot_t>::max());
+
+  // each site fills a row of gamma slots, the rows are compacted afterwards
+  auto offsets = vectorindex_t(GetNumSites() + 1UL, 0UL);
+  auto indices = aligned_vector<index_t>(GetNumSites() * gamma);
+  auto directions = NeighborTable::vectorslot_t(GetNumSites() * gamma);
+
+  pool.ParallelFor(0UL, GetNumSites(), [&](index_t i) {
     auto ci = GetCoordinates(i);
+    auto count = 0UL;
     for (auto j = 0UL; j < gamma; j++) {
-      auto cj = bravais.GetNeighbor(ci, j);
+      auto cj = bravais_.GetNeighbor(ci, j);
 
       // add the sites to the list of neighbors accordingly with the
       // boundary conditions set
       if (HasClosedBoundaries() || IsOnGrid(cj)) {
         EnforceBoundaries(cj);
-        nn.push_back(GetIndex(cj));
+        indices[i * gamma + count] = GetIndex(cj);
+        directions[i * gamma + count] = static_cast<NeighborTable::slot_t>(j);
+        count++;
       }
     }
-    p.push_back(std::move(nn));
+    offsets[i + 1UL] = count;
+  });
+
+  for (auto i = 0UL; i < GetNumSites(); i++) {
+    const auto count = offsets[i + 1UL];
+    offsets[i + 1UL] = offsets[i] + count;
+    std::copy_n(indices.begin() + static_cast<long>(i * gamma),
+                count,
+                indices.begin() + static_cast<long>(offsets[i]));
+    std::copy_n(directions.begin() + static_cast<long>(i * gamma),
+                count,
+                directions.begin() + static_cast<long>(offsets[i]));
+  }
+  indices.resize(offsets.back());
+  directions.resize(offsets.back());
+
+  return NeighborTable(
+    offsets, Buffer<index_t>(std::move(indices)), directions);
+}
+
+template<std::size_t D>
+inline auto
+BasicLattice<D>::ComputeMomenta(ThreadPool& pool) const -> tabledata_t
+{
+  // with open boundary conditions the momenta are not defined
+  if (HasOpenBoundaries()) {
+    return tabledata_t{};
   }
+  return ComputeRows(pool, [this](index_t i) { return ComputeMomentum(i); });
+}
 
+template<std::size_t D>
+inline auto
+BasicLattice<D>::ComputeReciprocal() const -> values_t
+{
+  auto p = values_t{};
+  for (auto d = 0UL; d < GetDim(); d++) {
+    auto ed = MakeCoords();
+    ed[d] = 1L;
+    auto bd = bravais_.GetReciprocalSpace(ed);
+    p.insert(p.end(), bd.begin(), bd.end());
+  }
   return p;
 }
 
+template<std::size_t D>
 inline auto
-Lattice::ComputeMomenta(Bravais const& bravais) const
-  -> std::vector<Lattice::realvec_t>
+BasicLattice<D>::ComputeMomentaFFT() const -> vectorindex_t
 {
-  auto p = std::vector<realvec_t>{};
+  auto p = vectorindex_t{};
 
-  // with open boundary conditions the momenta are not defined
   if (HasOpenBoundaries()) {
     return p;
   }
 
-  // in a lattice with periodic boundary conditions the number
-  // of reciprocal lattice vectors are the same number as the
-  // sites of the direct lattice
+  // the momentum with coordinates c corresponds to the frequency
+  // q = c - L / 2 (mod L) of the discrete Fourier transform, whose data are
+  // in row-major order
   for (auto i = 0UL; i < GetNumSites(); i++) {
     auto ci = GetCoordinates(i);
-    for (auto k = 0UL; k < ci.size(); k++) {
-      ci[k] -= GetSize()[k] / 2UL;
-    }
-    auto kappa = bravais.GetReciprocalSpace(ci);
-    for (auto k = 0UL; k < kappa.size(); k++) {
-      kappa[k] /= GetSize()[k];
+    for (auto d = 0UL; d < GetDim(); d++) {
+      auto s = static_cast<long>(GetSize()[d]);
+      ci[d] = (ci[d] - s / 2L + s) % s;
     }
-    p.push_back(kappa);
+    p.push_back(GetRowMajorIndex(GetIndex(ci)));
   }
 
   return p;
 }
 
+template<std::size_t D>
 template<class T>
 inline auto
-Lattice::AccumulateSk(std::vector<T> const& occupations,
-                      realvec_t& sk,
-                      double mult) const -> void
+BasicLattice<D>::AccumulateSk(std::vector<T> const& occupations,
+                              values_t& sk,
+                              double mult) const -> void
 {
   auto n = GetNumSites();
 
@@ -398,28 +1729,90 @@ Lattice::AccumulateSk(std::vector<T> const& occupations,
     return;
   }
 
+  auto rho = std::vector<FFT::complex_t>(n);
+  for (auto j = 0UL; j < n; j++) {
+    rho[GetRowMajorIndex(j)] = static_cast<double>(occupations[j]);
+  }
+
+  // since the momenta and the sites are both expressed in lattice
+  // coordinates the phases k.x are those of a discrete Fourier transform
+  // over the grid. The images of x only add multiples of 2 pi.
+  fft_.Transform(rho);
+
+  const auto norm = mult / static_cast<double>(square(n));
+  for (auto i = 0UL; i < n; i++) {
+    sk[i] += norm * std::norm(rho[momentafft_[i]]);
+  }
+}
+
+template<std::size_t D>
+template<class T>
+inline auto
+BasicLattice<D>::AccumulateSkDirect(std::vector<T> const& occupations,
+                                    values_t& sk,
+                                    double mult) const -> void
+{
+  auto n = GetNumSites();
+
+  if (HasOpenBoundaries()) {
+    return;
+  }
+
+  // the tables which are not stored are computed once for the whole sum
+  auto computedmomenta = table_t{};
+  auto computedvectors = table_t{};
+  if (!IsStored(LatticeTable::Momenta) || !IsStored(LatticeTable::Vectors)) {
+    auto pool = ThreadPool(numthreads_);
+    if (!IsStored(LatticeTable::Momenta)) {
+      computedmomenta = table_t(ComputeMomenta(pool));
+    }
+    if (!IsStored(LatticeTable::Vectors)) {
+      computedvectors = table_t(ComputeVectors(pool));
+    }
+  }
+  auto const& momenta =
+    IsStored(LatticeTable::Momenta) ? Momenta() : computedmomenta;
+  auto const& vectors =
+    IsStored(LatticeTable::Vectors) ? Vectors() : computedvectors;
+
+  // the phases k.x are accumulated one component at a time streaming the
+  // planes of the vectors
+  auto prod = std::vector<double>(n);
   for (auto i = 0UL; i < GetNumSites(); i++) {
-    auto const k = momenta_[i];
+    auto k = GetRow(momenta, i);
+    std::fill(prod.begin(), prod.end(), 0.0);
+    for (auto q = 0UL; q < GetDim(); q++) {
+      auto const x = GetPlane(vectors, q);
+      for (auto j = 0UL; j < n; j++) {
+        prod[j] += k[q] * x[j];
+      }
+    }
+
     auto im = 0.0;
     auto re = 0.0;
-
     for (auto j = 0UL; j < n; j++) {
-      auto const x = GetVector(0, j);
-      auto prod = 0.0;
-      for (auto q = 0UL; q < GetDim(); q++) {
-        prod += k[q] * x[q];
-      }
-      im += sin(prod) * occupations[j];
-      re += cos(prod) * occupations[j];
+      im += sin(prod[j]) * occupations[j];
+      re += cos(prod[j]) * occupations[j];
     }
     sk[i] += mult * (square(im) + square(re)) / static_cast<double>(square(n));
   }
 }
 
+template<std::size_t D>
+template<class T>
+inline auto
+BasicLattice<D>::AccumulateSkReduced(std::vector<T> const& occupations,
+                                     values_t& sk,
+                                     double mult) const -> void
+{
+  GetMomentumOrbits().Accumulate(ComputeSk(occupations), sk, mult);
+}
+
+template<std::size_t D>
 template<class T>
 inline auto
-Lattice::ComputeSk(std::vector<T> const& occupations, double mult) const
-  -> realvec_t
+BasicLattice<D>::ComputeSk(std::vector<T> const& occupations,
+                           double mult) const -> values_t
 {
   auto n = GetNumSites();
   auto sk = std::vector<double>(n, 0.0);
@@ -431,8 +1824,96 @@ Lattice::ComputeSk(std::vector<T> const& occupations, double mult) const
   return sk;
 }
 
+template<std::size_t D>
+template<class T>
+inline auto
+BasicLattice<D>::AccumulateCorrelation(std::vector<T> const& occupations,
+                                       values_t& cr,
+                                       double mult) const -> void
+{
+  auto n = GetNumSites();
+  assert(occupations.size() == n && cr.size() == n);
+
+  if (HasOpenBoundaries()) {
+    return;
+  }
+
+  auto rho = std::vector<FFT::complex_t>(n);
+  for (auto j = 0UL; j < n; j++) {
+    rho[GetRowMajorIndex(j)] = static_cast<double>(occupations[j]);
+  }
+
+  // the correlation over the translations of the grid is the backward
+  // transform of the power spectrum, both transforms being unnormalized
+  fft_.Transform(rho);
+  for (auto& x : rho) {
+    x = std::norm(x);
+  }
+  fft_.Transform(rho, FFT::direction_t::Backward);
+
+  const auto norm = mult / static_cast<double>(square(n));
+  for (auto r = 0UL; r < n; r++) {
+    cr[r] += norm * rho[GetRowMajorIndex(r)].real();
+  }
+}
+
+template<std::size_t D>
+template<class T>
+inline auto
+BasicLattice<D>::AccumulateCorrelationDirect(std::vector<T> const& occupations,
+                                             values_t& cr,
+                                             double mult) const -> void
+{
+  auto n = GetNumSites();
+  assert(occupations.size() == n && cr.size() == n);
+
+  if (HasOpenBoundaries()) {
+    return;
+  }
+
+  const auto norm = mult / static_cast<double>(n);
+  for (auto a = 0UL; a < n; a++) {
+    const auto weight = norm * static_cast<double>(occupations[a]);
+    for (auto b = 0UL; b < n; b++) {
+      cr[GetMappedSite(a, b)] += weight * static_cast<double>(occupations[b]);
+    }
+  }
+}
+
+template<std::size_t D>
+template<class T>
 inline auto
-Lattice::SavePositions(std::string const& fname) const -> void
+BasicLattice<D>::AccumulateCorrelationReduced(std::vector<T> const& occupations,
+                                              values_t& cr,
+                                              double mult) const -> void
+{
+  if (HasOpenBoundaries()) {
+    return;
+  }
+
+  auto const& shells = GetDistanceShells();
+  assert(cr.size() == shells.GetNumShells());
+  const auto full = ComputeCorrelation(occupations);
+  for (auto r = 0UL; r < full.size(); r++) {
+    const auto k = shells.GetShell(r);
+    cr[k] += mult * full[r] / static_cast<double>(shells.GetMultiplicity(k));
+  }
+}
+
+template<std::size_t D>
+template<class T>
+inline auto
+BasicLattice<D>::ComputeCorrelation(std::vector<T> const& occupations,
+                                    double mult) const -> values_t
+{
+  auto cr = values_t(GetNumSites(), 0.0);
+  AccumulateCorrelation(occupations, cr, mult);
+  return cr;
+}
+
+template<std::size_t D>
+inline auto
+BasicLattice<D>::SavePositions(std::string const& fname) const -> void
 {
   auto out = std::ofstream{ fname.c_str() };
 
@@ -452,8 +1933,9 @@ Lattice::SavePositions(std::string const& fname) const -> void
   }
 }
 
+template<std::size_t D>
 inline auto
-Lattice::SaveDistances(std::string const& fname) const -> void
+BasicLattice<D>::SaveDistances(std::string const& fname) const -> void
 {
   auto out = std::ofstream{ fname.c_str() };
 
@@ -473,8 +1955,9 @@ Lattice::SaveDistances(std::string const& fname) const -> void
   }
 }
 
+template<std::size_t D>
 inline void
-Lattice::SaveMomenta(std::string const& fname) const
+BasicLattice<D>::SaveMomenta(std::string const& fname) const
 {
   auto out = std::ofstream{ fname.c_str() };
 
@@ -486,15 +1969,16 @@ Lattice::SaveMomenta(std::string const& fname) const
 
   for (auto i = 0UL; i < GetNumSites(); i++) {
     fmt::print(out, "{}", i);
-    for (auto const& k : momenta_[i]) {
+    for (auto const& k : GetMomentum(i)) {
       fmt::print(out, ",{}", k);
     }
     fmt::print(out, "\n");
   }
 }
 
+template<std::size_t D>
 inline auto
-Lattice::SavePairs(std::string const& fname) const -> void
+BasicLattice<D>::SavePairs(std::string const& fname) const -> void
 {
   auto out = std::ofstream{ fname.c_str() };
 
@@ -538,8 +2022,9 @@ Lattice::SavePairs(std::string const& fname) const -> void
   }
 }
 
+template<std::size_t D>
 inline auto
-Lattice::SaveTriples(std::string const& fname) const -> void
+BasicLattice<D>::SaveTriples(std::string const& fname) const -> void
 {
     auto out = std::ofstream{ fname.c_str() };
 
@@ -589,16 +2074,275 @@ Lattice::SaveTriples(std::string const& fname) const -> void
     }
 }
 
+template<std::size_t D>
+inline auto
+BasicLattice<D>::MakeLatticeFile() const -> LatticeFile
+{
+  auto file = LatticeFile();
+  auto& header = file.GetHeader();
+  auto const& neighbors = Neighbors();
+  header.bravais = bravais_.GetHash();
+  header.dim = GetDim();
+  header.numsites = GetNumSites();
+  header.boundaries = static_cast<std::uint64_t>(this->GetBoundaries());
+  header.ordering = static_cast<std::uint64_t>(this->GetOrdering());
+  header.neighborstride = neighbors.GetStride();
+  std::copy(GetSize().begin(), GetSize().end(), header.size.begin());
+
+  // all the tables are saved, even if not stored so far
+  file.AddSection(LatticeSection::Positions, Positions());
+  file.AddSection(LatticeSection::Vectors, Vectors());
+  file.AddSection(LatticeSection::Distances, Distances());
+  file.AddSection(LatticeSection::NeighborOffsets, neighbors.GetOffsets());
+  file.AddSection(LatticeSection::NeighborIndices, neighbors.GetIndices());
+  file.AddSection(LatticeSection::NeighborDirections,
+                  neighbors.GetDirections());
+  file.AddSection(LatticeSection::NeighborOpposite,
+                  neighbors.GetOppositeSlots());
+  file.AddSection(LatticeSection::Momenta, Momenta());
+  file.AddSection(LatticeSection::MomentaFFT, momentafft_);
+  return file;
+}
+
+template<std::size_t D>
+inline auto
+BasicLattice<D>::Save(std::string const& fname) const -> void
+{
+  MakeLatticeFile().Write(fname);
+}
+
+template<std::size_t D>
+inline auto
+BasicLattice<D>::Share(SharedSegment& segment) const -> void
+{
+  // the image is written directly in the segment, the tables are never
+  // copied twice
+  auto file = MakeLatticeFile();
+  segment.Allocate(file.GetImageSize());
+  file.SerializeTo(segment.GetPayload());
+}
+
+template<std::size_t D>
+inline auto
+BasicLattice<D>::Load(std::string const& fname,
+                      Bravais const& bravais,
+                      gridsize_t const& size,
+                      boundaries_t boundaries,
+                      LatticeOptions const& options) -> BasicLattice
+{
+  return FromLatticeFile(LatticeFile::Open(fname, options.verifychecksum),
+                         fname,
+                         bravais,
+                         size,
+                         boundaries,
+                         options);
+}
+
+template<std::size_t D>
+inline auto
+BasicLattice<D>::FromLatticeFile(LatticeFile const& file,
+                                 std::string const& name,
+                                 Bravais const& bravais,
+                                 gridsize_t const& size,
+                                 boundaries_t boundaries,
+                                 LatticeOptions const& options)
+  -> BasicLattice
+{
+  auto fail = [&name](std::string const& what) {
+    throw exception::BadLatticeFile("lattice file " + name + ": " + what);
+  };
+
+  auto const& header = file.GetHeader();
+
+  auto numsites = 1UL;
+  for (auto l : size) {
+    numsites *= l;
+  }
+  const auto dim = static_cast<std::size_t>(size.size());
+  if (header.bravais != bravais.GetHash() || header.dim != dim ||
+      bravais.GetDim() != dim || header.numsites != numsites ||
+      header.boundaries != static_cast<std::uint64_t>(boundaries) ||
+      header.ordering != static_cast<std::uint64_t>(options.ordering) ||
+      !std::equal(size.begin(), size.end(), header.size.begin())) {
+    fail("saved for another lattice");
+  }
+
+  // the tables must have the sizes expected, their content is protected by
+  // the checksum
+  auto count = [&file](LatticeSection id, auto element) {
+    return file.GetSection<decltype(element)>(id).size();
+  };
+  const auto closed = boundaries == boundaries_t::Closed;
+  const auto stride = header.neighborstride;
+  const auto numslots = count(LatticeSection::NeighborIndices, index_t{});
+  const auto slot = NeighborTable::slot_t{};
+  constexpr auto n = DefaultAlignment / sizeof(double);
+  const auto planes = dim * ((numsites + n - 1UL) / n * n);
+  if (count(LatticeSection::Positions, 0.0) != planes ||
+      count(LatticeSection::Vectors, 0.0) != planes ||
+      count(LatticeSection::Distances, 0.0) != numsites ||
+      count(LatticeSection::Momenta, 0.0) != (closed ? planes : 0UL) ||
+      count(LatticeSection::MomentaFFT, index_t{}) !=
+        (closed ? numsites : 0UL) ||
+      (stride != 0UL && numslots != numsites * stride) ||
+      count(LatticeSection::NeighborOffsets, index_t{}) !=
+        (stride != 0UL ? 0UL : numsites + 1UL) ||
+      count(LatticeSection::NeighborDirections, slot) !=
+        (stride != 0UL ? 0UL : numslots) ||
+      count(LatticeSection::NeighborOpposite, slot) !=
+        (stride != 0UL ? 0UL : numslots)) {
+    fail("tables with wrong sizes");
+  }
+
+  return BasicLattice(file, bravais, size, boundaries, options);
+}
+
+template<std::size_t D>
+inline auto
+BasicLattice<D>::GetKey(Bravais const& bravais,
+                        gridsize_t const& size,
+                        boundaries_t boundaries,
+                        GridOrdering ordering) -> std::uint64_t
+{
+  auto h = hash_value(bravais.GetHash());
+  for (auto l : size) {
+    h = hash_value(static_cast<std::uint64_t>(l), h);
+  }
+  h = hash_value(static_cast<std::uint64_t>(boundaries), h);
+
+  // the row-major lattices keep the keys they had before the orderings
+  if (ordering != GridOrdering::RowMajor) {
+    h = hash_value(static_cast<std::uint64_t>(ordering), h);
+  }
+  return h;
+}
+
+template<std::size_t D>
+inline auto
+BasicLattice<D>::GetCacheFileName(std::string const& cachedir,
+                                  Bravais const& bravais,
+                                  gridsize_t const& size,
+                                  boundaries_t boundaries,
+                                  GridOrdering ordering) -> std::string
+{
+  return fmt::format("{}/lattice-{:016x}.bin",
+                     cachedir,
+                     GetKey(bravais, size, boundaries, ordering));
+}
+
+template<std::size_t D>
+inline auto
+BasicLattice<D>::GetSharedName(Bravais const& bravais,
+                               gridsize_t const& size,
+                               boundaries_t boundaries,
+                               GridOrdering ordering) -> std::string
+{
+  return fmt::format("/bwsl-lattice-{:016x}-v{}",
+                     GetKey(bravais, size, boundaries, ordering),
+                     LatticeFileVersion);
+}
+
+template<std::size_t D>
+inline auto
+BasicLattice<D>::LoadOrBuild(std::string const& cachedir,
+                             Bravais const& bravais,
+                             gridsize_t const& size,
+                             boundaries_t boundaries,
+                             LatticeOptions const& options) -> BasicLattice
+{
+  const auto fname =
+    GetCacheFileName(cachedir, bravais, size, boundaries, options.ordering);
+  try {
+    return Load(fname, bravais, size, boundaries, options);
+  } catch (exception::BadLatticeFile const&) {
+    // missing or unusable, build it again
+  }
+
+  auto lattice = BasicLattice(bravais, size, boundaries, options);
+  try {
+    lattice.Save(fname);
+  } catch (std::runtime_error const&) {
+    // the cache is only an optimization
+  }
+  return lattice;
+}
+
+template<std::size_t D>
+inline auto
+BasicLattice<D>::LoadOrBuildShared(Bravais const& bravais,
+                                   gridsize_t const& size,
+                                   boundaries_t boundaries,
+                                   LatticeOptions const& options)
+  -> BasicLattice
+{
+  using State = SharedSegment::State;
+  const auto name =
+    GetSharedName(bravais, size, boundaries, options.ordering);
+
+  auto attach = [&](std::shared_ptr<SharedSegment const> const& segment) {
+    auto file = LatticeFile::FromMemory(segment->GetPayload(),
+                                        segment->GetPayloadSize(),
+                                        segment,
+                                        name,
+                                        options.verifychecksum);
+    return FromLatticeFile(file, name, bravais, size, boundaries, options);
+  };
+
+  // the lattice built by the creator is kept, if sharing it fails it is
+  // returned instead of being built again
+  auto built = std::optional<BasicLattice>{};
+  try {
+    // a second round is needed only after removing a stale segment
+    for (auto round = 0UL; round < 2UL; round++) {
+      // a creator failing for any reason removes the segment, the others
+      // would wait for it otherwise
+      auto created =
+        SharedSegment::CreateAndPublish(name, [&](SharedSegment& segment) {
+          built.emplace(bravais, size, boundaries, options);
+          built->Share(segment);
+        });
+      if (created != nullptr) {
+        return attach(created);
+      }
+
+      auto [state, segment] =
+        SharedSegment::Attach(name, options.sharedtimeout);
+      if (state == State::Ready) {
+        try {
+          return attach(segment);
+        } catch (exception::BadLatticeFile const&) {
+          state = State::Stale;
+        }
+      }
+      if (state != State::Stale && state != State::Missing) {
+        break;
+      }
+      if (state == State::Stale) {
+        SharedSegment::Remove(name);
+      }
+    }
+  } catch (std::runtime_error const&) {
+    // shared memory not available
+  }
+
+  if (built.has_value()) {
+    return std::move(*built);
+  }
+  return BasicLattice(bravais, size, boundaries, options);
+}
+
+template<std::size_t D>
 inline auto
-Lattice::GetCoordination(size_t a) const -> size_t
+BasicLattice<D>::GetCoordination(index_t a) const -> index_t
 {
-  return neighbors_[a].size();
+  return Neighbors().GetCoordination(a);
 }
 
+template<std::size_t D>
 inline auto
-Lattice::GetCoordination() const -> size_t
+BasicLattice<D>::GetCoordination() const -> index_t
 {
-  return neighbors_[0].size();
+  return Neighbors().GetCoordination(0UL);
 }
 
 } // namespace bwsl
@@ -0,0 +1,448 @@
+//===-- LatticeFile.hpp ----------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the LatticeFile Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/Bravais.hpp>
+#include <bwsl/Buffer.hpp>
+#include <bwsl/Exceptions.hpp>
+#include <bwsl/Hash.hpp>
+#include <bwsl/MappedFile.hpp>
+
+// posix
+#include <unistd.h>
+
+// std
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bwsl {
+
+/// Tables stored in a lattice file
+enum class LatticeSection : std::uint64_t
+{
+  Positions,
+  Vectors,
+  Distances,
+  NeighborOffsets,
+  NeighborIndices,
+  NeighborDirections,
+  NeighborOpposite,
+  Momenta,
+  MomentaFFT,
+};
+
+/// Version of the format, to be increased at each incompatible change
+inline constexpr std::uint32_t LatticeFileVersion = 3U;
+
+/// Alignment in bytes of the sections in the file
+inline constexpr std::size_t LatticeFileAlignment = 64UL;
+
+///
+/// Header at the beginning of a lattice file.
+/// All the fields are stored with the byte order of the machine writing the
+/// file, which is recorded in `byteorder`.
+///
+struct LatticeFileHeader
+{
+  /// "BWSLLAT" followed by a null character
+  std::array<char, 8> magic{};
+
+  /// Version of the format
+  std::uint32_t version{ 0U };
+
+  /// Always 0x01020304 as written by the machine
+  std::uint32_t byteorder{ 0U };
+
+  /// Hash of the parameters of the Bravais lattice
+  std::uint64_t bravais{ 0UL };
+
+  /// Dimension of the lattice
+  std::uint64_t dim{ 0UL };
+
+  /// Number of sites
+  std::uint64_t numsites{ 0UL };
+
+  /// Boundary conditions, the value of the GridBoundaries enumerator
+  std::uint64_t boundaries{ 0UL };
+
+  /// Numbering of the sites, the value of the GridOrdering enumerator
+  std::uint64_t ordering{ 0UL };
+
+  /// Coordination of all the sites if uniform, zero otherwise
+  std::uint64_t neighborstride{ 0UL };
+
+  /// Number of entries in the table of the sections
+  std::uint64_t numsections{ 0UL };
+
+  /// Checksum of the whole file computed with this field set to zero
+  std::uint64_t checksum{ 0UL };
+
+  /// Size of the lattice in each dimension, zero after the dimension
+  std::array<std::uint64_t, Bravais::MaxDim> size{};
+};
+
+///
+/// Entry of the table of the sections, following the header.
+///
+struct LatticeFileSection
+{
+  /// Identifier of the section, the value of the LatticeSection enumerator
+  std::uint64_t id{ 0UL };
+
+  /// Position of the first byte from the beginning of the file
+  std::uint64_t offset{ 0UL };
+
+  /// Number of elements
+  std::uint64_t count{ 0UL };
+
+  /// Size in bytes of each element
+  std::uint64_t elementsize{ 0UL };
+};
+
+///
+/// Binary file holding the tables of a constructed lattice.
+///
+/// The file is made of the header, the table of the sections and the
+/// sections, each one aligned to LatticeFileAlignment bytes. When opened the
+/// file is mapped in memory and the sections are handed out as Buffer
+/// objects pointing directly into the mapping, which stays alive as long as
+/// any of them does. Nothing is copied and the pages are loaded by the
+/// operating system at the first access.
+///
+/// Files are written to a temporary file which is then renamed, so that
+/// concurrent readers never see a partially written file. The same image can
+/// also be placed in any other memory, like a shared memory segment, with
+/// Serialize and read back with FromMemory.
+///
+class LatticeFile
+{
+public:
+  /// Default constructor, an empty file to be filled and written
+  LatticeFile();
+
+  /// Copy constructor
+  LatticeFile(LatticeFile const& that) = default;
+
+  /// Move constructor
+  LatticeFile(LatticeFile&& that) = default;
+
+  /// Copy assignment operator
+  auto operator=(LatticeFile const& that) -> LatticeFile& = default;
+
+  /// Move assignment operator
+  auto operator=(LatticeFile&& that) -> LatticeFile& = default;
+
+  /// Default destructor
+  virtual ~LatticeFile() = default;
+
+  /// Map the file @p fname and check its consistency, with @p verify the
+  /// checksum is also checked, which reads the whole file.
+  /// Throw exception::BadLatticeFile if the file cannot be used.
+  [[nodiscard]] static auto Open(std::string const& fname, bool verify = true)
+    -> LatticeFile;
+
+  /// Read the image of a file made of the @p size bytes at @p data , aligned
+  /// to LatticeFileAlignment, which are kept alive by @p holder . The image
+  /// is checked as with Open, @p name is only used in the error messages.
+  [[nodiscard]] static auto FromMemory(void const* data,
+                                       std::size_t size,
+                                       std::shared_ptr<void const> holder,
+                                       std::string const& name,
+                                       bool verify = true) -> LatticeFile;
+
+  /// Get the header
+  [[nodiscard]] auto GetHeader() const -> LatticeFileHeader const&
+  {
+    return header_;
+  }
+
+  /// Get the header, to be filled before writing
+  [[nodiscard]] auto GetHeader() -> LatticeFileHeader& { return header_; }
+
+  /// Add a section with the @p count elements at @p data .
+  /// The elements are not copied and must be alive until Write is called.
+  template<class T>
+  auto AddSection(LatticeSection id, T const* data, std::size_t count) -> void;
+
+  /// Add a section with the elements of @p data
+  template<class Container>
+  auto AddSection(LatticeSection id, Container const& data) -> void
+  {
+    AddSection(id, data.data(), data.size());
+  }
+
+  /// Get the size in bytes of the image of the file with the header and the
+  /// sections added
+  [[nodiscard]] auto GetImageSize() -> std::size_t;
+
+  /// Get the image of the file with the header and the sections added
+  [[nodiscard]] auto Serialize() -> std::vector<char>;
+
+  /// Write the image of the file to the GetImageSize() bytes at @p data ,
+  /// for example the payload of a shared memory segment, without any copy
+  /// in between
+  auto SerializeTo(void* data) -> void;
+
+  /// Write the header and the sections added to the file @p fname .
+  /// Throw std::runtime_error on failure.
+  auto Write(std::string const& fname) -> void;
+
+  /// Check if the file has the section @p id
+  [[nodiscard]] auto HasSection(LatticeSection id) const -> bool
+  {
+    return Find(id) != nullptr;
+  }
+
+  /// Get the elements of section @p id of an opened file.
+  /// Throw exception::BadLatticeFile if it is missing or of another type.
+  template<class T>
+  [[nodiscard]] auto GetSection(LatticeSection id) const -> Buffer<T>;
+
+protected:
+  /// Find the entry of section @p id
+  [[nodiscard]] auto Find(LatticeSection id) const
+    -> LatticeFileSection const*;
+
+private:
+  /// Header
+  LatticeFileHeader header_{};
+
+  /// Table of the sections
+  std::vector<LatticeFileSection> sections_{};
+
+  /// Data of the sections to be written
+  std::vector<void const*> pending_{};
+
+  /// First byte of an opened file
+  char const* data_{ nullptr };
+
+  /// Owner of the memory of an opened file
+  std::shared_ptr<void const> holder_{};
+}; // class LatticeFile
+
+inline LatticeFile::LatticeFile()
+{
+  std::memcpy(header_.magic.data(), "BWSLLAT", 8UL);
+  header_.version = LatticeFileVersion;
+  header_.byteorder = 0x01020304U;
+}
+
+template<class T>
+inline auto
+LatticeFile::AddSection(LatticeSection id, T const* data, std::size_t count)
+  -> void
+{
+  static_assert(std::is_trivially_copyable_v<T>);
+  sections_.push_back(LatticeFileSection{
+    static_cast<std::uint64_t>(id), 0UL, count, sizeof(T) });
+  pending_.push_back(data);
+}
+
+inline auto
+LatticeFile::GetImageSize() -> std::size_t
+{
+  auto align = [](std::size_t n) {
+    return (n + LatticeFileAlignment - 1UL) / LatticeFileAlignment *
+           LatticeFileAlignment;
+  };
+
+  header_.numsections = sections_.size();
+  auto end = align(sizeof(header_) + sections_.size() * sizeof(sections_[0]));
+  for (auto& s : sections_) {
+    s.offset = end;
+    end = align(end + s.count * s.elementsize);
+  }
+  return end;
+}
+
+inline auto
+LatticeFile::Serialize() -> std::vector<char>
+{
+  auto bytes = std::vector<char>(GetImageSize(), 0);
+  SerializeTo(bytes.data());
+  return bytes;
+}
+
+inline auto
+LatticeFile::SerializeTo(void* data) -> void
+{
+  const auto size = GetImageSize();
+  auto* bytes = static_cast<char*>(data);
+
+  // the padding is cleared as well, the checksum covers it
+  header_.checksum = 0UL;
+  auto written = sizeof(header_) + sections_.size() * sizeof(sections_[0]);
+  std::memcpy(bytes, &header_, sizeof(header_));
+  std::memcpy(bytes + sizeof(header_),
+              sections_.data(),
+              sections_.size() * sizeof(sections_[0]));
+  for (auto i = 0UL; i < sections_.size(); i++) {
+    const auto count = sections_[i].count * sections_[i].elementsize;
+    std::memset(bytes + written, 0, sections_[i].offset - written);
+    if (count > 0UL) {
+      std::memcpy(bytes + sections_[i].offset, pending_[i], count);
+    }
+    written = sections_[i].offset + count;
+  }
+  std::memset(bytes + written, 0, size - written);
+
+  header_.checksum = checksum_bytes(bytes, size);
+  std::memcpy(bytes + offsetof(LatticeFileHeader, checksum),
+              &header_.checksum,
+              sizeof(header_.checksum));
+}
+
+inline auto
+LatticeFile::Write(std::string const& fname) -> void
+{
+  const auto bytes = Serialize();
+
+  // unique name for each process and thread writing the same file
+  const auto tmpname =
+    fname + ".tmp." + std::to_string(::getpid()) + "." +
+    std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+  {
+    auto out = std::ofstream(tmpname, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    out.close();
+    if (!out) {
+      std::remove(tmpname.c_str());
+      throw std::runtime_error("cannot write " + tmpname);
+    }
+  }
+  if (std::rename(tmpname.c_str(), fname.c_str()) != 0) {
+    std::remove(tmpname.c_str());
+    throw std::runtime_error("cannot rename " + tmpname + " to " + fname);
+  }
+}
+
+inline auto
+LatticeFile::Open(std::string const& fname, bool verify) -> LatticeFile
+{
+  auto mapping = std::shared_ptr<MappedFile const>{};
+  try {
+    mapping = std::make_shared<MappedFile const>(fname);
+  } catch (std::runtime_error const& e) {
+    throw exception::BadLatticeFile(e.what());
+  }
+  return FromMemory(
+    mapping->GetData(), mapping->GetSize(), mapping, fname, verify);
+}
+
+inline auto
+LatticeFile::FromMemory(void const* image,
+                        std::size_t size,
+                        std::shared_ptr<void const> holder,
+                        std::string const& name,
+                        bool verify) -> LatticeFile
+{
+  auto fail = [&name](std::string const& what) {
+    throw exception::BadLatticeFile("lattice file " + name + ": " + what);
+  };
+
+  assert(reinterpret_cast<std::uintptr_t>(image) % LatticeFileAlignment ==
+         0UL);
+  auto file = LatticeFile();
+  auto const* data = static_cast<char const*>(image);
+  file.data_ = data;
+  file.holder_ = std::move(holder);
+
+  auto& header = file.header_;
+  if (size < sizeof(header)) {
+    fail("truncated header");
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic.data(), "BWSLLAT", 8UL) != 0) {
+    fail("not a lattice file");
+  }
+  if (header.byteorder != 0x01020304U) {
+    fail("written with another byte order");
+  }
+  if (header.version != LatticeFileVersion) {
+    fail("unsupported version " + std::to_string(header.version));
+  }
+  if (header.dim > Bravais::MaxDim) {
+    fail("dimension too large");
+  }
+
+  const auto tablesize = header.numsections * sizeof(LatticeFileSection);
+  if (header.numsections > size || sizeof(header) + tablesize > size) {
+    fail("truncated table of the sections");
+  }
+  file.sections_.resize(header.numsections);
+  std::memcpy(file.sections_.data(), data + sizeof(header), tablesize);
+  for (auto const& s : file.sections_) {
+    if (s.offset % LatticeFileAlignment != 0UL || s.offset > size ||
+        (s.elementsize != 0UL && s.count > (size - s.offset) / s.elementsize)) {
+      fail("section out of bounds");
+    }
+  }
+
+  if (verify) {
+    auto copy = header;
+    copy.checksum = 0UL;
+    auto h = checksum_bytes(&copy, sizeof(copy));
+    h = checksum_bytes(data + sizeof(copy), size - sizeof(copy), h);
+    if (h != header.checksum) {
+      fail("wrong checksum");
+    }
+  }
+
+  return file;
+}
+
+inline auto
+LatticeFile::Find(LatticeSection id) const -> LatticeFileSection const*
+{
+  for (auto const& s : sections_) {
+    if (s.id == static_cast<std::uint64_t>(id)) {
+      return &s;
+    }
+  }
+  return nullptr;
+}
+
+template<class T>
+inline auto
+LatticeFile::GetSection(LatticeSection id) const -> Buffer<T>
+{
+  assert(data_ != nullptr);
+  auto const* s = Find(id);
+  if (s == nullptr || s->elementsize != sizeof(T)) {
+    throw exception::BadLatticeFile(
+      "lattice file: missing section " +
+      std::to_string(static_cast<std::uint64_t>(id)));
+  }
+  return Buffer<T>(
+    reinterpret_cast<T const*>(data_ + s->offset), s->count, holder_);
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
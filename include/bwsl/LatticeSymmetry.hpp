@@ -0,0 +1,274 @@
+//===-- LatticeSymmetry.hpp ------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the LatticeSymmetry Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/Bravais.hpp>
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Point group of a Bravais lattice with closed boundaries.
+///
+/// Every operation is an integer matrix `R` acting on the lattice
+/// coordinates, whose column j holds the coordinates of the image of the
+/// primitive vector `a_j`. The operations are those preserving the metric,
+/// `R^T G R = G` with `G_ij = a_i . a_j`, and mapping the superlattice
+/// spanned by `L_j a_j` onto itself, so that they act on the sites of the
+/// periodic lattice. The coordinates of the momenta on the reciprocal basis
+/// transform with the dual matrix `R^-T`.
+///
+/// The images of the primitive vectors are searched among the integer
+/// vectors with components up to MaxComponent, which covers the usual
+/// choices of the primitive vectors.
+///
+class LatticeSymmetry
+{
+public:
+  /// Integer matrix, stored by rows
+  using matrix_t = std::vector<long>;
+
+  /// Largest component of the images of the primitive vectors
+  static constexpr long MaxComponent = 2L;
+
+  /// Relative tolerance used to compare the scalar products
+  static constexpr double Tolerance = 1e-9;
+
+  /// Default constructor
+  LatticeSymmetry() = default;
+
+  /// Find the point group of @p bravais with the periodicity @p size
+  template<class Container>
+  LatticeSymmetry(Bravais const& bravais, Container const& size);
+
+  /// Copy constructor
+  LatticeSymmetry(LatticeSymmetry const& that) = default;
+
+  /// Move constructor
+  LatticeSymmetry(LatticeSymmetry&& that) = default;
+
+  /// Copy assignment operator
+  auto operator=(LatticeSymmetry const& that) -> LatticeSymmetry& = default;
+
+  /// Move assignment operator
+  auto operator=(LatticeSymmetry&& that) -> LatticeSymmetry& = default;
+
+  /// Default destructor
+  virtual ~LatticeSymmetry() = default;
+
+  /// Get the dimension
+  [[nodiscard]] auto GetDim() const -> std::size_t { return dim_; }
+
+  /// Get the number of operations, the identity is the first one
+  [[nodiscard]] auto GetNumOperations() const -> std::size_t
+  {
+    return operations_.size();
+  }
+
+  /// Get the matrix of operation @p g
+  [[nodiscard]] auto GetOperation(std::size_t g) const -> matrix_t const&
+  {
+    assert(g < operations_.size());
+    return operations_[g];
+  }
+
+  /// Get the dual matrix of operation @p g , acting on the momenta
+  [[nodiscard]] auto GetDual(std::size_t g) const -> matrix_t const&
+  {
+    assert(g < duals_.size());
+    return duals_[g];
+  }
+
+  /// Get the image of the lattice coordinates @p coords under operation @p g
+  template<class C>
+  [[nodiscard]] auto Apply(std::size_t g, C const& coords) const -> C
+  {
+    return Multiply(GetOperation(g), coords);
+  }
+
+  /// Get the image of the reciprocal coordinates @p coords under operation
+  /// @p g
+  template<class C>
+  [[nodiscard]] auto ApplyDual(std::size_t g, C const& coords) const -> C
+  {
+    return Multiply(GetDual(g), coords);
+  }
+
+protected:
+  /// Product of the matrix @p m and the vector @p coords
+  template<class C>
+  [[nodiscard]] auto Multiply(matrix_t const& m, C const& coords) const -> C;
+
+  /// Search the operations given the metric @p metric and the sizes
+  /// @p size
+  auto FindOperations(std::vector<double> const& metric,
+                      std::vector<long> const& size) -> void;
+
+private:
+  /// Dimension
+  std::size_t dim_{ 0UL };
+
+  /// Matrices of the operations
+  std::vector<matrix_t> operations_{};
+
+  /// Dual matrices of the operations
+  std::vector<matrix_t> duals_{};
+}; // class LatticeSymmetry
+
+template<class Container>
+inline LatticeSymmetry::LatticeSymmetry(Bravais const& bravais,
+                                        Container const& size)
+  : dim_(bravais.GetDim())
+{
+  assert(size.size() == dim_);
+  FindOperations(bravais.GetMetric(),
+                 std::vector<long>(size.begin(), size.end()));
+}
+
+template<class C>
+inline auto
+LatticeSymmetry::Multiply(matrix_t const& m, C const& coords) const -> C
+{
+  assert(coords.size() == dim_);
+  auto image = coords;
+  for (auto i = 0UL; i < dim_; i++) {
+    auto x = 0L;
+    for (auto j = 0UL; j < dim_; j++) {
+      x += m[i * dim_ + j] * static_cast<long>(coords[j]);
+    }
+    image[i] = x;
+  }
+  return image;
+}
+
+inline auto
+LatticeSymmetry::FindOperations(std::vector<double> const& metric,
+                                std::vector<long> const& size) -> void
+{
+  const auto dim = dim_;
+  auto product = [&](auto const& u, auto const& v) {
+    auto p = 0.0;
+    for (auto i = 0UL; i < dim; i++) {
+      for (auto j = 0UL; j < dim; j++) {
+        p += static_cast<double>(u[i]) * metric[i * dim + j] *
+             static_cast<double>(v[j]);
+      }
+    }
+    return p;
+  };
+  auto same = [](double a, double b) {
+    return std::abs(a - b) <= Tolerance * std::max(1.0, std::abs(a));
+  };
+
+  // the candidate images of each primitive vector have its length and keep
+  // the superlattice, L_j R_ij must be a multiple of L_i
+  auto candidates = std::vector<std::vector<std::vector<long>>>(dim);
+  auto v = std::vector<long>(dim, -MaxComponent);
+  for (;;) {
+    for (auto j = 0UL; j < dim; j++) {
+      auto keep = same(metric[j * dim + j], product(v, v));
+      for (auto i = 0UL; i < dim && keep; i++) {
+        keep = (v[i] * size[j]) % size[i] == 0L;
+      }
+      if (keep) {
+        candidates[j].push_back(v);
+      }
+    }
+    auto d = 0UL;
+    while (d < dim && v[d] == MaxComponent) {
+      v[d++] = -MaxComponent;
+    }
+    if (d == dim) {
+      break;
+    }
+    v[d]++;
+  }
+
+  // the columns are chosen one at a time keeping the scalar products with
+  // the previous ones
+  auto columns = std::vector<std::vector<long>>(dim);
+  auto choose = [&](auto&& self, std::size_t j) -> void {
+    if (j == dim) {
+      auto m = matrix_t(dim * dim);
+      for (auto i = 0UL; i < dim; i++) {
+        for (auto k = 0UL; k < dim; k++) {
+          m[i * dim + k] = columns[k][i];
+        }
+      }
+      operations_.push_back(std::move(m));
+      return;
+    }
+    for (auto const& c : candidates[j]) {
+      auto keep = true;
+      for (auto k = 0UL; k < j && keep; k++) {
+        keep = same(metric[k * dim + j], product(columns[k], c));
+      }
+      if (keep) {
+        columns[j] = c;
+        self(self, j + 1UL);
+      }
+    }
+  };
+  choose(choose, 0UL);
+
+  // identity first
+  auto identity = matrix_t(dim * dim, 0L);
+  for (auto i = 0UL; i < dim; i++) {
+    identity[i * dim + i] = 1L;
+  }
+  auto found = std::find(operations_.begin(), operations_.end(), identity);
+  assert(found != operations_.end());
+  std::iter_swap(operations_.begin(), found);
+
+  // the inverse is in the group, its transpose is the dual
+  auto multiply = [dim](matrix_t const& a, matrix_t const& b) {
+    auto m = matrix_t(dim * dim, 0L);
+    for (auto i = 0UL; i < dim; i++) {
+      for (auto k = 0UL; k < dim; k++) {
+        for (auto j = 0UL; j < dim; j++) {
+          m[i * dim + j] += a[i * dim + k] * b[k * dim + j];
+        }
+      }
+    }
+    return m;
+  };
+  for (auto const& r : operations_) {
+    for (auto const& s : operations_) {
+      if (multiply(r, s) == identity) {
+        auto dual = matrix_t(dim * dim);
+        for (auto i = 0UL; i < dim; i++) {
+          for (auto j = 0UL; j < dim; j++) {
+            dual[i * dim + j] = s[j * dim + i];
+          }
+        }
+        duals_.push_back(std::move(dual));
+        break;
+      }
+    }
+  }
+  assert(duals_.size() == operations_.size());
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,122 @@
+//===-- MappedFile.hpp -----------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the MappedFile Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// posix
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// std
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace bwsl {
+
+///
+/// Read only memory mapping of a whole file.
+/// The pages are loaded lazily by the operating system and shared among all
+/// the processes mapping the same file.
+///
+class MappedFile
+{
+public:
+  /// Default constructor, maps nothing
+  MappedFile() = default;
+
+  /// Map the file @p fname , throw std::runtime_error on failure
+  explicit MappedFile(std::string const& fname);
+
+  /// Copy constructor
+  MappedFile(MappedFile const& that) = delete;
+
+  /// Move constructor
+  MappedFile(MappedFile&& that) noexcept
+    : data_(std::exchange(that.data_, nullptr))
+    , size_(std::exchange(that.size_, 0UL))
+  {
+  }
+
+  /// Copy assignment operator
+  auto operator=(MappedFile const& that) -> MappedFile& = delete;
+
+  /// Move assignment operator
+  auto operator=(MappedFile&& that) noexcept -> MappedFile&
+  {
+    std::swap(data_, that.data_);
+    std::swap(size_, that.size_);
+    return *this;
+  }
+
+  /// Destructor, removes the mapping
+  virtual ~MappedFile()
+  {
+    if (data_ != nullptr) {
+      ::munmap(data_, size_);
+    }
+  }
+
+  /// Get the first byte of the mapping
+  [[nodiscard]] auto GetData() const -> void const* { return data_; }
+
+  /// Get the size of the mapping in bytes
+  [[nodiscard]] auto GetSize() const -> std::size_t { return size_; }
+
+private:
+  /// Mapped memory
+  void* data_{ nullptr };
+
+  /// Size of the mapping
+  std::size_t size_{ 0UL };
+}; // class MappedFile
+
+inline MappedFile::MappedFile(std::string const& fname)
+{
+  auto fail = [&fname](char const* what) {
+    throw std::runtime_error(std::string(what) + " " + fname + ": " +
+                             std::strerror(errno));
+  };
+
+  const auto fd = ::open(fname.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    fail("cannot open");
+  }
+
+  struct stat st = {};
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    fail("cannot stat");
+  }
+  size_ = static_cast<std::size_t>(st.st_size);
+
+  if (size_ > 0UL) {
+    data_ = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    if (data_ == MAP_FAILED) {
+      data_ = nullptr;
+      ::close(fd);
+      fail("cannot map");
+    }
+  }
+  ::close(fd);
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -295,6 +295,37 @@ get_inverted(Container c) -> Container
   return c;
 }
 
+///
+/// Check if a type is a std::array
+///
+template<class C>
+struct is_std_array : std::false_type
+{};
+
+template<class T, std::size_t N>
+struct is_std_array<std::array<T, N>> : std::true_type
+{};
+
+///
+/// Create a container with @p n elements equal to @p value.
+/// Containers with a size fixed at compile time, like std::array, are only
+/// filled with @p value.
+///
+template<class C>
+inline auto
+make_filled(size_t n, typename C::value_type value) -> C
+{
+  if constexpr (is_std_array<C>::value) {
+    assert(n == std::tuple_size<C>::value && "Dimensions not matching");
+    static_cast<void>(n);
+    auto result = C{};
+    result.fill(value);
+    return result;
+  } else {
+    return C(n, value);
+  }
+}
+
 ///
 /// Transform coordinates to index
 ///
@@ -309,12 +340,10 @@ array_to_index(C const& a, D const& size) -> size_t
   auto dim = size.size();
   assert(a.size() == dim && "Dimensions not matching");
 
+  // Horner scheme, no division needed
   auto index = 0UL;
-  auto prod = accumulate_product(size);
-
   for (auto i = 0UL; i < dim; i++) {
-    prod /= size[i];
-    index += prod * static_cast<size_t>(a[i]);
+    index = index * size[i] + static_cast<size_t>(a[i]);
   }
 
   return index;
@@ -332,14 +361,12 @@ index_to_array(size_t index, D const& size) -> C
   static_assert(std::is_integral<typename C::value_type>::value,
                 "Integral required.");
   auto dim = size.size();
-  auto prod = accumulate_product(size);
-
-  auto result = C(dim, 0);
+  auto result = make_filled<C>(dim, 0);
 
-  for (auto i = 0UL; i < dim; i++) {
-    prod /= size[i];
-    result[i] = static_cast<typename C::value_type>(index / prod);
-    index = index % prod;
+  // peel the coordinates starting from the fastest varying one
+  for (auto i = dim; i-- > 0UL;) {
+    result[i] = static_cast<typename C::value_type>(index % size[i]);
+    index /= size[i];
   }
 
   return result;
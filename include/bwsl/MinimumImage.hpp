@@ -0,0 +1,350 @@
+//===-- MinimumImage.hpp ---------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the MinimumImage Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/Bravais.hpp>
+#include <bwsl/MathUtils.hpp>
+
+// std
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Search of the shortest periodic image of a vector of a Bravais lattice
+/// with closed boundaries.
+///
+/// The periodic images of a point differ by the vectors of the superlattice
+/// spanned by `L_d a_d`. Its basis is LLL reduced once and the Voronoi
+/// relevant vectors of the superlattice are extracted from the short
+/// combinations of the reduced basis. The shortest image is then found with
+/// the iterative slicer: a relevant vector is subtracted whenever it makes
+/// the vector strictly shorter, until none does. The vector reached lies in
+/// the Voronoi cell of the origin, hence it is the shortest one, and the
+/// number of steps needed for the points of the supercell is small and does
+/// not depend on the size of the lattice.
+///
+/// All the vectors are handled in integer lattice coordinates, the real space
+/// is only used to compare lengths.
+///
+class MinimumImage
+{
+public:
+  /// Coordinates of a point in the lattice
+  using coords_t = std::vector<long>;
+
+  /// Default constructor
+  MinimumImage() = default;
+
+  /// Prepare the search for the lattice @p bravais with periodicity @p size
+  template<class Container>
+  MinimumImage(Bravais const& bravais, Container const& size);
+
+  /// Copy constructor
+  MinimumImage(MinimumImage const& that) = default;
+
+  /// Move constructor
+  MinimumImage(MinimumImage&& that) = default;
+
+  /// Copy assignment operator
+  auto operator=(MinimumImage const& that) -> MinimumImage& = default;
+
+  /// Move assignment operator
+  auto operator=(MinimumImage&& that) -> MinimumImage& = default;
+
+  /// Default destructor
+  virtual ~MinimumImage() = default;
+
+  /// Get the dimension
+  [[nodiscard]] auto GetDim() const -> size_t { return dim_; }
+
+  /// Get the reduced basis of the superlattice, in lattice coordinates
+  [[nodiscard]] auto GetReducedBasis() const -> std::vector<coords_t>;
+
+  /// Get the number of Voronoi relevant vectors of the superlattice
+  [[nodiscard]] auto GetNumRelevant() const -> size_t
+  {
+    return relevantnorm_.size();
+  }
+
+  /// Get one of the Voronoi relevant vectors, in lattice coordinates
+  [[nodiscard]] auto GetRelevant(size_t i) const -> coords_t
+  {
+    auto first = relevant_.begin() + static_cast<long>(i * dim_);
+    return coords_t(first, first + static_cast<long>(dim_));
+  }
+
+  /// Replace the lattice coordinates @p coords with those of its shortest
+  /// periodic image. If the vector is already one of the shortest it is left
+  /// untouched.
+  template<class C>
+  auto Reduce(C& coords) const -> void;
+
+protected:
+  /// Relative tolerance on the squared lengths in the comparisons
+  static constexpr double Tolerance = 1e-10;
+
+  /// Real space vector of the lattice coordinates @p c
+  template<class C>
+  auto RealSpace(C const& c, double* x) const -> void;
+
+  /// Reduce the basis `basis_` with the LLL algorithm
+  auto ReduceBasis() -> void;
+
+  /// Find the Voronoi relevant vectors among the short combinations of the
+  /// reduced basis
+  auto FindRelevant() -> void;
+
+private:
+  /// Dimension
+  size_t dim_{ 0UL };
+
+  /// Primitive vectors in real space, one row for each vector
+  std::vector<double> primitive_{};
+
+  /// Basis of the superlattice in lattice coordinates, one row each
+  std::vector<long> basis_{};
+
+  /// Voronoi relevant vectors in lattice coordinates, one row each
+  std::vector<long> relevant_{};
+
+  /// Voronoi relevant vectors in real space, one row each
+  std::vector<double> relevantreal_{};
+
+  /// Squared length of the relevant vectors
+  std::vector<double> relevantnorm_{};
+}; // class MinimumImage
+
+template<class Container>
+inline MinimumImage::MinimumImage(Bravais const& bravais,
+                                  Container const& size)
+  : dim_(bravais.GetDim())
+  , primitive_(dim_ * dim_, 0.0)
+  , basis_(dim_ * dim_, 0L)
+{
+  assert(size.size() == dim_);
+
+  for (auto d = 0UL; d < dim_; d++) {
+    auto ed = coords_t(dim_, 0L);
+    ed[d] = 1L;
+    auto ad = bravais.GetRealSpace(ed);
+    std::copy(ad.begin(), ad.end(), primitive_.begin() + d * dim_);
+    basis_[d * dim_ + d] = static_cast<long>(size[d]);
+  }
+
+  ReduceBasis();
+  FindRelevant();
+}
+
+template<class C>
+inline auto
+MinimumImage::RealSpace(C const& c, double* x) const -> void
+{
+  for (auto m = 0UL; m < dim_; m++) {
+    x[m] = 0.0;
+  }
+  for (auto d = 0UL; d < dim_; d++) {
+    const auto cd = static_cast<double>(c[d]);
+    for (auto m = 0UL; m < dim_; m++) {
+      x[m] += cd * primitive_[d * dim_ + m];
+    }
+  }
+}
+
+inline auto
+MinimumImage::ReduceBasis() -> void
+{
+  const auto n = dim_;
+  auto real = std::vector<double>(n * n);
+  auto gs = std::vector<double>(n * n);
+  auto mu = std::vector<double>(n * n);
+  auto norm = std::vector<double>(n);
+
+  auto dot = [n](double const* a, double const* b) {
+    auto s = 0.0;
+    for (auto m = 0UL; m < n; m++) {
+      s += a[m] * b[m];
+    }
+    return s;
+  };
+
+  // Gram-Schmidt orthogonalization of the current basis
+  auto orthogonalize = [&]() {
+    for (auto i = 0UL; i < n; i++) {
+      RealSpace(basis_.data() + i * n, real.data() + i * n);
+    }
+    for (auto i = 0UL; i < n; i++) {
+      std::copy_n(real.begin() + i * n, n, gs.begin() + i * n);
+      for (auto j = 0UL; j < i; j++) {
+        mu[i * n + j] = dot(real.data() + i * n, gs.data() + j * n) / norm[j];
+        for (auto m = 0UL; m < n; m++) {
+          gs[i * n + m] -= mu[i * n + j] * gs[j * n + m];
+        }
+      }
+      norm[i] = dot(gs.data() + i * n, gs.data() + i * n);
+    }
+  };
+
+  // LLL with delta = 0.99
+  const auto delta = 0.99;
+  orthogonalize();
+  auto k = 1UL;
+  while (k < n) {
+    for (auto j = k; j-- > 0UL;) {
+      const auto q = std::lround(mu[k * n + j]);
+      if (q != 0L) {
+        for (auto m = 0UL; m < n; m++) {
+          basis_[k * n + m] -= q * basis_[j * n + m];
+        }
+        orthogonalize();
+      }
+    }
+    if (norm[k] >= (delta - square(mu[k * n + k - 1UL])) * norm[k - 1UL]) {
+      k++;
+    } else {
+      for (auto m = 0UL; m < n; m++) {
+        std::swap(basis_[k * n + m], basis_[(k - 1UL) * n + m]);
+      }
+      orthogonalize();
+      k = std::max(k - 1UL, 1UL);
+    }
+  }
+}
+
+inline auto
+MinimumImage::FindRelevant() -> void
+{
+  // A vector v is Voronoi relevant if and only if +v and -v are the only
+  // shortest vectors of the coset v + 2 L. The cosets are labeled by the
+  // parity of the coefficients on the basis, and for a reduced basis the
+  // shortest vectors of each coset have small coefficients.
+  const auto n = dim_;
+  const auto range = 2L;
+  auto ncoeffs = 1UL;
+  for (auto d = 0UL; d < n; d++) {
+    ncoeffs *= 2UL * range + 1UL;
+  }
+
+  struct candidate_t
+  {
+    double norm;
+    coords_t coords;
+    size_t count;
+  };
+  auto shortest = std::map<unsigned long, candidate_t>{};
+
+  auto coeffs = std::vector<long>(n);
+  auto v = coords_t(n);
+  auto x = std::vector<double>(n);
+  for (auto idx = 0UL; idx < ncoeffs; idx++) {
+    auto rest = idx;
+    auto parity = 0UL;
+    for (auto d = 0UL; d < n; d++) {
+      coeffs[d] = static_cast<long>(rest % (2UL * range + 1UL)) - range;
+      rest /= 2UL * range + 1UL;
+      parity |= static_cast<unsigned long>(coeffs[d] & 1L) << d;
+    }
+    if (parity == 0UL) {
+      continue;
+    }
+
+    std::fill(v.begin(), v.end(), 0L);
+    for (auto d = 0UL; d < n; d++) {
+      for (auto m = 0UL; m < n; m++) {
+        v[m] += coeffs[d] * basis_[d * n + m];
+      }
+    }
+    RealSpace(v, x.data());
+    const auto norm = sum_squared<std::vector<double>, double>(x);
+
+    auto it = shortest.find(parity);
+    if (it == shortest.end()) {
+      shortest.emplace(parity, candidate_t{ norm, v, 1UL });
+    } else if (norm < it->second.norm * (1.0 - Tolerance)) {
+      it->second = candidate_t{ norm, v, 1UL };
+    } else if (norm <= it->second.norm * (1.0 + Tolerance)) {
+      it->second.count++;
+    }
+  }
+
+  for (auto const& [parity, c] : shortest) {
+    static_cast<void>(parity);
+    // only +v and -v
+    if (c.count != 2UL) {
+      continue;
+    }
+    for (auto sign : { 1L, -1L }) {
+      for (auto m = 0UL; m < n; m++) {
+        relevant_.push_back(sign * c.coords[m]);
+      }
+      RealSpace(relevant_.data() + relevant_.size() - n, x.data());
+      relevantreal_.insert(relevantreal_.end(), x.begin(), x.end());
+      relevantnorm_.push_back(c.norm);
+    }
+  }
+}
+
+inline auto
+MinimumImage::GetReducedBasis() const -> std::vector<coords_t>
+{
+  auto result = std::vector<coords_t>{};
+  for (auto d = 0UL; d < dim_; d++) {
+    auto first = basis_.begin() + static_cast<long>(d * dim_);
+    result.emplace_back(first, first + static_cast<long>(dim_));
+  }
+  return result;
+}
+
+template<class C>
+inline auto
+MinimumImage::Reduce(C& coords) const -> void
+{
+  assert(coords.size() == dim_);
+  auto x = std::array<double, Bravais::MaxDim>{};
+  RealSpace(coords, x.data());
+
+  // |x - v|^2 < |x|^2 if and only if 2 x.v > |v|^2
+  auto improved = true;
+  while (improved) {
+    improved = false;
+    for (auto r = 0UL; r < relevantnorm_.size(); r++) {
+      auto const* vr = relevantreal_.data() + r * dim_;
+      auto proj = 0.0;
+      for (auto m = 0UL; m < dim_; m++) {
+        proj += x[m] * vr[m];
+      }
+      if (2.0 * proj > relevantnorm_[r] * (1.0 + Tolerance)) {
+        auto const* vc = relevant_.data() + r * dim_;
+        for (auto m = 0UL; m < dim_; m++) {
+          coords[m] -= vc[m];
+        }
+        RealSpace(coords, x.data());
+        improved = true;
+      }
+    }
+  }
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,285 @@
+//===-- NeighborTable.hpp --------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the NeighborTable Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/Buffer.hpp>
+#include <bwsl/Span.hpp>
+
+// std
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Nearest neighbors of all the sites of a lattice in compressed sparse row
+/// format.
+///
+/// The neighbors of every site are stored contiguously, each one in a
+/// *slot* which also records the direction of the bravais lattice it comes
+/// from. Directions come in pairs, `2 m` and `2 m + 1` are opposite to each
+/// other. When all the sites have the same coordination number, as it
+/// happens with closed boundaries, the slot coincides with the direction, the
+/// offsets of the rows are multiples of the coordination and no table other
+/// than the indices is stored.
+///
+class NeighborTable
+{
+public:
+  /// Type for the site indices
+  using index_t = std::size_t;
+
+  /// Vector of indices
+  using vectorindex_t = std::vector<index_t>;
+
+  /// Type used to store directions and slots
+  using slot_t = std::uint8_t;
+
+  /// Vector of directions or slots
+  using vectorslot_t = std::vector<slot_t>;
+
+  /// View over the neighbors of a site
+  using span_t = Span<index_t const>;
+
+  /// Value returned when a slot does not exist
+  static constexpr index_t NoSlot = std::numeric_limits<index_t>::max();
+
+  /// Default constructor
+  NeighborTable() = default;
+
+  /// Construct the table from the rows of neighbors.
+  /// The neighbors of site `i` are `indices[offsets[i]:offsets[i + 1]]` and
+  /// `directions` holds the direction of each of them, `indices` is moved in
+  /// the table.
+  NeighborTable(vectorindex_t const& offsets,
+                Buffer<index_t> indices,
+                vectorslot_t const& directions);
+
+  /// Construct the table from tables already prepared, for example by
+  /// another table, with the same meaning of the members
+  NeighborTable(size_t numsites,
+                size_t stride,
+                Buffer<index_t> offsets,
+                Buffer<index_t> indices,
+                Buffer<slot_t> directions,
+                Buffer<slot_t> opposite);
+
+  /// Copy constructor
+  NeighborTable(NeighborTable const& that) = default;
+
+  /// Move constructor
+  NeighborTable(NeighborTable&& that) = default;
+
+  /// Copy assignment operator
+  auto operator=(NeighborTable const& that) -> NeighborTable& = default;
+
+  /// Move assignment operator
+  auto operator=(NeighborTable&& that) -> NeighborTable& = default;
+
+  /// Default destructor
+  virtual ~NeighborTable() = default;
+
+  /// Get the number of sites
+  [[nodiscard]] auto GetNumSites() const -> size_t { return numsites_; }
+
+  /// Get the coordination number if uniform, zero otherwise
+  [[nodiscard]] auto GetStride() const -> size_t { return stride_; }
+
+  /// Get the position of the first neighbor of each site, empty with uniform
+  /// coordination
+  [[nodiscard]] auto GetOffsets() const -> Buffer<index_t> const&
+  {
+    return offsets_;
+  }
+
+  /// Get the indices of the neighbors of all the sites
+  [[nodiscard]] auto GetIndices() const -> Buffer<index_t> const&
+  {
+    return indices_;
+  }
+
+  /// Get the directions of all the slots, empty with uniform coordination
+  [[nodiscard]] auto GetDirections() const -> Buffer<slot_t> const&
+  {
+    return directions_;
+  }
+
+  /// Get the opposite of all the slots, empty with uniform coordination
+  [[nodiscard]] auto GetOppositeSlots() const -> Buffer<slot_t> const&
+  {
+    return opposite_;
+  }
+
+  /// Check if all the sites have the same coordination number
+  [[nodiscard]] auto HasUniformCoordination() const -> bool
+  {
+    return stride_ != 0UL || numsites_ == 0UL;
+  }
+
+  /// Get the neighbors of site @p a
+  [[nodiscard]] auto GetNeighbors(index_t a) const -> span_t
+  {
+    return span_t(indices_.data() + GetBegin(a), GetCoordination(a));
+  }
+
+  /// Get the neighbor of site @p a in slot @p slot
+  [[nodiscard]] auto GetNeighbor(index_t a, index_t slot) const -> index_t
+  {
+    assert(slot < GetCoordination(a));
+    return indices_[GetBegin(a) + slot];
+  }
+
+  /// Get the coordination number of site @p a
+  [[nodiscard]] auto GetCoordination(index_t a) const -> index_t
+  {
+    assert(a < numsites_);
+    return stride_ != 0UL ? stride_ : offsets_[a + 1UL] - offsets_[a];
+  }
+
+  /// Get the slot of site @p a where @p b is stored, or NoSlot if they are not
+  /// neighbors. On very small lattices a site can appear in more than one
+  /// slot, in that case the first one is returned.
+  /// The cost is bounded by the coordination number, the row is contiguous.
+  [[nodiscard]] auto GetSlot(index_t a, index_t b) const -> index_t;
+
+  /// Get the slot of site `GetNeighbor(a, slot)` pointing back to @p a along
+  /// the opposite direction.
+  [[nodiscard]] auto GetOppositeSlot(index_t a, index_t slot) const -> index_t
+  {
+    assert(slot < GetCoordination(a));
+    return stride_ != 0UL ? (slot ^ 1UL) : opposite_[GetBegin(a) + slot];
+  }
+
+  /// Get the direction of the bravais lattice of slot @p slot of site @p a
+  [[nodiscard]] auto GetDirection(index_t a, index_t slot) const -> index_t
+  {
+    assert(slot < GetCoordination(a));
+    return stride_ != 0UL ? slot : directions_[GetBegin(a) + slot];
+  }
+
+protected:
+  /// Position of the first neighbor of site @p a
+  [[nodiscard]] auto GetBegin(index_t a) const -> index_t
+  {
+    assert(a < numsites_);
+    return stride_ != 0UL ? a * stride_ : offsets_[a];
+  }
+
+private:
+  /// Number of sites
+  size_t numsites_{ 0UL };
+
+  /// Coordination number if it is the same for every site, zero otherwise
+  size_t stride_{ 0UL };
+
+  /// Position of the first neighbor of each site, only with non uniform
+  /// coordination
+  Buffer<index_t> offsets_{};
+
+  /// Indices of the neighbors
+  Buffer<index_t> indices_{};
+
+  /// Direction of each slot, only with non uniform coordination
+  Buffer<slot_t> directions_{};
+
+  /// Opposite slot of each slot, only with non uniform coordination
+  Buffer<slot_t> opposite_{};
+}; // class NeighborTable
+
+inline NeighborTable::NeighborTable(vectorindex_t const& offsets,
+                                    Buffer<index_t> indices,
+                                    vectorslot_t const& directions)
+  : numsites_(offsets.empty() ? 0UL : offsets.size() - 1UL)
+{
+  assert(directions.size() == indices.size());
+  assert(offsets.empty() || offsets.back() == indices.size());
+
+  // with uniform coordination and the slots ordered as the directions no
+  // other table is needed
+  auto uniform = numsites_ > 0UL && offsets[1] > 0UL;
+  for (auto a = 0UL; a < numsites_ && uniform; a++) {
+    uniform = offsets[a + 1UL] - offsets[a] == offsets[1];
+    for (auto s = offsets[a]; s < offsets[a + 1UL] && uniform; s++) {
+      uniform = static_cast<index_t>(directions[s]) == s - offsets[a];
+    }
+  }
+  if (uniform) {
+    stride_ = offsets[1];
+    indices_ = std::move(indices);
+    return;
+  }
+
+  auto opposite =
+    vectorslot_t(indices.size(), std::numeric_limits<slot_t>::max());
+  for (auto a = 0UL; a < numsites_; a++) {
+    for (auto s = offsets[a]; s < offsets[a + 1UL]; s++) {
+      const auto b = indices[s];
+      const auto back = static_cast<slot_t>(directions[s] ^ 1U);
+      for (auto t = offsets[b]; t < offsets[b + 1UL]; t++) {
+        if (indices[t] == a && directions[t] == back) {
+          opposite[s] = static_cast<slot_t>(t - offsets[b]);
+          break;
+        }
+      }
+      assert(opposite[s] != std::numeric_limits<slot_t>::max());
+    }
+  }
+
+  offsets_ = Buffer<index_t>(offsets);
+  indices_ = std::move(indices);
+  directions_ = Buffer<slot_t>(directions);
+  opposite_ = Buffer<slot_t>(opposite);
+}
+
+inline NeighborTable::NeighborTable(size_t numsites,
+                                    size_t stride,
+                                    Buffer<index_t> offsets,
+                                    Buffer<index_t> indices,
+                                    Buffer<slot_t> directions,
+                                    Buffer<slot_t> opposite)
+  : numsites_(numsites)
+  , stride_(stride)
+  , offsets_(std::move(offsets))
+  , indices_(std::move(indices))
+  , directions_(std::move(directions))
+  , opposite_(std::move(opposite))
+{
+  assert(stride_ != 0UL || offsets_.size() == numsites_ + 1UL);
+  assert(stride_ == 0UL || indices_.size() == numsites_ * stride_);
+  assert(stride_ != 0UL || directions_.size() == indices_.size());
+  assert(stride_ != 0UL || opposite_.size() == indices_.size());
+}
+
+inline auto
+NeighborTable::GetSlot(index_t a, index_t b) const -> index_t
+{
+  const auto first = GetBegin(a);
+  const auto gamma = GetCoordination(a);
+  for (auto s = 0UL; s < gamma; s++) {
+    if (indices_[first + s] == b) {
+      return s;
+    }
+  }
+  return NoSlot;
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
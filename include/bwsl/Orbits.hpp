@@ -0,0 +1,204 @@
+//===-- Orbits.hpp ---------------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the Orbits Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/Span.hpp>
+
+// std
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Partition of a set of elements in the orbits of a group acting on them.
+///
+/// Entries related by the group, such as the correlations of sites related
+/// by a symmetry of the lattice, can be stored once for each orbit. The
+/// orbits are numbered by their smallest element, which represents them.
+///
+class Orbits
+{
+public:
+  /// Type of the elements and of the orbits
+  using index_t = std::size_t;
+
+  /// View over the orbit of every element
+  using span_t = Span<index_t const>;
+
+  /// Default constructor
+  Orbits() = default;
+
+  /// Find the orbits of @p numelements elements under @p numoperations
+  /// operations, where `image(g, i)` is the image of element i under the
+  /// operation g
+  template<class F>
+  Orbits(std::size_t numelements, std::size_t numoperations, F&& image);
+
+  /// Copy constructor
+  Orbits(Orbits const& that) = default;
+
+  /// Move constructor
+  Orbits(Orbits&& that) = default;
+
+  /// Copy assignment operator
+  auto operator=(Orbits const& that) -> Orbits& = default;
+
+  /// Move assignment operator
+  auto operator=(Orbits&& that) -> Orbits& = default;
+
+  /// Default destructor
+  virtual ~Orbits() = default;
+
+  /// Get the number of elements
+  [[nodiscard]] auto GetNumElements() const -> std::size_t
+  {
+    return orbit_.size();
+  }
+
+  /// Get the number of orbits
+  [[nodiscard]] auto GetNumOrbits() const -> std::size_t
+  {
+    return size_.size();
+  }
+
+  /// Get the orbit of element @p i
+  [[nodiscard]] auto GetOrbit(index_t i) const -> index_t
+  {
+    assert(i < orbit_.size());
+    return orbit_[i];
+  }
+
+  /// Get the orbit of all the elements
+  [[nodiscard]] auto GetOrbits() const -> span_t { return span_t(orbit_); }
+
+  /// Get the number of elements in orbit @p k
+  [[nodiscard]] auto GetSize(index_t k) const -> std::size_t
+  {
+    assert(k < size_.size());
+    return size_[k];
+  }
+
+  /// Get the smallest element of orbit @p k
+  [[nodiscard]] auto GetRepresentative(index_t k) const -> index_t
+  {
+    assert(k < representative_.size());
+    return representative_[k];
+  }
+
+  /// Add @p mult times the average over each orbit of @p values , one for
+  /// each element, to @p reduced , one for each orbit
+  template<class T>
+  auto Accumulate(std::vector<T> const& values,
+                  std::vector<double>& reduced,
+                  double mult = 1.0) const -> void;
+
+  /// Get the average over each orbit of @p values , one for each element
+  template<class T>
+  [[nodiscard]] auto Reduce(std::vector<T> const& values) const
+    -> std::vector<double>;
+
+  /// Get the value of each element from the values @p reduced of the orbits
+  [[nodiscard]] auto Expand(std::vector<double> const& reduced) const
+    -> std::vector<double>;
+
+private:
+  /// Orbit of each element
+  std::vector<index_t> orbit_{};
+
+  /// Number of elements of each orbit
+  std::vector<std::size_t> size_{};
+
+  /// Smallest element of each orbit
+  std::vector<index_t> representative_{};
+}; // class Orbits
+
+template<class F>
+inline Orbits::Orbits(std::size_t numelements,
+                      std::size_t numoperations,
+                      F&& image)
+  : orbit_(numelements, std::numeric_limits<index_t>::max())
+{
+  // the elements are visited in order, the first one not yet reached starts
+  // a new orbit which is filled by applying all the operations to its
+  // members until no new element appears
+  auto stack = std::vector<index_t>{};
+  for (auto i = 0UL; i < numelements; i++) {
+    if (orbit_[i] != std::numeric_limits<index_t>::max()) {
+      continue;
+    }
+    const auto k = size_.size();
+    size_.push_back(0UL);
+    representative_.push_back(i);
+    orbit_[i] = k;
+    stack.push_back(i);
+    while (!stack.empty()) {
+      const auto j = stack.back();
+      stack.pop_back();
+      size_[k]++;
+      for (auto g = 0UL; g < numoperations; g++) {
+        const auto m = static_cast<index_t>(image(g, j));
+        assert(m < numelements);
+        if (orbit_[m] == std::numeric_limits<index_t>::max()) {
+          orbit_[m] = k;
+          stack.push_back(m);
+        }
+      }
+    }
+  }
+}
+
+template<class T>
+inline auto
+Orbits::Accumulate(std::vector<T> const& values,
+                   std::vector<double>& reduced,
+                   double mult) const -> void
+{
+  assert(values.size() == GetNumElements());
+  assert(reduced.size() == GetNumOrbits());
+  for (auto i = 0UL; i < values.size(); i++) {
+    const auto k = orbit_[i];
+    reduced[k] +=
+      mult * static_cast<double>(values[i]) / static_cast<double>(size_[k]);
+  }
+}
+
+template<class T>
+inline auto
+Orbits::Reduce(std::vector<T> const& values) const -> std::vector<double>
+{
+  auto reduced = std::vector<double>(GetNumOrbits(), 0.0);
+  Accumulate(values, reduced);
+  return reduced;
+}
+
+inline auto
+Orbits::Expand(std::vector<double> const& reduced) const
+  -> std::vector<double>
+{
+  assert(reduced.size() == GetNumOrbits());
+  auto values = std::vector<double>(GetNumElements());
+  for (auto i = 0UL; i < values.size(); i++) {
+    values[i] = reduced[orbit_[i]];
+  }
+  return values;
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
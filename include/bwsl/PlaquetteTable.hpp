@@ -0,0 +1,175 @@
+//===-- PlaquetteTable.hpp -------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the PlaquetteTable Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/Span.hpp>
+
+// std
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Elementary plaquettes of a lattice, the shortest closed loops of bonds.
+///
+/// The corners of each plaquette are stored in the order of the loop,
+/// starting from the corner which anchors it, together with the bonds going
+/// from each corner to the next one, which are indices of a BondTable. The
+/// plaquettes touching each site are also stored, as needed by local updates
+/// of plaquette terms.
+///
+class PlaquetteTable
+{
+public:
+  /// Type for the site, bond and plaquette indices
+  using index_t = std::size_t;
+
+  /// View over a list of indices
+  using span_t = Span<index_t const>;
+
+  /// Default constructor
+  PlaquetteTable() = default;
+
+  /// Store the plaquettes on @p numsites sites. The corners of plaquette p
+  /// are `corners[offsets[p]:offsets[p + 1]]` and `bonds` holds the bond from
+  /// each corner to the next one.
+  PlaquetteTable(std::size_t numsites,
+                 std::vector<index_t> offsets,
+                 std::vector<index_t> corners,
+                 std::vector<index_t> bonds);
+
+  /// Copy constructor
+  PlaquetteTable(PlaquetteTable const& that) = default;
+
+  /// Move constructor
+  PlaquetteTable(PlaquetteTable&& that) = default;
+
+  /// Copy assignment operator
+  auto operator=(PlaquetteTable const& that) -> PlaquetteTable& = default;
+
+  /// Move assignment operator
+  auto operator=(PlaquetteTable&& that) -> PlaquetteTable& = default;
+
+  /// Default destructor
+  virtual ~PlaquetteTable() = default;
+
+  /// Get the number of sites
+  [[nodiscard]] auto GetNumSites() const -> std::size_t
+  {
+    return siteoffsets_.empty() ? 0UL : siteoffsets_.size() - 1UL;
+  }
+
+  /// Get the number of plaquettes
+  [[nodiscard]] auto GetNumPlaquettes() const -> std::size_t
+  {
+    return offsets_.empty() ? 0UL : offsets_.size() - 1UL;
+  }
+
+  /// Get the number of corners of plaquette @p p
+  [[nodiscard]] auto GetNumCorners(index_t p) const -> std::size_t
+  {
+    assert(p < GetNumPlaquettes());
+    return offsets_[p + 1UL] - offsets_[p];
+  }
+
+  /// Get the corners of plaquette @p p in the order of the loop
+  [[nodiscard]] auto GetCorners(index_t p) const -> span_t
+  {
+    return span_t(corners_.data() + offsets_[p], GetNumCorners(p));
+  }
+
+  /// Get the bonds of plaquette @p p , the bond m joins the corners m and
+  /// m + 1
+  [[nodiscard]] auto GetBonds(index_t p) const -> span_t
+  {
+    return span_t(bonds_.data() + offsets_[p], GetNumCorners(p));
+  }
+
+  /// Get the plaquettes having site @p a among their corners
+  [[nodiscard]] auto GetPlaquettes(index_t a) const -> span_t
+  {
+    assert(a < GetNumSites());
+    return span_t(plaquettes_.data() + siteoffsets_[a],
+                  siteoffsets_[a + 1UL] - siteoffsets_[a]);
+  }
+
+private:
+  /// Position of the first corner of each plaquette, and the end
+  std::vector<index_t> offsets_{};
+
+  /// Corners of all the plaquettes
+  std::vector<index_t> corners_{};
+
+  /// Bonds of all the plaquettes
+  std::vector<index_t> bonds_{};
+
+  /// Position in plaquettes_ of the first plaquette of each site, and the end
+  std::vector<index_t> siteoffsets_{};
+
+  /// Plaquettes touching each site
+  std::vector<index_t> plaquettes_{};
+}; // class PlaquetteTable
+
+inline PlaquetteTable::PlaquetteTable(std::size_t numsites,
+                                      std::vector<index_t> offsets,
+                                      std::vector<index_t> corners,
+                                      std::vector<index_t> bonds)
+  : offsets_(std::move(offsets))
+  , corners_(std::move(corners))
+  , bonds_(std::move(bonds))
+{
+  assert(!offsets_.empty() && offsets_.back() == corners_.size());
+  assert(bonds_.size() == corners_.size());
+
+  // a site appearing twice in a plaquette, on very small lattices, lists it
+  // only once
+  siteoffsets_.assign(numsites + 1UL, 0UL);
+  auto touches = [&](index_t p, index_t m) {
+    for (auto l = offsets_[p]; l < m; l++) {
+      if (corners_[l] == corners_[m]) {
+        return false;
+      }
+    }
+    return true;
+  };
+  for (auto p = 0UL; p < GetNumPlaquettes(); p++) {
+    for (auto m = offsets_[p]; m < offsets_[p + 1UL]; m++) {
+      if (touches(p, m)) {
+        siteoffsets_[corners_[m] + 1UL]++;
+      }
+    }
+  }
+  for (auto a = 0UL; a < numsites; a++) {
+    siteoffsets_[a + 1UL] += siteoffsets_[a];
+  }
+  plaquettes_.resize(siteoffsets_.back());
+  auto next =
+    std::vector<index_t>(siteoffsets_.begin(), siteoffsets_.end() - 1);
+  for (auto p = 0UL; p < GetNumPlaquettes(); p++) {
+    for (auto m = offsets_[p]; m < offsets_[p + 1UL]; m++) {
+      if (touches(p, m)) {
+        plaquettes_[next[corners_[m]]++] = p;
+      }
+    }
+  }
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,372 @@
+//===-- SharedSegment.hpp --------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the SharedSegment Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// posix
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+
+// std
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace bwsl {
+
+///
+/// Named POSIX shared memory segment written once by the process creating it
+/// and then read by any number of processes.
+///
+/// The segment starts with a small control block holding the state and the
+/// process id of the creator, followed by the payload. The creator fills the
+/// payload and calls Publish, the other processes Attach to the segment and
+/// wait until it is published. If the creator dies before publishing the
+/// segment is reported as stale, so that it can be removed and created again.
+/// A creator dying before writing its process id in the control block is
+/// noticed when the control block is still missing or unowned CreationGrace
+/// seconds after the last change of the segment.
+///
+class SharedSegment
+{
+public:
+  /// State of a segment as seen by Attach
+  enum class State
+  {
+    /// No segment with the name
+    Missing,
+    /// Still being written by a living process
+    Building,
+    /// Published, the payload can be read
+    Ready,
+    /// Abandoned by its creator before being published
+    Stale,
+  };
+
+  /// Size of the control block before the payload, it keeps the payload
+  /// aligned to a cache line
+  static constexpr std::size_t ControlSize = 64UL;
+
+  /// Seconds after which a segment without a complete control block is
+  /// considered abandoned, its creator fills it right after creating it
+  static constexpr double CreationGrace = 1.0;
+
+  /// Default constructor, maps nothing
+  SharedSegment() = default;
+
+  /// Copy constructor
+  SharedSegment(SharedSegment const& that) = delete;
+
+  /// Move constructor
+  SharedSegment(SharedSegment&& that) noexcept
+    : data_(std::exchange(that.data_, nullptr))
+    , size_(std::exchange(that.size_, 0UL))
+    , fd_(std::exchange(that.fd_, -1))
+  {
+  }
+
+  /// Copy assignment operator
+  auto operator=(SharedSegment const& that) -> SharedSegment& = delete;
+
+  /// Move assignment operator
+  auto operator=(SharedSegment&& that) noexcept -> SharedSegment&
+  {
+    std::swap(data_, that.data_);
+    std::swap(size_, that.size_);
+    std::swap(fd_, that.fd_);
+    return *this;
+  }
+
+  /// Destructor, removes the mapping but not the segment
+  virtual ~SharedSegment()
+  {
+    if (data_ != nullptr) {
+      ::munmap(data_, size_);
+    }
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+  }
+
+  /// Create the segment @p name , with an empty payload, unless it already
+  /// exists, in which case nullptr is returned. Throw std::runtime_error on
+  /// any other failure.
+  [[nodiscard]] static auto Create(std::string const& name)
+    -> std::shared_ptr<SharedSegment>;
+
+  /// Create the segment @p name and publish it once `fill(segment)` has
+  /// written the payload, unless it already exists, in which case nullptr
+  /// is returned. If `fill` throws, whatever the exception, the segment is
+  /// removed before rethrowing, so that the other processes do not wait for
+  /// a segment which will never be published.
+  template<class F>
+  [[nodiscard]] static auto CreateAndPublish(std::string const& name, F&& fill)
+    -> std::shared_ptr<SharedSegment>;
+
+  /// Attach to the segment @p name waiting at most @p timeout seconds for
+  /// it to be published. The segment is returned only in the Ready state.
+  [[nodiscard]] static auto Attach(std::string const& name, double timeout)
+    -> std::pair<State, std::shared_ptr<SharedSegment const>>;
+
+  /// Remove the name of the segment, the processes attached to it keep their
+  /// mappings. Return false if the segment does not exist.
+  static auto Remove(std::string const& name) -> bool
+  {
+    return ::shm_unlink(name.c_str()) == 0;
+  }
+
+  /// Set the size of the payload of a created segment, its content is lost.
+  /// The pages are reserved, so that writing the payload cannot fail later,
+  /// and std::runtime_error is thrown if there is not enough space.
+  auto Allocate(std::size_t size) -> void;
+
+  /// Make the payload visible to the other processes, it must not be
+  /// modified anymore
+  auto Publish() -> void
+  {
+    assert(fd_ >= 0 && "only the creator can publish");
+    GetStateWord()->store(static_cast<std::uint64_t>(State::Ready),
+                          std::memory_order_release);
+  }
+
+  /// Get the first byte of the payload
+  [[nodiscard]] auto GetPayload() -> void*
+  {
+    return static_cast<char*>(data_) + ControlSize;
+  }
+
+  /// Get the first byte of the payload
+  [[nodiscard]] auto GetPayload() const -> void const*
+  {
+    return static_cast<char const*>(data_) + ControlSize;
+  }
+
+  /// Get the size of the payload in bytes
+  [[nodiscard]] auto GetPayloadSize() const -> std::size_t
+  {
+    return size_ - ControlSize;
+  }
+
+protected:
+  /// Word holding the state in the control block
+  [[nodiscard]] auto GetStateWord() const -> std::atomic<std::uint64_t>*
+  {
+    return static_cast<std::atomic<std::uint64_t>*>(data_);
+  }
+
+  /// Word holding the process id of the creator in the control block
+  [[nodiscard]] auto GetOwnerWord() const -> std::uint64_t*
+  {
+    return static_cast<std::uint64_t*>(data_) + 1UL;
+  }
+
+  /// Map @p size bytes of the segment open in @p fd
+  auto Map(int fd, std::size_t size, bool writable) -> void;
+
+private:
+  /// Mapped memory, control block included
+  void* data_{ nullptr };
+
+  /// Size of the mapping
+  std::size_t size_{ 0UL };
+
+  /// Descriptor of the segment, kept open only by the creator
+  int fd_{ -1 };
+}; // class SharedSegment
+
+inline auto
+SharedSegment::Map(int fd, std::size_t size, bool writable) -> void
+{
+  if (data_ != nullptr) {
+    ::munmap(data_, size_);
+    data_ = nullptr;
+  }
+  const auto prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+  auto* data = ::mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error(std::string("cannot map shared memory: ") +
+                             std::strerror(errno));
+  }
+  data_ = data;
+  size_ = size;
+}
+
+inline auto
+SharedSegment::Create(std::string const& name)
+  -> std::shared_ptr<SharedSegment>
+{
+  const auto fd =
+    ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+  if (fd < 0 && errno == EEXIST) {
+    return nullptr;
+  }
+  if (fd < 0) {
+    throw std::runtime_error("cannot create shared memory " + name + ": " +
+                             std::strerror(errno));
+  }
+
+  auto segment = std::make_shared<SharedSegment>();
+  segment->fd_ = fd;
+  try {
+    if (::ftruncate(fd, static_cast<off_t>(ControlSize)) != 0) {
+      throw std::runtime_error("cannot resize shared memory " + name + ": " +
+                               std::strerror(errno));
+    }
+    segment->Map(fd, ControlSize, true);
+  } catch (...) {
+    ::shm_unlink(name.c_str());
+    throw;
+  }
+  new (segment->data_) std::atomic<std::uint64_t>(
+    static_cast<std::uint64_t>(State::Building));
+  *segment->GetOwnerWord() = static_cast<std::uint64_t>(::getpid());
+  return segment;
+}
+
+template<class F>
+inline auto
+SharedSegment::CreateAndPublish(std::string const& name, F&& fill)
+  -> std::shared_ptr<SharedSegment>
+{
+  auto segment = Create(name);
+  if (segment == nullptr) {
+    return nullptr;
+  }
+  try {
+    fill(*segment);
+  } catch (...) {
+    Remove(name);
+    throw;
+  }
+  segment->Publish();
+  return segment;
+}
+
+inline auto
+SharedSegment::Allocate(std::size_t size) -> void
+{
+  assert(fd_ >= 0 && "only the creator can allocate");
+  auto fail = [](int error) {
+    throw std::runtime_error(std::string("cannot resize shared memory: ") +
+                             std::strerror(error));
+  };
+
+  // on tmpfs resizing does not reserve any page, writing to the mapping of
+  // a full file system raises SIGBUS. Segments which clearly do not fit are
+  // rejected before reserving anything.
+  struct statvfs fs = {};
+  if (::fstatvfs(fd_, &fs) == 0 && fs.f_blocks != 0UL &&
+      size > static_cast<std::size_t>(fs.f_bavail) * fs.f_frsize) {
+    fail(ENOSPC);
+  }
+  const auto total = static_cast<off_t>(ControlSize + size);
+  if (::ftruncate(fd_, total) != 0) {
+    fail(errno);
+  }
+  if (const auto error = ::posix_fallocate(fd_, 0, total); error != 0) {
+    fail(error);
+  }
+  Map(fd_, ControlSize + size, true);
+}
+
+inline auto
+SharedSegment::Attach(std::string const& name, double timeout)
+  -> std::pair<State, std::shared_ptr<SharedSegment const>>
+{
+  const auto fd = ::shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+  if (fd < 0) {
+    return { State::Missing, nullptr };
+  }
+
+  auto segment = std::make_shared<SharedSegment>();
+  const auto deadline =
+    std::chrono::steady_clock::now() + std::chrono::duration<double>(timeout);
+  auto state = State::Building;
+  try {
+    for (;;) {
+      struct stat st = {};
+      if (::fstat(fd, &st) != 0) {
+        throw std::runtime_error("cannot stat shared memory " + name);
+      }
+      const auto size = static_cast<std::size_t>(st.st_size);
+
+      // the creator sets the size of the control block right after creating
+      // the segment, and the final size before publishing it. A control
+      // block missing or without owner for long means that the creator died
+      // while setting it up.
+      const auto changed = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+          std::chrono::seconds(st.st_ctim.tv_sec) +
+          std::chrono::nanoseconds(st.st_ctim.tv_nsec)));
+      const auto abandoned =
+        std::chrono::system_clock::now() - changed >
+        std::chrono::duration<double>(CreationGrace);
+      if (size < ControlSize && abandoned) {
+        state = State::Stale;
+        break;
+      }
+      if (size >= ControlSize) {
+        segment->Map(fd, size, false);
+        const auto word =
+          segment->GetStateWord()->load(std::memory_order_acquire);
+        if (word == static_cast<std::uint64_t>(State::Ready)) {
+          struct stat now = {};
+          if (::fstat(fd, &now) == 0 && now.st_size != st.st_size) {
+            segment->Map(fd, static_cast<std::size_t>(now.st_size), false);
+          }
+          state = State::Ready;
+          break;
+        }
+        const auto owner = static_cast<pid_t>(*segment->GetOwnerWord());
+        if (owner == 0 ? abandoned
+                       : ::kill(owner, 0) != 0 && errno == ESRCH) {
+          state = State::Stale;
+          break;
+        }
+      }
+
+      if (std::chrono::steady_clock::now() >= deadline) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  } catch (...) {
+    ::close(fd);
+    throw;
+  }
+  ::close(fd);
+
+  if (state != State::Ready) {
+    return { state, nullptr };
+  }
+  return { state, segment };
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
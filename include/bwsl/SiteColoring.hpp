@@ -0,0 +1,268 @@
+//===-- SiteColoring.hpp ---------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the SiteColoring Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/NeighborTable.hpp>
+#include <bwsl/Span.hpp>
+#include <bwsl/ThreadPool.hpp>
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Coloring of the sites of a lattice such that neighbors have different
+/// colors.
+///
+/// The sites of one color share no bond, therefore local updates which read
+/// the neighbors of a site and write only the site itself can be applied to
+/// all of them at the same time. The sites of each color are stored
+/// contiguously in increasing order, so that a sweep over one color is a
+/// loop over a plain array.
+///
+/// A site neighbor of itself, as it happens along the directions of size
+/// one, is ignored: updating it never races with another site.
+///
+class SiteColoring
+{
+public:
+  /// Type for the site indices
+  using index_t = std::size_t;
+
+  /// Type of the colors
+  using color_t = std::uint32_t;
+
+  /// View over a list of sites
+  using span_t = Span<index_t const>;
+
+  /// View over the colors of all the sites
+  using colorspan_t = Span<color_t const>;
+
+  /// Default constructor
+  SiteColoring() = default;
+
+  /// Group the sites by their colors @p colors , one for each site
+  explicit SiteColoring(std::vector<color_t> colors);
+
+  /// Copy constructor
+  SiteColoring(SiteColoring const& that) = default;
+
+  /// Move constructor
+  SiteColoring(SiteColoring&& that) = default;
+
+  /// Copy assignment operator
+  auto operator=(SiteColoring const& that) -> SiteColoring& = default;
+
+  /// Move assignment operator
+  auto operator=(SiteColoring&& that) -> SiteColoring& = default;
+
+  /// Default destructor
+  virtual ~SiteColoring() = default;
+
+  /// Color the sites of @p table with the DSatur heuristic, which picks at
+  /// each step the site with the most distinct colors among its neighbors.
+  /// It is exact for bipartite neighbor sets and uses few colors otherwise.
+  /// Any table with the GetNumSites, GetCoordination and GetNeighbors
+  /// methods of NeighborTable can be colored.
+  template<class Table>
+  [[nodiscard]] static auto FromNeighbors(Table const& table) -> SiteColoring;
+
+  /// Get the number of sites
+  [[nodiscard]] auto GetNumSites() const -> std::size_t
+  {
+    return color_.size();
+  }
+
+  /// Get the number of colors
+  [[nodiscard]] auto GetNumColors() const -> std::size_t
+  {
+    return offsets_.empty() ? 0UL : offsets_.size() - 1UL;
+  }
+
+  /// Get the color of site @p i
+  [[nodiscard]] auto GetColor(index_t i) const -> color_t
+  {
+    assert(i < color_.size());
+    return color_[i];
+  }
+
+  /// Get the colors of all the sites
+  [[nodiscard]] auto GetColors() const -> colorspan_t
+  {
+    return colorspan_t(color_);
+  }
+
+  /// Get the number of sites of color @p c
+  [[nodiscard]] auto GetSize(color_t c) const -> std::size_t
+  {
+    assert(c < GetNumColors());
+    return offsets_[c + 1UL] - offsets_[c];
+  }
+
+  /// Get the sites of color @p c in increasing order
+  [[nodiscard]] auto GetSites(color_t c) const -> span_t
+  {
+    assert(c < GetNumColors());
+    return span_t(sites_.data() + offsets_[c], GetSize(c));
+  }
+
+  /// Check if no pair of distinct neighbors in @p table has the same color
+  template<class Table>
+  [[nodiscard]] auto IsProper(Table const& table) const -> bool;
+
+  /// Call `update(i)` for all the sites, one color after the other. The
+  /// sites of a color are updated in parallel by @p pool , hence @p update
+  /// may read the neighbors of i but must write only the state of i. The
+  /// random numbers should come from a stream owned by each site, or be
+  /// derived from the site and the sweep, for the results not to depend on
+  /// the number of threads. Called from the body of another parallel loop
+  /// of the pool, for example from TileDecomposition::Run, the colors are
+  /// swept serially.
+  template<class F>
+  auto Sweep(ThreadPool& pool, F&& update, std::size_t grain = 0UL) const
+    -> void;
+
+private:
+  /// Color of each site
+  std::vector<color_t> color_{};
+
+  /// Position in sites_ of the first site of each color, and the end
+  std::vector<index_t> offsets_{};
+
+  /// Sites sorted by color
+  std::vector<index_t> sites_{};
+}; // class SiteColoring
+
+inline SiteColoring::SiteColoring(std::vector<color_t> colors)
+  : color_(std::move(colors))
+{
+  const auto numcolors =
+    color_.empty()
+      ? 0UL
+      : static_cast<std::size_t>(
+          *std::max_element(color_.begin(), color_.end())) +
+          1UL;
+
+  // counting sort keeps the sites of each color in increasing order
+  offsets_.assign(numcolors + 1UL, 0UL);
+  for (auto c : color_) {
+    offsets_[c + 1UL]++;
+  }
+  for (auto c = 0UL; c < numcolors; c++) {
+    offsets_[c + 1UL] += offsets_[c];
+  }
+  sites_.resize(color_.size());
+  auto next = std::vector<index_t>(offsets_.begin(), offsets_.end() - 1);
+  for (auto i = 0UL; i < color_.size(); i++) {
+    sites_[next[color_[i]]++] = i;
+  }
+}
+
+template<class Table>
+inline auto
+SiteColoring::FromNeighbors(Table const& table) -> SiteColoring
+{
+  const auto n = table.GetNumSites();
+  auto maxdegree = 0UL;
+  for (auto i = 0UL; i < n; i++) {
+    maxdegree = std::max(maxdegree, table.GetCoordination(i));
+  }
+
+  // colors seen among the neighbors of each site, as bit masks, at most one
+  // more color than the coordination is ever needed
+  const auto words = (maxdegree + 1UL + 63UL) / 64UL;
+  auto seen = std::vector<std::uint64_t>(n * words, 0UL);
+  auto saturation = std::vector<std::size_t>(n, 0UL);
+  constexpr auto none = ~color_t{ 0U };
+  auto colors = std::vector<color_t>(n, none);
+
+  // sites ordered by saturation, then by degree, then by index
+  using key_t = std::pair<std::pair<std::size_t, std::size_t>, index_t>;
+  auto key = [&](index_t i) {
+    return key_t{ { saturation[i], table.GetCoordination(i) }, n - i };
+  };
+  auto queue = std::set<key_t>{};
+  for (auto i = 0UL; i < n; i++) {
+    queue.insert(key(i));
+  }
+
+  while (!queue.empty()) {
+    const auto i = n - std::prev(queue.end())->second;
+    queue.erase(std::prev(queue.end()));
+
+    auto c = 0UL;
+    while ((seen[i * words + c / 64UL] >> (c % 64UL)) & 1UL) {
+      c++;
+    }
+    colors[i] = static_cast<color_t>(c);
+
+    for (auto j : table.GetNeighbors(i)) {
+      auto& word = seen[j * words + c / 64UL];
+      const auto bit = std::uint64_t{ 1UL } << (c % 64UL);
+      if (j == i || colors[j] != none || (word & bit) != 0UL) {
+        continue;
+      }
+      queue.erase(key(j));
+      word |= bit;
+      saturation[j]++;
+      queue.insert(key(j));
+    }
+  }
+  return SiteColoring(std::move(colors));
+}
+
+template<class Table>
+inline auto
+SiteColoring::IsProper(Table const& table) const -> bool
+{
+  if (table.GetNumSites() != GetNumSites()) {
+    return false;
+  }
+  for (auto i = 0UL; i < GetNumSites(); i++) {
+    for (auto j : table.GetNeighbors(i)) {
+      if (j != i && color_[j] == color_[i]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template<class F>
+inline auto
+SiteColoring::Sweep(ThreadPool& pool, F&& update, std::size_t grain) const
+  -> void
+{
+  for (auto c = 0UL; c < GetNumColors(); c++) {
+    const auto* sites = sites_.data() + offsets_[c];
+    pool.ParallelFor(
+      0UL,
+      offsets_[c + 1UL] - offsets_[c],
+      [&](std::size_t k) { update(sites[k]); },
+      grain);
+  }
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
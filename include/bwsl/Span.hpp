@@ -0,0 +1,129 @@
+//===-- Span.hpp -----------------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the Span Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// std
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace bwsl {
+
+///
+/// Non owning view over a contiguous sequence of elements.
+/// It is a minimal replacement for std::span which is not available in C++17.
+///
+template<class T>
+class Span
+{
+public:
+  using element_type = T;
+  using value_type = std::remove_cv_t<T>;
+  using size_type = std::size_t;
+  using pointer = T*;
+  using reference = T&;
+  using iterator = T*;
+
+  /// Default constructor
+  constexpr Span() noexcept = default;
+
+  /// Construct a span over @p size elements starting at @p data
+  constexpr Span(pointer data, size_type size) noexcept
+    : data_(data)
+    , size_(size)
+  {
+  }
+
+  /// Construct a span over a contiguous container
+  template<class Container,
+           class = decltype(std::declval<Container&>().data()),
+           class = decltype(std::declval<Container&>().size())>
+  constexpr Span(Container& c) noexcept // NOLINT(google-explicit-constructor)
+    : data_(c.data())
+    , size_(c.size())
+  {
+  }
+
+  /// Get the pointer to the first element
+  [[nodiscard]] constexpr auto data() const noexcept -> pointer
+  {
+    return data_;
+  }
+
+  /// Get the number of elements
+  [[nodiscard]] constexpr auto size() const noexcept -> size_type
+  {
+    return size_;
+  }
+
+  /// Check if the span is empty
+  [[nodiscard]] constexpr auto empty() const noexcept -> bool
+  {
+    return size_ == 0UL;
+  }
+
+  /// Access an element
+  [[nodiscard]] constexpr auto operator[](size_type i) const -> reference
+  {
+    assert(i < size_);
+    return data_[i];
+  }
+
+  /// Get the first element
+  [[nodiscard]] constexpr auto front() const -> reference
+  {
+    assert(!empty());
+    return data_[0];
+  }
+
+  /// Get the last element
+  [[nodiscard]] constexpr auto back() const -> reference
+  {
+    assert(!empty());
+    return data_[size_ - 1UL];
+  }
+
+  /// Iterator to the first element
+  [[nodiscard]] constexpr auto begin() const noexcept -> iterator
+  {
+    return data_;
+  }
+
+  /// Iterator past the last element
+  [[nodiscard]] constexpr auto end() const noexcept -> iterator
+  {
+    return data_ + size_;
+  }
+
+  /// Get a view over @p count elements starting at @p offset
+  [[nodiscard]] constexpr auto subspan(size_type offset, size_type count) const
+    -> Span
+  {
+    assert(offset + count <= size_);
+    return Span(data_ + offset, count);
+  }
+
+private:
+  /// Pointer to the first element
+  pointer data_{ nullptr };
+
+  /// Number of elements
+  size_type size_{ 0UL };
+}; // class Span
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
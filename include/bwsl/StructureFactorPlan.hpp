@@ -0,0 +1,263 @@
+//===-- StructureFactorPlan.hpp --------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the StructureFactorPlan Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/AlignedAllocator.hpp>
+#include <bwsl/Lattice.hpp>
+#include <bwsl/MathUtils.hpp>
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Precomputed phases for the evaluation of the structure factor on a subset
+/// of the momenta of a Lattice.
+///
+/// The phases cos(k.x) and sin(k.x) are computed once and stored in two
+/// aligned row-major tables (one row for each momentum). The structure factor
+/// of a batch of snapshots is then evaluated as a blocked matrix product
+/// whose innermost loop runs over the snapshots and is vectorized.
+///
+class StructureFactorPlan
+{
+public:
+  /// Type for the site and momenta indices
+  using index_t = Lattice::index_t;
+
+  /// Shorthand for real valued vectors
+  using realvec_t = Lattice::realvec_t;
+
+  /// Default constructor
+  StructureFactorPlan() = default;
+
+  /// Construct a plan for all the momenta of the lattice
+  template<std::size_t D>
+  explicit StructureFactorPlan(BasicLattice<D> const& lattice);
+
+  /// Construct a plan for the given momenta of the lattice
+  template<std::size_t D>
+  StructureFactorPlan(BasicLattice<D> const& lattice,
+                      std::vector<index_t> momenta);
+
+  /// Copy constructor
+  StructureFactorPlan(StructureFactorPlan const& that) = default;
+
+  /// Move constructor
+  StructureFactorPlan(StructureFactorPlan&& that) = default;
+
+  /// Copy assignment operator
+  auto operator=(StructureFactorPlan const& that)
+    -> StructureFactorPlan& = default;
+
+  /// Move assignment operator
+  auto operator=(StructureFactorPlan&& that) -> StructureFactorPlan& = default;
+
+  /// Default destructor
+  virtual ~StructureFactorPlan() = default;
+
+  /// Get the number of momenta in the plan
+  [[nodiscard]] auto GetNumMomenta() const -> size_t { return momenta_.size(); }
+
+  /// Get the number of sites of the lattice
+  [[nodiscard]] auto GetNumSites() const -> size_t { return numsites_; }
+
+  /// Get the indices in the lattice of the momenta of the plan
+  [[nodiscard]] auto GetMomenta() const -> std::vector<index_t> const&
+  {
+    return momenta_;
+  }
+
+  /// Accumulate in @p sk the structure factor of every snapshot.
+  /// The element `sk[i]` corresponds to the momentum `GetMomenta()[i]`.
+  template<class T>
+  auto Accumulate(std::vector<std::vector<T>> const& snapshots,
+                  realvec_t& sk,
+                  double mult = 1.0) const -> void;
+
+  /// Compute the structure factor of each snapshot
+  template<class T>
+  [[nodiscard]] auto Compute(std::vector<std::vector<T>> const& snapshots,
+                             double mult = 1.0) const
+    -> std::vector<realvec_t>;
+
+protected:
+  /// Number of snapshots processed together
+  static constexpr size_t BatchSize = 64UL;
+
+  /// Number of sites in a block of the product
+  static constexpr size_t SiteBlock = 64UL;
+
+  /// Number of momenta in a block of the product
+  static constexpr size_t MomentaBlock = 16UL;
+
+  /// Compute the structure factor of all the snapshots and call @p f with
+  /// the momentum index, the snapshot index and the value found.
+  template<class T, class F>
+  auto Evaluate(std::vector<std::vector<T>> const& snapshots,
+                double mult,
+                F&& f) const -> void;
+
+private:
+  /// Number of sites of the lattice
+  size_t numsites_{ 0UL };
+
+  /// Indices of the momenta
+  std::vector<index_t> momenta_{};
+
+  /// Table with cos(k.x), one row of `numsites_` elements for each momentum
+  aligned_vector<double> cos_{};
+
+  /// Table with sin(k.x), one row of `numsites_` elements for each momentum
+  aligned_vector<double> sin_{};
+}; // class StructureFactorPlan
+
+template<std::size_t D>
+inline StructureFactorPlan::StructureFactorPlan(
+  BasicLattice<D> const& lattice)
+  : StructureFactorPlan(lattice, [&lattice]() {
+    auto m = std::vector<index_t>(lattice.HasOpenBoundaries()
+                                    ? 0UL
+                                    : lattice.GetNumSites());
+    std::iota(m.begin(), m.end(), 0UL);
+    return m;
+  }())
+{
+}
+
+template<std::size_t D>
+inline StructureFactorPlan::StructureFactorPlan(BasicLattice<D> const& lattice,
+                                                std::vector<index_t> momenta)
+  : numsites_(lattice.GetNumSites())
+  , momenta_(std::move(momenta))
+  , cos_(momenta_.size() * numsites_)
+  , sin_(momenta_.size() * numsites_)
+{
+  assert(momenta_.empty() || lattice.HasClosedBoundaries());
+
+  auto vectors = std::vector<typename BasicLattice<D>::realvec_t>{};
+  for (auto j = 0UL; j < numsites_; j++) {
+    vectors.push_back(lattice.GetVector(0UL, j));
+  }
+
+  for (auto i = 0UL; i < momenta_.size(); i++) {
+    assert(lattice.IndexIsValid(momenta_[i]));
+    auto const k = lattice.GetMomentum(momenta_[i]);
+    for (auto j = 0UL; j < numsites_; j++) {
+      auto prod = 0.0;
+      for (auto q = 0UL; q < k.size(); q++) {
+        prod += k[q] * vectors[j][q];
+      }
+      cos_[i * numsites_ + j] = std::cos(prod);
+      sin_[i * numsites_ + j] = std::sin(prod);
+    }
+  }
+}
+
+template<class T, class F>
+inline auto
+StructureFactorPlan::Evaluate(std::vector<std::vector<T>> const& snapshots,
+                              double mult,
+                              F&& f) const -> void
+{
+  const auto nk = GetNumMomenta();
+  const auto n = numsites_;
+  const auto norm = mult / static_cast<double>(square(n));
+
+  // occupations transposed: one row of `BatchSize` snapshots for each site
+  auto occ = aligned_vector<double>(n * BatchSize);
+  auto re = aligned_vector<double>(nk * BatchSize);
+  auto im = aligned_vector<double>(nk * BatchSize);
+
+  for (auto first = 0UL; first < snapshots.size(); first += BatchSize) {
+    const auto count = std::min(BatchSize, snapshots.size() - first);
+
+    std::fill(occ.begin(), occ.end(), 0.0);
+    for (auto s = 0UL; s < count; s++) {
+      auto const& snapshot = snapshots[first + s];
+      assert(snapshot.size() == n);
+      for (auto j = 0UL; j < n; j++) {
+        occ[j * BatchSize + s] = static_cast<double>(snapshot[j]);
+      }
+    }
+    std::fill(re.begin(), re.end(), 0.0);
+    std::fill(im.begin(), im.end(), 0.0);
+
+    // blocked product (nk x n) * (n x BatchSize)
+    for (auto k0 = 0UL; k0 < nk; k0 += MomentaBlock) {
+      const auto k1 = std::min(k0 + MomentaBlock, nk);
+      for (auto j0 = 0UL; j0 < n; j0 += SiteBlock) {
+        const auto j1 = std::min(j0 + SiteBlock, n);
+        for (auto k = k0; k < k1; k++) {
+          double const* __restrict crow = cos_.data() + k * n;
+          double const* __restrict srow = sin_.data() + k * n;
+          double* __restrict rek = re.data() + k * BatchSize;
+          double* __restrict imk = im.data() + k * BatchSize;
+          for (auto j = j0; j < j1; j++) {
+            const auto c = crow[j];
+            const auto sn = srow[j];
+            double const* __restrict occj = occ.data() + j * BatchSize;
+            for (auto s = 0UL; s < BatchSize; s++) {
+              rek[s] += c * occj[s];
+              imk[s] += sn * occj[s];
+            }
+          }
+        }
+      }
+    }
+
+    for (auto k = 0UL; k < nk; k++) {
+      for (auto s = 0UL; s < count; s++) {
+        auto idx = k * BatchSize + s;
+        f(k, first + s, norm * (square(re[idx]) + square(im[idx])));
+      }
+    }
+  }
+}
+
+template<class T>
+inline auto
+StructureFactorPlan::Accumulate(std::vector<std::vector<T>> const& snapshots,
+                                realvec_t& sk,
+                                double mult) const -> void
+{
+  assert(sk.size() == GetNumMomenta());
+  Evaluate(snapshots, mult, [&sk](size_t k, size_t /*s*/, double v) {
+    sk[k] += v;
+  });
+}
+
+template<class T>
+inline auto
+StructureFactorPlan::Compute(std::vector<std::vector<T>> const& snapshots,
+                             double mult) const -> std::vector<realvec_t>
+{
+  auto result = std::vector<realvec_t>(snapshots.size(),
+                                       realvec_t(GetNumMomenta(), 0.0));
+  Evaluate(snapshots, mult, [&result](size_t k, size_t s, double v) {
+    result[s][k] = v;
+  });
+  return result;
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,265 @@
+//===-- StructureFactorTracker.hpp -----------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the StructureFactorTracker Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/FFT.hpp>
+#include <bwsl/HyperCubicGrid.hpp>
+#include <bwsl/Lattice.hpp>
+#include <bwsl/MathUtils.hpp>
+
+// std
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Keep track of the Fourier components of the density
+///
+///   rho(k) = sum_x n_x exp(i k.x)
+///
+/// for all the momenta of a Lattice with closed boundaries, updating them
+/// when the occupation of a site changes.
+///
+/// In lattice coordinates the phase factorizes over the dimensions,
+/// exp(i k.x) = prod_d exp(2 pi i q_d x_d / L_d), therefore an update
+/// costs O(N_k) multiplications and only needs a table of L_d phases for
+/// each dimension.
+///
+class StructureFactorTracker
+{
+public:
+  /// Type of the complex numbers
+  using complex_t = std::complex<double>;
+
+  /// Type for the site indices
+  using index_t = Lattice::index_t;
+
+  /// Shorthand for real valued vectors
+  using realvec_t = Lattice::realvec_t;
+
+  /// Default constructor
+  StructureFactorTracker() = default;
+
+  /// Construct a tracker for the lattice, initially with all the sites empty
+  template<std::size_t D>
+  explicit StructureFactorTracker(BasicLattice<D> const& lattice);
+
+  /// Copy constructor
+  StructureFactorTracker(StructureFactorTracker const& that) = default;
+
+  /// Move constructor
+  StructureFactorTracker(StructureFactorTracker&& that) = default;
+
+  /// Copy assignment operator
+  auto operator=(StructureFactorTracker const& that)
+    -> StructureFactorTracker& = default;
+
+  /// Move assignment operator
+  auto operator=(StructureFactorTracker&& that)
+    -> StructureFactorTracker& = default;
+
+  /// Default destructor
+  virtual ~StructureFactorTracker() = default;
+
+  /// Get the number of momenta tracked
+  [[nodiscard]] auto GetNumMomenta() const -> size_t { return rho_.size(); }
+
+  /// Recompute all the Fourier components from the occupations, O(N log N).
+  /// It can also be used periodically to remove the accumulated rounding.
+  template<class T>
+  auto Reset(std::vector<T> const& occupations) -> void;
+
+  /// Change the occupation of site @p site by @p delta
+  auto Update(index_t site, double delta) -> void;
+
+  /// Move @p amount particles from site @p from to site @p to
+  auto Move(index_t from, index_t to, double amount = 1.0) -> void;
+
+  /// Get the Fourier component for the momentum @p k
+  [[nodiscard]] auto GetRho(index_t k) const -> complex_t
+  {
+    return rho_[grid_.GetRowMajorIndex(k)];
+  }
+
+  /// Get the structure factor for the momentum @p k
+  [[nodiscard]] auto GetSk(index_t k) const -> double;
+
+  /// Accumulate the structure factor with the same normalization used by
+  /// Lattice::AccumulateSk
+  auto AccumulateSk(realvec_t& sk, double mult = 1.0) const -> void;
+
+  /// Compute the structure factor
+  [[nodiscard]] auto ComputeSk(double mult = 1.0) const -> realvec_t;
+
+private:
+  /// Grid of the lattice
+  HyperCubicGrid grid_{};
+
+  /// Plan of the FFT used to reset the components
+  FFT fft_{};
+
+  /// Phases exp(2 pi i m / L_d) for each dimension
+  std::vector<std::vector<complex_t>> phases_{};
+
+  /// Fourier components, in row-major order of the momenta
+  std::vector<complex_t> rho_{};
+
+  /// Partial products of the phases over all but the last dimension
+  std::vector<complex_t> prefix_{};
+
+  /// Scratch space for the partial products
+  std::vector<complex_t> scratch_{};
+
+  /// Phases along the last dimension
+  std::vector<complex_t> line_{};
+}; // class StructureFactorTracker
+
+template<std::size_t D>
+inline StructureFactorTracker::StructureFactorTracker(
+  BasicLattice<D> const& lattice)
+  : grid_({ lattice.GetSize().begin(), lattice.GetSize().end() },
+          lattice.GetBoundaries(),
+          lattice.GetOrdering())
+{
+  assert(lattice.HasClosedBoundaries());
+
+  auto const& size = grid_.GetSize();
+  fft_ = FFT(size);
+  for (auto n : size) {
+    auto w = std::vector<complex_t>(n);
+    for (auto m = 0UL; m < n; m++) {
+      w[m] = std::polar(1.0,
+                        2.0 * M_PI * static_cast<double>(m) /
+                          static_cast<double>(n));
+    }
+    phases_.push_back(std::move(w));
+  }
+
+  rho_.assign(grid_.GetNumSites(), complex_t(0.0, 0.0));
+  auto nprefix = size.empty() ? 1UL : grid_.GetNumSites() / size.back();
+  prefix_.resize(nprefix);
+  scratch_.resize(nprefix);
+  line_.resize(size.empty() ? 0UL : size.back());
+}
+
+template<class T>
+inline auto
+StructureFactorTracker::Reset(std::vector<T> const& occupations) -> void
+{
+  const auto n = grid_.GetNumSites();
+  assert(occupations.size() == n);
+
+  auto data = std::vector<complex_t>(n);
+  for (auto j = 0UL; j < n; j++) {
+    data[grid_.GetRowMajorIndex(j)] = static_cast<double>(occupations[j]);
+  }
+  fft_.Transform(data, FFT::direction_t::Backward);
+
+  // the momentum with coordinates c has frequency q = c - L / 2 (mod L)
+  for (auto i = 0UL; i < n; i++) {
+    auto ci = grid_.GetCoordinates(i);
+    for (auto d = 0UL; d < ci.size(); d++) {
+      auto s = static_cast<long>(grid_.GetSize()[d]);
+      ci[d] = (ci[d] - s / 2L + s) % s;
+    }
+    rho_[grid_.GetRowMajorIndex(i)] =
+      data[grid_.GetRowMajorIndex(grid_.GetIndex(ci))];
+  }
+}
+
+inline auto
+StructureFactorTracker::Update(index_t site, double delta) -> void
+{
+  assert(grid_.IndexIsValid(site));
+
+  auto const& size = grid_.GetSize();
+  const auto dim = size.size();
+  const auto cx = grid_.GetCoordinates(site);
+
+  // phase of the momentum with coordinate c along the dimension d
+  auto phase = [&](size_t d, size_t c) {
+    auto s = static_cast<long>(size[d]);
+    auto q = static_cast<long>(c) - s / 2L;
+    auto m = (q * cx[d]) % s;
+    return phases_[d][static_cast<size_t>(m < 0 ? m + s : m)];
+  };
+
+  // outer product of the phases of all the dimensions but the last one
+  auto nprefix = 1UL;
+  prefix_[0] = complex_t(delta, 0.0);
+  for (auto d = 0UL; d + 1UL < dim; d++) {
+    for (auto p = 0UL; p < nprefix; p++) {
+      for (auto c = 0UL; c < size[d]; c++) {
+        scratch_[p * size[d] + c] = prefix_[p] * phase(d, c);
+      }
+    }
+    nprefix *= size[d];
+    std::swap(prefix_, scratch_);
+  }
+
+  // the last dimension is the contiguous one
+  const auto last = dim - 1UL;
+  const auto nlast = size[last];
+  for (auto c = 0UL; c < nlast; c++) {
+    line_[c] = phase(last, c);
+  }
+  for (auto p = 0UL; p < nprefix; p++) {
+    auto* rho = rho_.data() + p * nlast;
+    const auto f = prefix_[p];
+    for (auto c = 0UL; c < nlast; c++) {
+      rho[c] += f * line_[c];
+    }
+  }
+}
+
+inline auto
+StructureFactorTracker::Move(index_t from, index_t to, double amount) -> void
+{
+  Update(from, -amount);
+  Update(to, amount);
+}
+
+inline auto
+StructureFactorTracker::GetSk(index_t k) const -> double
+{
+  return std::norm(rho_[grid_.GetRowMajorIndex(k)]) /
+         static_cast<double>(square(rho_.size()));
+}
+
+inline auto
+StructureFactorTracker::AccumulateSk(realvec_t& sk, double mult) const -> void
+{
+  assert(sk.size() == rho_.size());
+  const auto norm = mult / static_cast<double>(square(rho_.size()));
+  for (auto k = 0UL; k < rho_.size(); k++) {
+    sk[k] += norm * std::norm(rho_[grid_.GetRowMajorIndex(k)]);
+  }
+}
+
+inline auto
+StructureFactorTracker::ComputeSk(double mult) const -> realvec_t
+{
+  auto sk = realvec_t(rho_.size(), 0.0);
+  AccumulateSk(sk, mult);
+  return sk;
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,242 @@
+//===-- ThreadPool.hpp -----------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the ThreadPool Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Minimal pool of threads running parallel loops.
+///
+/// The iterations of a ParallelFor are split in chunks which the threads,
+/// including the calling one, grab from a shared atomic counter until none
+/// is left. Threads which are done with cheap chunks keep taking new ones, so
+/// the load is balanced without any queue. Each iteration is executed exactly
+/// once, therefore loops whose iterations write to distinct locations give
+/// the same results of the serial loop.
+///
+/// A ParallelFor called from the body of another one, of this pool or of any
+/// other, runs serially on the calling thread. The threads of the pool are
+/// all busy with the outer loop, waiting for them would never end.
+///
+class ThreadPool
+{
+public:
+  /// Create a pool using @p numthreads threads, the calling one included.
+  /// With zero threads all the hardware threads are used.
+  explicit ThreadPool(std::size_t numthreads = 1UL);
+
+  /// Copy constructor
+  ThreadPool(ThreadPool const& that) = delete;
+
+  /// Move constructor
+  ThreadPool(ThreadPool&& that) = delete;
+
+  /// Copy assignment operator
+  auto operator=(ThreadPool const& that) -> ThreadPool& = delete;
+
+  /// Move assignment operator
+  auto operator=(ThreadPool&& that) -> ThreadPool& = delete;
+
+  /// Destructor, joins the threads
+  virtual ~ThreadPool();
+
+  /// Get the number of threads, the calling one included
+  [[nodiscard]] auto GetNumThreads() const -> std::size_t
+  {
+    return workers_.size() + 1UL;
+  }
+
+  /// Call `f(i)` for every i in [@p first, @p last). Chunks of @p grain
+  /// iterations are distributed to the threads, with zero a grain giving
+  /// a few chunks per thread is chosen. The first exception thrown by @p f is
+  /// rethrown once all the threads are done. Nested calls, from inside @p f
+  /// of an outer loop, run serially.
+  template<class F>
+  auto ParallelFor(std::size_t first,
+                   std::size_t last,
+                   F&& f,
+                   std::size_t grain = 0UL) -> void;
+
+protected:
+  /// Loop executed by the worker threads
+  auto Work() -> void;
+
+  /// Flag of the threads running the iterations of a ParallelFor
+  [[nodiscard]] static auto InsideLoop() -> bool&
+  {
+    thread_local auto inside = false;
+    return inside;
+  }
+
+private:
+  /// Worker threads
+  std::vector<std::thread> workers_{};
+
+  /// Serialize the calls to ParallelFor
+  std::mutex call_{};
+
+  /// Protect the state shared with the workers
+  std::mutex mutex_{};
+
+  /// Signal a new job to the workers
+  std::condition_variable wake_{};
+
+  /// Signal the completion of the job to the caller
+  std::condition_variable done_{};
+
+  /// Current job
+  std::function<void()> job_{};
+
+  /// Incremented for each job
+  std::size_t generation_{ 0UL };
+
+  /// Number of workers still running the job
+  std::size_t active_{ 0UL };
+
+  /// Whether the workers have to exit
+  bool stop_{ false };
+}; // class ThreadPool
+
+inline ThreadPool::ThreadPool(std::size_t numthreads)
+{
+  if (numthreads == 0UL) {
+    numthreads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  for (auto i = 1UL; i < numthreads; i++) {
+    workers_.emplace_back([this]() { Work(); });
+  }
+}
+
+inline ThreadPool::~ThreadPool()
+{
+  {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& w : workers_) {
+    w.join();
+  }
+}
+
+inline auto
+ThreadPool::Work() -> void
+{
+  // the workers only ever run the iterations of the loops
+  InsideLoop() = true;
+  auto seen = 0UL;
+  for (;;) {
+    auto lock = std::unique_lock<std::mutex>(mutex_);
+    wake_.wait(lock, [&]() { return stop_ || generation_ != seen; });
+    if (stop_) {
+      return;
+    }
+    seen = generation_;
+    auto job = job_;
+    lock.unlock();
+
+    job();
+
+    lock.lock();
+    if (--active_ == 0UL) {
+      done_.notify_one();
+    }
+  }
+}
+
+template<class F>
+inline auto
+ThreadPool::ParallelFor(std::size_t first,
+                        std::size_t last,
+                        F&& f,
+                        std::size_t grain) -> void
+{
+  if (first >= last) {
+    return;
+  }
+  const auto count = last - first;
+  if (grain == 0UL) {
+    grain = std::max(1UL, count / (8UL * GetNumThreads()));
+  }
+  if (workers_.empty() || count <= grain || InsideLoop()) {
+    for (auto i = first; i < last; i++) {
+      f(i);
+    }
+    return;
+  }
+
+  auto call = std::lock_guard<std::mutex>(call_);
+  auto next = std::atomic<std::size_t>(first);
+  auto error = std::exception_ptr{};
+  auto errormutex = std::mutex{};
+
+  auto chunks = [&]() {
+    for (;;) {
+      const auto begin = next.fetch_add(grain, std::memory_order_relaxed);
+      if (begin >= last) {
+        return;
+      }
+      const auto end = std::min(begin + grain, last);
+      try {
+        for (auto i = begin; i < end; i++) {
+          f(i);
+        }
+      } catch (...) {
+        auto lock = std::lock_guard<std::mutex>(errormutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+        next.store(last, std::memory_order_relaxed);
+      }
+    }
+  };
+
+  {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    job_ = chunks;
+    active_ = workers_.size();
+    generation_++;
+  }
+  wake_.notify_all();
+
+  InsideLoop() = true;
+  chunks();
+  InsideLoop() = false;
+
+  {
+    auto lock = std::unique_lock<std::mutex>(mutex_);
+    done_.wait(lock, [&]() { return active_ == 0UL; });
+    job_ = nullptr;
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
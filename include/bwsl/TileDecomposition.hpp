@@ -0,0 +1,348 @@
+//===-- TileDecomposition.hpp ----------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the TileDecomposition Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/SiteColoring.hpp>
+#include <bwsl/Span.hpp>
+#include <bwsl/ThreadPool.hpp>
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Decomposition of a grid in rectangular tiles, each one with the halo of
+/// the sites outside of it which are neighbors of its sites.
+///
+/// The halo is found from one or more neighbor tables, for example the
+/// nearest neighbors together with the shells of GetShellNeighborTable for
+/// longer range couplings. Two tiles conflict when one of them owns a site
+/// in the halo of the other. The tiles are grouped in phases of tiles with no
+/// conflicts, which can then be updated in parallel while the sites of each
+/// tile are updated in order by a single thread. Tiles whose sites and halo
+/// fit in the cache of one core, see GetTileSide, keep the working set of
+/// every thread local.
+///
+class TileDecomposition
+{
+public:
+  /// Type for the site and tile indices
+  using index_t = std::size_t;
+
+  /// View over a list of sites or tiles
+  using span_t = Span<index_t const>;
+
+  /// Cache size in bytes aimed at by GetTileSide, half of a typical L2 cache
+  /// to leave room for the neighbor tables
+  static constexpr std::size_t DefaultCacheBytes = 1UL << 19UL;
+
+  /// Default constructor
+  TileDecomposition() = default;
+
+  /// Split @p grid in tiles of @p tilesize sites along each direction, the
+  /// last tile of a direction is smaller if the size is not a multiple. The
+  /// halo of the tiles contains the neighbors of their sites in all the
+  /// @p tables .
+  template<class Grid, class... Tables>
+  TileDecomposition(Grid const& grid,
+                    std::vector<std::size_t> const& tilesize,
+                    Tables const&... tables);
+
+  /// Copy constructor
+  TileDecomposition(TileDecomposition const& that) = default;
+
+  /// Move constructor
+  TileDecomposition(TileDecomposition&& that) = default;
+
+  /// Copy assignment operator
+  auto operator=(TileDecomposition const& that)
+    -> TileDecomposition& = default;
+
+  /// Move assignment operator
+  auto operator=(TileDecomposition&& that) -> TileDecomposition& = default;
+
+  /// Default destructor
+  virtual ~TileDecomposition() = default;
+
+  /// Get the largest side of hypercubic tiles in dimension @p dim whose
+  /// sites, with @p bytespersite bytes each, and halo of width @p halo fit
+  /// in @p cachebytes bytes
+  [[nodiscard]] static auto GetTileSide(
+    std::size_t dim,
+    std::size_t bytespersite,
+    std::size_t halo = 1UL,
+    std::size_t cachebytes = DefaultCacheBytes) -> std::size_t;
+
+  /// Get the number of sites
+  [[nodiscard]] auto GetNumSites() const -> std::size_t
+  {
+    return owner_.size();
+  }
+
+  /// Get the number of tiles
+  [[nodiscard]] auto GetNumTiles() const -> std::size_t
+  {
+    return siteoffsets_.empty() ? 0UL : siteoffsets_.size() - 1UL;
+  }
+
+  /// Get the size of the tiles along each direction
+  [[nodiscard]] auto GetTileSize() const -> std::vector<std::size_t> const&
+  {
+    return tilesize_;
+  }
+
+  /// Get the tile owning site @p i
+  [[nodiscard]] auto GetTile(index_t i) const -> index_t
+  {
+    assert(i < owner_.size());
+    return owner_[i];
+  }
+
+  /// Get the sites of tile @p t in increasing order
+  [[nodiscard]] auto GetSites(index_t t) const -> span_t
+  {
+    assert(t < GetNumTiles());
+    return span_t(sites_.data() + siteoffsets_[t],
+                  siteoffsets_[t + 1UL] - siteoffsets_[t]);
+  }
+
+  /// Get the sites in the halo of tile @p t in increasing order
+  [[nodiscard]] auto GetHalo(index_t t) const -> span_t
+  {
+    assert(t < GetNumTiles());
+    return span_t(halo_.data() + halooffsets_[t],
+                  halooffsets_[t + 1UL] - halooffsets_[t]);
+  }
+
+  /// Get the number of phases
+  [[nodiscard]] auto GetNumPhases() const -> std::size_t
+  {
+    return phases_.GetNumColors();
+  }
+
+  /// Get the phase of tile @p t
+  [[nodiscard]] auto GetPhase(index_t t) const -> index_t
+  {
+    return phases_.GetColor(t);
+  }
+
+  /// Get the tiles of the phase @p p , no two of them conflict
+  [[nodiscard]] auto GetTiles(index_t p) const -> span_t
+  {
+    return phases_.GetSites(static_cast<SiteColoring::color_t>(p));
+  }
+
+  /// Check if the tiles @p t and @p u conflict
+  [[nodiscard]] auto AreConflicting(index_t t, index_t u) const -> bool;
+
+  /// Call `f(t)` for all the tiles, one phase after the other. The tiles of
+  /// a phase are processed in parallel by @p pool , hence @p f may read the
+  /// sites and the halo of t but must write only the sites of t. Parallel
+  /// loops started by @p f , such as SiteColoring::Sweep on the same pool,
+  /// run serially inside the tile.
+  template<class F>
+  auto Run(ThreadPool& pool, F&& f) const -> void;
+
+  /// Call `update(i)` for all the sites, visiting the tiles as Run does and
+  /// the sites of each tile in increasing order
+  template<class F>
+  auto Sweep(ThreadPool& pool, F&& update) const -> void;
+
+private:
+  /// Conflicts among the tiles, with the interface needed by SiteColoring
+  struct Conflicts
+  {
+    /// Same as NeighborTable
+    auto GetNumSites() const -> std::size_t { return offsets.size() - 1UL; }
+    auto GetCoordination(index_t t) const -> std::size_t
+    {
+      return offsets[t + 1UL] - offsets[t];
+    }
+    auto GetNeighbors(index_t t) const -> span_t
+    {
+      return span_t(indices.data() + offsets[t], GetCoordination(t));
+    }
+
+    /// Position of the first conflict of each tile, and the end
+    std::vector<index_t> offsets{};
+
+    /// Tiles conflicting with each tile
+    std::vector<index_t> indices{};
+  };
+
+  /// Size of the tiles along each direction
+  std::vector<std::size_t> tilesize_{};
+
+  /// Tile owning each site
+  std::vector<index_t> owner_{};
+
+  /// Position in sites_ of the first site of each tile, and the end
+  std::vector<index_t> siteoffsets_{};
+
+  /// Sites sorted by tile
+  std::vector<index_t> sites_{};
+
+  /// Position in halo_ of the first site of the halo of each tile
+  std::vector<index_t> halooffsets_{};
+
+  /// Halos of all the tiles
+  std::vector<index_t> halo_{};
+
+  /// Conflicts among the tiles
+  Conflicts conflicts_{};
+
+  /// Tiles grouped by phase
+  SiteColoring phases_{};
+}; // class TileDecomposition
+
+template<class Grid, class... Tables>
+inline TileDecomposition::TileDecomposition(
+  Grid const& grid,
+  std::vector<std::size_t> const& tilesize,
+  Tables const&... tables)
+  : tilesize_(tilesize)
+{
+  const auto dim = grid.GetDim();
+  const auto n = grid.GetNumSites();
+  assert(tilesize_.size() == dim);
+
+  // tiles numbered in row-major order of their position in the grid
+  auto numtiles = 1UL;
+  auto counts = std::vector<std::size_t>(dim);
+  for (auto d = 0UL; d < dim; d++) {
+    assert(tilesize_[d] > 0UL);
+    counts[d] = (grid.GetSize()[d] + tilesize_[d] - 1UL) / tilesize_[d];
+    numtiles *= counts[d];
+  }
+  owner_.resize(n);
+  for (auto i = 0UL; i < n; i++) {
+    const auto c = grid.GetCoordinates(i);
+    auto t = 0UL;
+    for (auto d = dim; d-- > 0UL;) {
+      t = t * counts[d] + static_cast<std::size_t>(c[d]) / tilesize_[d];
+    }
+    owner_[i] = t;
+  }
+
+  // counting sort keeps the sites of each tile in increasing order
+  siteoffsets_.assign(numtiles + 1UL, 0UL);
+  for (auto t : owner_) {
+    siteoffsets_[t + 1UL]++;
+  }
+  for (auto t = 0UL; t < numtiles; t++) {
+    siteoffsets_[t + 1UL] += siteoffsets_[t];
+  }
+  sites_.resize(n);
+  auto next =
+    std::vector<index_t>(siteoffsets_.begin(), siteoffsets_.end() - 1);
+  for (auto i = 0UL; i < n; i++) {
+    sites_[next[owner_[i]]++] = i;
+  }
+
+  // halo of each tile and the tiles owning it
+  auto owners = std::vector<std::vector<index_t>>(numtiles);
+  halooffsets_.assign(1UL, 0UL);
+  for (auto t = 0UL; t < numtiles; t++) {
+    auto halo = std::vector<index_t>{};
+    for (auto i : GetSites(t)) {
+      auto collect = [&](auto const& table) {
+        assert(table.GetNumSites() == n);
+        for (auto j : table.GetNeighbors(i)) {
+          if (owner_[j] != t) {
+            halo.push_back(j);
+          }
+        }
+      };
+      (collect(tables), ...);
+    }
+    std::sort(halo.begin(), halo.end());
+    halo.erase(std::unique(halo.begin(), halo.end()), halo.end());
+    for (auto j : halo) {
+      owners[t].push_back(owner_[j]);
+      owners[owner_[j]].push_back(t);
+    }
+    halo_.insert(halo_.end(), halo.begin(), halo.end());
+    halooffsets_.push_back(halo_.size());
+  }
+
+  conflicts_.offsets.assign(1UL, 0UL);
+  for (auto& u : owners) {
+    std::sort(u.begin(), u.end());
+    u.erase(std::unique(u.begin(), u.end()), u.end());
+    conflicts_.indices.insert(conflicts_.indices.end(), u.begin(), u.end());
+    conflicts_.offsets.push_back(conflicts_.indices.size());
+  }
+  phases_ = SiteColoring::FromNeighbors(conflicts_);
+  assert(phases_.IsProper(conflicts_));
+}
+
+inline auto
+TileDecomposition::GetTileSide(std::size_t dim,
+                               std::size_t bytespersite,
+                               std::size_t halo,
+                               std::size_t cachebytes) -> std::size_t
+{
+  auto volume = [&](std::size_t side) {
+    auto v = bytespersite;
+    for (auto d = 0UL; d < dim; d++) {
+      v *= side + 2UL * halo;
+    }
+    return v;
+  };
+  auto side = 1UL;
+  while (volume(side + 1UL) <= cachebytes) {
+    side++;
+  }
+  return side;
+}
+
+inline auto
+TileDecomposition::AreConflicting(index_t t, index_t u) const -> bool
+{
+  auto tiles = conflicts_.GetNeighbors(t);
+  return std::binary_search(tiles.begin(), tiles.end(), u);
+}
+
+template<class F>
+inline auto
+TileDecomposition::Run(ThreadPool& pool, F&& f) const -> void
+{
+  for (auto p = 0UL; p < GetNumPhases(); p++) {
+    auto tiles = GetTiles(p);
+    pool.ParallelFor(
+      0UL, tiles.size(), [&](std::size_t k) { f(tiles[k]); }, 1UL);
+  }
+}
+
+template<class F>
+inline auto
+TileDecomposition::Sweep(ThreadPool& pool, F&& update) const -> void
+{
+  Run(pool, [&](index_t t) {
+    for (auto i : GetSites(t)) {
+      update(i);
+    }
+  });
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
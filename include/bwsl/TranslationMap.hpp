@@ -0,0 +1,293 @@
+//===-- TranslationMap.hpp -------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the TranslationMap Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/HyperCubicGrid.hpp>
+
+// std
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace bwsl {
+
+/// Storage of the translations of a grid
+enum class TranslationMode
+{
+  /// No table, the translations are computed from the coordinates
+  None,
+  /// Choose the fastest storage fitting in the memory budget
+  Auto,
+  /// Table with one entry for each pair of sites
+  Dense,
+  /// Tables for each dimension, combined at each query
+  Decomposed,
+};
+
+/// Default memory budget for the translation tables, in bytes
+inline constexpr std::size_t DefaultTranslationBudget = 16UL << 20UL;
+
+///
+/// Precomputed translations of a grid with closed boundaries.
+///
+/// GetMappedSite(a, b) is the site i such that the translation bringing
+/// @p a to the origin brings @p b to i, GetUnMappedSite(i, a) is its inverse.
+/// They have the same meaning of the methods of BasicHyperCubicGrid.
+///
+/// The Dense storage keeps the whole N x N table and answers with one load,
+/// GetUnMappedSite also needs the index of the opposite of @p a . The
+/// Decomposed storage keeps the coordinates of each site and, for each
+/// dimension d, the tables of (x - y) mod L_d and (x + y) mod L_d already
+/// multiplied by the stride. It needs O(N D + sum_d L_d^2) memory and three
+/// loads per dimension.
+///
+class TranslationMap
+{
+public:
+  /// Type for the site indices
+  using index_t = std::size_t;
+
+  /// Type of the stored site indices and coordinates
+  using entry_t = std::uint32_t;
+
+  /// Default constructor
+  TranslationMap() = default;
+
+  /// Build the table for @p grid with the given mode and memory budget.
+  /// With TranslationMode::Auto the Dense storage is chosen if it fits in
+  /// @p budget bytes, otherwise the Decomposed one if it fits, otherwise no
+  /// table is built. Grids with open boundaries or with power of two sizes
+  /// in row-major order (which already map sites with bit operations) get no
+  /// table. The Decomposed storage needs the row-major numbering, asking for
+  /// it on another numbering throws std::invalid_argument.
+  template<std::size_t D>
+  TranslationMap(BasicHyperCubicGrid<D> const& grid,
+                 TranslationMode mode,
+                 std::size_t budget = DefaultTranslationBudget);
+
+  /// Copy constructor
+  TranslationMap(TranslationMap const& that) = default;
+
+  /// Move constructor
+  TranslationMap(TranslationMap&& that) = default;
+
+  /// Copy assignment operator
+  auto operator=(TranslationMap const& that) -> TranslationMap& = default;
+
+  /// Move assignment operator
+  auto operator=(TranslationMap&& that) -> TranslationMap& = default;
+
+  /// Default destructor
+  virtual ~TranslationMap() = default;
+
+  /// Get the storage used, never TranslationMode::Auto
+  [[nodiscard]] auto GetMode() const -> TranslationMode { return mode_; }
+
+  /// Check if the table has been built
+  [[nodiscard]] auto IsEnabled() const -> bool
+  {
+    return mode_ != TranslationMode::None;
+  }
+
+  /// Get the memory used by the tables, in bytes
+  [[nodiscard]] auto GetMemoryUsage() const -> std::size_t;
+
+  /// Get the site i mapping (a, b) to (0, i)
+  [[nodiscard]] auto GetMappedSite(index_t a, index_t b) const -> index_t
+  {
+    assert(IsEnabled() && a < numsites_ && b < numsites_);
+    if (mode_ == TranslationMode::Dense) {
+      return dense_[a * numsites_ + b];
+    }
+    return Combine(diff_, a, b);
+  }
+
+  /// Get the site i mapping (0, i) to (a, b)
+  [[nodiscard]] auto GetUnMappedSite(index_t i, index_t a) const -> index_t
+  {
+    assert(IsEnabled() && a < numsites_ && i < numsites_);
+    if (mode_ == TranslationMode::Dense) {
+      return dense_[opposite_[a] * numsites_ + i];
+    }
+    return Combine(sum_, i, a);
+  }
+
+  /// Memory needed by the Dense storage for a grid of @p numsites sites
+  [[nodiscard]] static auto DenseMemory(std::size_t numsites) -> std::size_t;
+
+  /// Memory needed by the Decomposed storage for a grid of the given size
+  template<class Container>
+  [[nodiscard]] static auto DecomposedMemory(Container const& size)
+    -> std::size_t;
+
+protected:
+  /// Sum over the dimensions of the entries of @p table for the coordinates
+  /// of the sites @p x and @p y
+  [[nodiscard]] auto Combine(std::vector<index_t> const& table,
+                             index_t x,
+                             index_t y) const -> index_t
+  {
+    auto index = 0UL;
+    for (auto d = 0UL; d < sizes_.size(); d++) {
+      auto const* c = coords_.data() + d * numsites_;
+      index += table[offsets_[d] + c[x] * sizes_[d] + c[y]];
+    }
+    return index;
+  }
+
+private:
+  /// Storage used
+  TranslationMode mode_{ TranslationMode::None };
+
+  /// Number of sites
+  std::size_t numsites_{ 0UL };
+
+  /// Dense table, row a holds the mapped sites of all the b
+  std::vector<entry_t> dense_{};
+
+  /// Index of the site opposite to each site, used with the dense table
+  std::vector<entry_t> opposite_{};
+
+  /// Coordinates of the sites, one row of numsites_ elements per dimension
+  std::vector<entry_t> coords_{};
+
+  /// Sizes of the grid
+  std::vector<std::size_t> sizes_{};
+
+  /// Offset of the table of each dimension in diff_ and sum_
+  std::vector<std::size_t> offsets_{};
+
+  /// Tables stride * ((y - x) mod L) for each dimension
+  std::vector<index_t> diff_{};
+
+  /// Tables stride * ((x + y) mod L) for each dimension
+  std::vector<index_t> sum_{};
+}; // class TranslationMap
+
+template<std::size_t D>
+inline TranslationMap::TranslationMap(BasicHyperCubicGrid<D> const& grid,
+                                      TranslationMode mode,
+                                      std::size_t budget)
+  : numsites_(grid.GetNumSites())
+{
+  const auto dense = DenseMemory(numsites_);
+  const auto decomposed = DecomposedMemory(grid.GetSize());
+  const auto fits = numsites_ <= std::numeric_limits<entry_t>::max();
+
+  if (grid.HasOpenBoundaries() || !fits) {
+    assert(mode == TranslationMode::None || mode == TranslationMode::Auto);
+    mode = TranslationMode::None;
+  }
+  // the per-dimension tables combine row-major strides
+  if (mode == TranslationMode::Decomposed && !grid.IsRowMajor()) {
+    throw std::invalid_argument(
+      "decomposed translations need the row-major numbering");
+  }
+  if (mode == TranslationMode::Auto) {
+    if (grid.HasPowerOfTwoSizes() && grid.IsRowMajor()) {
+      mode = TranslationMode::None;
+    } else if (dense <= budget) {
+      mode = TranslationMode::Dense;
+    } else if (decomposed <= budget && grid.IsRowMajor()) {
+      mode = TranslationMode::Decomposed;
+    } else {
+      mode = TranslationMode::None;
+    }
+  }
+  if (mode == TranslationMode::None) {
+    return;
+  }
+
+  // the per-dimension tables are also used to fill the dense one
+  auto const& size = grid.GetSize();
+  auto const& strides = grid.GetStrides();
+  sizes_.assign(size.begin(), size.end());
+  coords_.resize(sizes_.size() * numsites_);
+  for (auto const& site : grid.GetSites()) {
+    for (auto d = 0UL; d < sizes_.size(); d++) {
+      coords_[d * numsites_ + site.index] =
+        static_cast<entry_t>(site.coords[d]);
+    }
+  }
+  for (auto d = 0UL; d < sizes_.size(); d++) {
+    const auto l = sizes_[d];
+    offsets_.push_back(diff_.size());
+    for (auto x = 0UL; x < l; x++) {
+      for (auto y = 0UL; y < l; y++) {
+        diff_.push_back(strides[d] * ((y + l - x) % l));
+        sum_.push_back(strides[d] * ((x + y) % l));
+      }
+    }
+  }
+
+  mode_ = TranslationMode::Decomposed;
+  if (mode == TranslationMode::Decomposed) {
+    return;
+  }
+
+  dense_.resize(numsites_ * numsites_);
+  opposite_.resize(numsites_);
+  for (auto a = 0UL; a < numsites_; a++) {
+    auto* row = dense_.data() + a * numsites_;
+    for (auto b = 0UL; b < numsites_; b++) {
+      row[b] = static_cast<entry_t>(
+        grid.GetIndexFromRowMajor(Combine(diff_, a, b)));
+    }
+    opposite_[a] = row[0];
+  }
+
+  // the coordinates are not needed anymore
+  mode_ = TranslationMode::Dense;
+  coords_ = {};
+  sizes_ = {};
+  offsets_ = {};
+  diff_ = {};
+  sum_ = {};
+}
+
+inline auto
+TranslationMap::DenseMemory(std::size_t numsites) -> std::size_t
+{
+  return (numsites + 1UL) * numsites * sizeof(entry_t);
+}
+
+template<class Container>
+inline auto
+TranslationMap::DecomposedMemory(Container const& size) -> std::size_t
+{
+  auto numsites = 1UL;
+  auto tables = 0UL;
+  for (auto l : size) {
+    numsites *= l;
+    tables += 2UL * l * l;
+  }
+  return size.size() * numsites * sizeof(entry_t) + tables * sizeof(index_t);
+}
+
+inline auto
+TranslationMap::GetMemoryUsage() const -> std::size_t
+{
+  return (dense_.size() + opposite_.size() + coords_.size()) *
+           sizeof(entry_t) +
+         (diff_.size() + sum_.size()) * sizeof(index_t);
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
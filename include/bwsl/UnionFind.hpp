@@ -0,0 +1,156 @@
+//===-- UnionFind.hpp ------------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the ConcurrentUnionFind Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// std
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace bwsl {
+
+///
+/// Disjoint sets of elements which can be merged by many threads at once
+/// without locks.
+///
+/// The parent of every element is an atomic index. Roots are always linked
+/// below smaller roots with a compare and swap, so that the root of a set is
+/// its smallest element whatever the order of the unions, and Find halves
+/// the paths it walks. Unions and finds from different threads can be
+/// interleaved freely, the sets are the same as with a serial loop.
+///
+class ConcurrentUnionFind
+{
+public:
+  /// Type of the elements
+  using index_t = std::size_t;
+
+  /// Default constructor
+  ConcurrentUnionFind() = default;
+
+  /// Create @p numelements sets of one element
+  explicit ConcurrentUnionFind(std::size_t numelements);
+
+  /// Copy constructor
+  ConcurrentUnionFind(ConcurrentUnionFind const& that) = delete;
+
+  /// Move constructor
+  ConcurrentUnionFind(ConcurrentUnionFind&& that) = default;
+
+  /// Copy assignment operator
+  auto operator=(ConcurrentUnionFind const& that)
+    -> ConcurrentUnionFind& = delete;
+
+  /// Move assignment operator
+  auto operator=(ConcurrentUnionFind&& that)
+    -> ConcurrentUnionFind& = default;
+
+  /// Default destructor
+  virtual ~ConcurrentUnionFind() = default;
+
+  /// Get the number of elements
+  [[nodiscard]] auto GetNumElements() const -> std::size_t
+  {
+    return numelements_;
+  }
+
+  /// Make @p i a set of its own again. Not safe while other threads access
+  /// the sets.
+  auto Reset(index_t i) -> void
+  {
+    assert(i < numelements_);
+    parent_[i].store(i, std::memory_order_relaxed);
+  }
+
+  /// Get the root of the set of @p i , its smallest element
+  [[nodiscard]] auto Find(index_t i) -> index_t;
+
+  /// Check if @p i is the root of its set
+  [[nodiscard]] auto IsRoot(index_t i) const -> bool
+  {
+    assert(i < numelements_);
+    return parent_[i].load(std::memory_order_acquire) == i;
+  }
+
+  /// Merge the sets of @p a and @p b , return false if they were already the
+  /// same set
+  auto Unite(index_t a, index_t b) -> bool;
+
+private:
+  /// Number of elements
+  std::size_t numelements_{ 0UL };
+
+  /// Parent of each element, the roots are their own parent
+  std::unique_ptr<std::atomic<index_t>[]> parent_{};
+}; // class ConcurrentUnionFind
+
+inline ConcurrentUnionFind::ConcurrentUnionFind(std::size_t numelements)
+  : numelements_(numelements)
+  , parent_(std::make_unique<std::atomic<index_t>[]>(numelements))
+{
+  for (auto i = 0UL; i < numelements_; i++) {
+    Reset(i);
+  }
+}
+
+inline auto
+ConcurrentUnionFind::Find(index_t i) -> index_t
+{
+  assert(i < numelements_);
+
+  // every parent is smaller than its child, replacing it with the
+  // grandparent keeps the sets unchanged even if another thread is linking
+  // the root at the same time
+  auto p = parent_[i].load(std::memory_order_acquire);
+  while (p != i) {
+    const auto g = parent_[p].load(std::memory_order_acquire);
+    if (g != p) {
+      parent_[i].compare_exchange_weak(
+        p, g, std::memory_order_acq_rel, std::memory_order_acquire);
+    }
+    i = p;
+    p = parent_[i].load(std::memory_order_acquire);
+  }
+  return i;
+}
+
+inline auto
+ConcurrentUnionFind::Unite(index_t a, index_t b) -> bool
+{
+  for (;;) {
+    auto ra = Find(a);
+    auto rb = Find(b);
+    if (ra == rb) {
+      return false;
+    }
+    if (ra < rb) {
+      std::swap(ra, rb);
+    }
+    // link the larger root, unless it stopped being a root meanwhile
+    auto expected = ra;
+    if (parent_[ra].compare_exchange_strong(expected,
+                                            rb,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_acquire)) {
+      return true;
+    }
+  }
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,165 @@
+//===-- WindingAccumulator.hpp ---------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the BasicWindingAccumulator Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/Bravais.hpp>
+#include <bwsl/HyperCubicGrid.hpp>
+#include <bwsl/JumpTable.hpp>
+
+// std
+#include <array>
+#include <cassert>
+#include <cstddef>
+
+namespace bwsl {
+
+///
+/// Winding and displacement of a path of hops between nearest neighbors,
+/// for example the worm of a worm algorithm.
+///
+/// Each hop adds the row of a JumpTable, the accumulator is a fixed size
+/// array updated in place, so that following the path costs a few integer
+/// additions per hop and no allocation. With @p D equal to DynamicDim the
+/// dimension is chosen at runtime, up to Bravais::MaxDim.
+///
+template<std::size_t D>
+class BasicWindingAccumulator
+{
+public:
+  /// Number of components stored
+  static constexpr std::size_t Capacity = D == DynamicDim ? Bravais::MaxDim : D;
+
+  /// Type of the accumulated vectors
+  using vector_t = std::array<long, Capacity>;
+
+  /// Create an accumulator in dimension @p dim
+  explicit BasicWindingAccumulator(std::size_t dim = D == DynamicDim ? 1UL
+                                                                     : D)
+    : dim_(dim)
+  {
+    assert(dim_ <= Capacity && (D == DynamicDim || dim_ == D));
+  }
+
+  /// Copy constructor
+  BasicWindingAccumulator(BasicWindingAccumulator const& that) = default;
+
+  /// Move constructor
+  BasicWindingAccumulator(BasicWindingAccumulator&& that) = default;
+
+  /// Copy assignment operator
+  auto operator=(BasicWindingAccumulator const& that)
+    -> BasicWindingAccumulator& = default;
+
+  /// Move assignment operator
+  auto operator=(BasicWindingAccumulator&& that)
+    -> BasicWindingAccumulator& = default;
+
+  /// Default destructor
+  virtual ~BasicWindingAccumulator() = default;
+
+  /// Get the dimension
+  [[nodiscard]] auto GetDim() const -> std::size_t { return dim_; }
+
+  /// Add the hop from site @p a along slot @p slot of @p jumps
+  auto Hop(JumpTable const& jumps, std::size_t a, std::size_t slot) -> void
+  {
+    Add(jumps, a, slot, 1L);
+  }
+
+  /// Remove the hop from site @p a along slot @p slot of @p jumps , as when
+  /// the worm retracts
+  auto Unhop(JumpTable const& jumps, std::size_t a, std::size_t slot) -> void
+  {
+    Add(jumps, a, slot, -1L);
+  }
+
+  /// Get the winding along direction @p d
+  [[nodiscard]] auto GetWinding(std::size_t d) const -> long
+  {
+    assert(d < dim_);
+    return winding_[d];
+  }
+
+  /// Get the winding, the components after the dimension are zero
+  [[nodiscard]] auto GetWinding() const -> vector_t const& { return winding_; }
+
+  /// Get the displacement along direction @p d
+  [[nodiscard]] auto GetDisplacement(std::size_t d) const -> long
+  {
+    assert(d < dim_);
+    return displacement_[d];
+  }
+
+  /// Get the displacement, the components after the dimension are zero
+  [[nodiscard]] auto GetDisplacement() const -> vector_t const&
+  {
+    return displacement_;
+  }
+
+  /// Check if the path does not wind around the boundaries
+  [[nodiscard]] auto IsZero() const -> bool
+  {
+    for (auto d = 0UL; d < dim_; d++) {
+      if (winding_[d] != 0L) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// Forget the hops
+  auto Reset() -> void
+  {
+    winding_.fill(0L);
+    displacement_.fill(0L);
+  }
+
+protected:
+  /// Add @p sign times the row of the hop from @p a along @p slot
+  auto Add(JumpTable const& jumps, std::size_t a, std::size_t slot, long sign)
+    -> void
+  {
+    assert(jumps.GetDim() == dim_);
+    auto const* w = jumps.GetWinding(a, slot).data();
+    auto const* x = jumps.GetDisplacement(a, slot).data();
+    for (auto d = 0UL; d < (D == DynamicDim ? dim_ : D); d++) {
+      winding_[d] += sign * w[d];
+      displacement_[d] += sign * x[d];
+    }
+  }
+
+private:
+  /// Dimension
+  std::size_t dim_{ D };
+
+  /// Accumulated winding
+  vector_t winding_{};
+
+  /// Accumulated displacement
+  vector_t displacement_{};
+}; // class BasicWindingAccumulator
+
+/// Winding accumulator with the dimension chosen at runtime
+using WindingAccumulator = BasicWindingAccumulator<DynamicDim>;
+
+/// Winding accumulators with fixed dimension
+using WindingAccumulator1D = BasicWindingAccumulator<1UL>;
+using WindingAccumulator2D = BasicWindingAccumulator<2UL>;
+using WindingAccumulator3D = BasicWindingAccumulator<3UL>;
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -57,6 +57,9 @@ public:
   /// Add a measurement with unit weight
   auto Add(double m) -> void;
 
+  /// Add the measurements of @p that
+  auto Merge(KnuthWelfordAccumulator const& that) -> void;
+
   /// Sum of the accumulated values
   [[nodiscard]] auto Sum() const -> double { return mean_ * Count(); };
 
@@ -118,6 +121,28 @@ KnuthWelfordAccumulator::Add(double x) -> void
   m2_ += delta * delta2;
 }
 
+inline auto
+KnuthWelfordAccumulator::Merge(KnuthWelfordAccumulator const& that) -> void
+{
+  if (that.count_ == 0UL) {
+    return;
+  }
+#ifdef BWSL_ACCUMULATORS_CHECKS
+  if (count_ > std::numeric_limits<unsigned long>::max() - that.count_) {
+    throw exception::AccumulatorOverflow();
+  }
+#endif // BWSL_ACCUMULATORS_CHECKS
+
+  // pairwise update of Chan, Golub and LeVeque
+  const auto count = count_ + that.count_;
+  const auto delta = that.mean_ - mean_;
+  const auto fraction =
+    static_cast<double>(that.count_) / static_cast<double>(count);
+  mean_ += delta * fraction;
+  m2_ += that.m2_ + delta * delta * static_cast<double>(count_) * fraction;
+  count_ = count;
+}
+
 inline auto
 KnuthWelfordAccumulator::Variance(bool corrected) const -> double
 {
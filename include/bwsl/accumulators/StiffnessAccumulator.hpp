@@ -0,0 +1,327 @@
+//===-- StiffnessAccumulator.hpp -------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the StiffnessAccumulator Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/accumulators/AccumulatorsExceptions.hpp>
+#include <bwsl/accumulators/KnuthWelfordAccumulator.hpp>
+
+// boost
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace bwsl::accumulators {
+
+///
+/// Accumulator of the squared winding numbers and of the superfluid
+/// stiffness estimated from them.
+///
+/// For a grid of sides `L_d` and volume `V` at inverse temperature `beta`
+/// the stiffness is
+///
+///   rho_s = sum_d <W_d^2> L_d^2 / (dim beta V)
+///
+/// which is `<W^2> L^(2 - dim) / (dim beta)` on a hypercube. The squares of
+/// the windings are summed exactly as integers, the measurements are grouped
+/// in bins of fixed size and the errors are those of the bin averages.
+/// Accumulators filled by different threads with the same parameters can be
+/// merged, the incomplete bins of the merged accumulators are carried in the
+/// averages but never closed, so that every bin has the same size.
+///
+class StiffnessAccumulator
+{
+public:
+  /// Type of the sums of the squared windings
+  using sum_t = unsigned long long;
+
+  /// Default constructor
+  StiffnessAccumulator() = default;
+
+  /// Create the accumulator for a grid of sides @p sizes at inverse
+  /// temperature @p beta , with @p binsize measurements in each bin
+  template<class Sizes>
+  StiffnessAccumulator(Sizes const& sizes,
+                       double beta,
+                       unsigned long binsize = 1UL);
+
+  /// Copy constructor
+  StiffnessAccumulator(StiffnessAccumulator const& that) = default;
+
+  /// Move constructor
+  StiffnessAccumulator(StiffnessAccumulator&& that) = default;
+
+  /// Default destructor
+  virtual ~StiffnessAccumulator() = default;
+
+  /// Copy assignment operator
+  auto operator=(StiffnessAccumulator const& that)
+    -> StiffnessAccumulator& = default;
+
+  /// Move assignment operator
+  auto operator=(StiffnessAccumulator&& that)
+    -> StiffnessAccumulator& = default;
+
+  /// Add the winding @p winding , for example from Lattice::GetWinding or
+  /// BasicWindingAccumulator::GetWinding, only the first components up to
+  /// the dimension are used
+  template<class Winding>
+  auto Add(Winding const& winding) -> void;
+
+  /// Add the measurements of @p that , which must have the same parameters.
+  /// The incomplete bin of this accumulator stays open, the incomplete bins
+  /// of @p that are carried over: they enter the averages but not the
+  /// errors.
+  auto Merge(StiffnessAccumulator const& that) -> void;
+
+  /// Get the dimension
+  [[nodiscard]] auto GetDim() const -> std::size_t { return sizes_.size(); }
+
+  /// Get the number of measurements
+  [[nodiscard]] auto Count() const -> unsigned long
+  {
+    return count_ + bincount_ + carrycount_;
+  }
+
+  /// Get the number of complete bins
+  [[nodiscard]] auto NumBins() const -> unsigned long
+  {
+    return stiffness_.Count();
+  }
+
+  /// Average of the squared winding along direction @p d , zero without
+  /// measurements
+  [[nodiscard]] auto MeanWindingSquared(std::size_t d) const -> double;
+
+  /// Error on the average of the squared winding along direction @p d
+  [[nodiscard]] auto WindingSquaredError(std::size_t d) const -> double
+  {
+    assert(d < GetDim());
+    return windings_[d].Error(true);
+  }
+
+  /// Average of the stiffness, zero without measurements
+  [[nodiscard]] auto Stiffness() const -> double;
+
+  /// Error on the average of the stiffness
+  [[nodiscard]] auto StiffnessError() const -> double
+  {
+    return stiffness_.Error(true);
+  }
+
+  /// Reset the accumulator to the initial state, keeping the parameters
+  auto Reset() -> void;
+
+protected:
+  /// Get the stiffness for the sums @p sums of @p count squared windings
+  [[nodiscard]] auto GetStiffness(std::vector<sum_t> const& sums,
+                                  unsigned long count) const -> double;
+
+  /// Close the incomplete bin
+  auto CloseBin() -> void;
+
+private:
+  /// Sides of the grid
+  std::vector<unsigned long> sizes_{};
+
+  /// Inverse temperature
+  double beta_{ 1.0 };
+
+  /// Number of measurements in each bin
+  unsigned long binsize_{ 1UL };
+
+  /// Sums of the squared windings of the complete bins
+  std::vector<sum_t> sums_{};
+
+  /// Number of measurements of the complete bins
+  unsigned long count_{ 0UL };
+
+  /// Sums of the squared windings of the incomplete bin
+  std::vector<sum_t> binsums_{};
+
+  /// Number of measurements of the incomplete bin
+  unsigned long bincount_{ 0UL };
+
+  /// Sums of the squared windings of the incomplete bins carried by Merge
+  std::vector<sum_t> carrysums_{};
+
+  /// Number of measurements carried by Merge
+  unsigned long carrycount_{ 0UL };
+
+  /// Averages of the squared windings of the bins
+  std::vector<KnuthWelfordAccumulator> windings_{};
+
+  /// Stiffness of the bins
+  KnuthWelfordAccumulator stiffness_{};
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class StiffnessAccumulator
+
+template<class Sizes>
+inline StiffnessAccumulator::StiffnessAccumulator(Sizes const& sizes,
+                                                  double beta,
+                                                  unsigned long binsize)
+  : sizes_(sizes.begin(), sizes.end())
+  , beta_(beta)
+  , binsize_(binsize)
+  , sums_(sizes_.size(), sum_t{ 0ULL })
+  , binsums_(sizes_.size(), sum_t{ 0ULL })
+  , carrysums_(sizes_.size(), sum_t{ 0ULL })
+  , windings_(sizes_.size())
+{
+  assert(binsize_ > 0UL);
+}
+
+template<class Winding>
+inline auto
+StiffnessAccumulator::Add(Winding const& winding) -> void
+{
+#ifdef BWSL_ACCUMULATORS_CHECKS
+  if (Count() == std::numeric_limits<unsigned long>::max()) {
+    throw exception::AccumulatorOverflow();
+  }
+#endif // BWSL_ACCUMULATORS_CHECKS
+
+  for (auto d = 0UL; d < binsums_.size(); d++) {
+    const auto w = static_cast<long long>(winding[d]);
+    binsums_[d] += static_cast<sum_t>(w * w);
+  }
+  if (++bincount_ == binsize_) {
+    CloseBin();
+  }
+}
+
+inline auto
+StiffnessAccumulator::Merge(StiffnessAccumulator const& that) -> void
+{
+  assert(sizes_ == that.sizes_ && beta_ == that.beta_);
+  assert(binsize_ == that.binsize_);
+
+  for (auto d = 0UL; d < sums_.size(); d++) {
+    sums_[d] += that.sums_[d];
+    carrysums_[d] += that.binsums_[d] + that.carrysums_[d];
+    windings_[d].Merge(that.windings_[d]);
+  }
+  count_ += that.count_;
+  carrycount_ += that.bincount_ + that.carrycount_;
+  stiffness_.Merge(that.stiffness_);
+}
+
+inline auto
+StiffnessAccumulator::MeanWindingSquared(std::size_t d) const -> double
+{
+  assert(d < GetDim());
+  if (Count() == 0UL) {
+    return 0.0;
+  }
+  return static_cast<double>(sums_[d] + binsums_[d] + carrysums_[d]) /
+         static_cast<double>(Count());
+}
+
+inline auto
+StiffnessAccumulator::Stiffness() const -> double
+{
+  if (Count() == 0UL) {
+    return 0.0;
+  }
+  auto sums = sums_;
+  for (auto d = 0UL; d < sums.size(); d++) {
+    sums[d] += binsums_[d] + carrysums_[d];
+  }
+  return GetStiffness(sums, Count());
+}
+
+inline auto
+StiffnessAccumulator::Reset() -> void
+{
+  for (auto d = 0UL; d < sums_.size(); d++) {
+    sums_[d] = 0ULL;
+    binsums_[d] = 0ULL;
+    carrysums_[d] = 0ULL;
+    windings_[d].Reset();
+  }
+  count_ = 0UL;
+  bincount_ = 0UL;
+  carrycount_ = 0UL;
+  stiffness_.Reset();
+}
+
+inline auto
+StiffnessAccumulator::GetStiffness(std::vector<sum_t> const& sums,
+                                   unsigned long count) const -> double
+{
+  auto volume = 1.0;
+  for (auto size : sizes_) {
+    volume *= static_cast<double>(size);
+  }
+  auto rho = 0.0;
+  for (auto d = 0UL; d < sums.size(); d++) {
+    const auto size = static_cast<double>(sizes_[d]);
+    rho += static_cast<double>(sums[d]) * size * size;
+  }
+  return rho / (static_cast<double>(count) *
+                static_cast<double>(sizes_.size()) * beta_ * volume);
+}
+
+inline auto
+StiffnessAccumulator::CloseBin() -> void
+{
+  for (auto d = 0UL; d < binsums_.size(); d++) {
+    windings_[d].Add(static_cast<double>(binsums_[d]) /
+                     static_cast<double>(bincount_));
+  }
+  stiffness_.Add(GetStiffness(binsums_, bincount_));
+  for (auto d = 0UL; d < binsums_.size(); d++) {
+    sums_[d] += binsums_[d];
+    binsums_[d] = 0ULL;
+  }
+  count_ += bincount_;
+  bincount_ = 0UL;
+}
+
+template<class Archive>
+inline void
+StiffnessAccumulator::serialize(Archive& ar, const unsigned int /* version */)
+{
+  // clang-format off
+  ar & sizes_;
+  ar & beta_;
+  ar & binsize_;
+  ar & sums_;
+  ar & count_;
+  ar & binsums_;
+  ar & bincount_;
+  ar & carrysums_;
+  ar & carrycount_;
+  ar & windings_;
+  ar & stiffness_;
+  // clang-format on
+}
+
+} // namespace bwsl::accumulators
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,200 @@
+//===-- BondTableTest.cpp --------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the BondTable and PlaquetteTable Classes
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/BondTable.hpp>
+#include <bwsl/Lattice.hpp>
+#include <bwsl/PlaquetteTable.hpp>
+
+// std
+#include <algorithm>
+#include <vector>
+
+// catch
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+namespace {
+
+auto
+check_bonds(Lattice const& lattice) -> void
+{
+  auto const& bonds = lattice.GetBondTable();
+  auto const& table = lattice.GetNeighborTable();
+  REQUIRE(bonds.GetNumSites() == lattice.GetNumSites());
+
+  // every bond is held by two slots, one for each site
+  auto slots = std::vector<int>(bonds.GetNumBonds(), 0);
+  for (auto a = 0UL; a < lattice.GetNumSites(); a++) {
+    REQUIRE(bonds.GetBonds(a).size() == table.GetCoordination(a));
+    for (auto slot = 0UL; slot < table.GetCoordination(a); slot++) {
+      const auto k = bonds.GetBond(a, slot);
+      const auto b = table.GetNeighbor(a, slot);
+      REQUIRE(k < bonds.GetNumBonds());
+      REQUIRE(bonds.GetDirection(k) == table.GetDirection(a, slot) / 2UL);
+      if (table.GetDirection(a, slot) % 2UL == 0UL) {
+        REQUIRE(bonds.GetFirst(k) == a);
+        REQUIRE(bonds.GetSecond(k) == b);
+      } else {
+        REQUIRE(bonds.GetFirst(k) == b);
+        REQUIRE(bonds.GetSecond(k) == a);
+      }
+      slots[k]++;
+    }
+  }
+  for (auto count : slots) {
+    REQUIRE(count == 2);
+  }
+}
+
+auto
+check_plaquettes(Lattice const& lattice) -> void
+{
+  auto const& plaquettes = lattice.GetPlaquetteTable();
+  auto const& bonds = lattice.GetBondTable();
+  for (auto p = 0UL; p < plaquettes.GetNumPlaquettes(); p++) {
+    auto corners = plaquettes.GetCorners(p);
+    auto edges = plaquettes.GetBonds(p);
+    for (auto m = 0UL; m < corners.size(); m++) {
+      const auto a = corners[m];
+      const auto b = corners[(m + 1UL) % corners.size()];
+      const auto k = edges[m];
+      REQUIRE(((bonds.GetFirst(k) == a && bonds.GetSecond(k) == b) ||
+               (bonds.GetFirst(k) == b && bonds.GetSecond(k) == a)));
+    }
+  }
+  for (auto a = 0UL; a < lattice.GetNumSites(); a++) {
+    for (auto p : plaquettes.GetPlaquettes(a)) {
+      auto corners = plaquettes.GetCorners(p);
+      REQUIRE(std::find(corners.begin(), corners.end(), a) != corners.end());
+    }
+  }
+}
+
+} // namespace
+
+TEST_CASE("Bonds of lattices", "[lattice][bonds]")
+{
+  SECTION("Square lattice")
+  {
+    auto lattice = Lattice(SquareLattice, { 4UL, 5UL });
+    auto const& bonds = lattice.GetBondTable();
+    REQUIRE(bonds.GetNumBonds() == 40UL);
+
+    // the bonds wrapping around the grid
+    auto crossing = std::vector<int>(2UL, 0);
+    for (auto k = 0UL; k < bonds.GetNumBonds(); k++) {
+      if (bonds.CrossesBoundary(k)) {
+        REQUIRE((bonds.GetCrossing(k) == 1U || bonds.GetCrossing(k) == 2U));
+        crossing[bonds.GetCrossing(k) - 1U]++;
+      }
+    }
+    REQUIRE(crossing == std::vector<int>{ 5, 4 });
+    check_bonds(lattice);
+  }
+
+  SECTION("Open boundaries")
+  {
+    auto lattice = Lattice(SquareLattice, { 3UL, 4UL }, GridBoundaries::Open);
+    auto const& bonds = lattice.GetBondTable();
+    REQUIRE(bonds.GetNumBonds() == 17UL);
+    for (auto k = 0UL; k < bonds.GetNumBonds(); k++) {
+      REQUIRE_FALSE(bonds.CrossesBoundary(k));
+    }
+    check_bonds(lattice);
+  }
+
+  SECTION("Chain of two sites")
+  {
+    // the two bonds join the same sites, one of them wraps
+    auto lattice = Lattice(ChainLattice, { 2UL });
+    auto const& bonds = lattice.GetBondTable();
+    REQUIRE(bonds.GetNumBonds() == 2UL);
+    REQUIRE(bonds.GetBond(0UL, 0UL) != bonds.GetBond(0UL, 1UL));
+    REQUIRE(bonds.CrossesBoundary(bonds.GetBond(1UL, 0UL)));
+    REQUIRE_FALSE(bonds.CrossesBoundary(bonds.GetBond(0UL, 0UL)));
+    check_bonds(lattice);
+  }
+
+  SECTION("Triangular lattice")
+  {
+    auto lattice = Lattice(TriangularLattice, { 4UL, 3UL });
+    REQUIRE(lattice.GetBondTable().GetNumBonds() == 36UL);
+    check_bonds(lattice);
+  }
+}
+
+TEST_CASE("Plaquettes of lattices", "[lattice][bonds]")
+{
+  SECTION("Square lattice")
+  {
+    auto lattice = Lattice(SquareLattice, { 4UL, 4UL });
+    auto const& plaquettes = lattice.GetPlaquetteTable();
+    REQUIRE(plaquettes.GetNumPlaquettes() == 16UL);
+    for (auto p = 0UL; p < plaquettes.GetNumPlaquettes(); p++) {
+      REQUIRE(plaquettes.GetNumCorners(p) == 4UL);
+    }
+    for (auto a = 0UL; a < lattice.GetNumSites(); a++) {
+      REQUIRE(plaquettes.GetPlaquettes(a).size() == 4UL);
+    }
+    check_plaquettes(lattice);
+  }
+
+  SECTION("Triangular lattice")
+  {
+    auto lattice = Lattice(TriangularLattice, { 6UL, 6UL });
+    auto const& plaquettes = lattice.GetPlaquetteTable();
+    REQUIRE(plaquettes.GetNumPlaquettes() == 72UL);
+    for (auto p = 0UL; p < plaquettes.GetNumPlaquettes(); p++) {
+      REQUIRE(plaquettes.GetNumCorners(p) == 3UL);
+      auto c = plaquettes.GetCorners(p);
+      REQUIRE(lattice.AreNeighbors(c[0], c[1]));
+      REQUIRE(lattice.AreNeighbors(c[1], c[2]));
+      REQUIRE(lattice.AreNeighbors(c[2], c[0]));
+    }
+    for (auto a = 0UL; a < lattice.GetNumSites(); a++) {
+      REQUIRE(plaquettes.GetPlaquettes(a).size() == 6UL);
+    }
+    check_plaquettes(lattice);
+  }
+
+  SECTION("Cubic lattice")
+  {
+    auto lattice = Lattice(CubicLattice, { 3UL, 3UL, 4UL });
+    auto const& plaquettes = lattice.GetPlaquetteTable();
+    REQUIRE(plaquettes.GetNumPlaquettes() == 108UL);
+
+    // every bond belongs to four plaquettes
+    auto count = std::vector<int>(lattice.GetBondTable().GetNumBonds(), 0);
+    for (auto p = 0UL; p < plaquettes.GetNumPlaquettes(); p++) {
+      for (auto k : plaquettes.GetBonds(p)) {
+        count[k]++;
+      }
+    }
+    for (auto c : count) {
+      REQUIRE(c == 4);
+    }
+    check_plaquettes(lattice);
+  }
+
+  SECTION("Open boundaries")
+  {
+    auto lattice = Lattice(SquareLattice, { 3UL, 4UL }, GridBoundaries::Open);
+    REQUIRE(lattice.GetPlaquetteTable().GetNumPlaquettes() == 6UL);
+    check_plaquettes(lattice);
+  }
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -212,4 +212,36 @@ TEST_CASE("Triangular Lattice")
         REQUIRE(n[j] == neighbors[idx][j]);
     }
   }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Metric of the primitive vectors")
+{
+  auto square = SquareLattice.GetMetric();
+  REQUIRE(square.size() == 4UL);
+  REQUIRE(square[0] == CApprox(1.0));
+  REQUIRE(square[1] == CApprox(0.0).margin(1e-12));
+  REQUIRE(square[2] == CApprox(0.0).margin(1e-12));
+  REQUIRE(square[3] == CApprox(1.0));
+
+  auto triangular = TriangularLattice.GetMetric();
+  REQUIRE(triangular[0] == CApprox(1.0));
+  REQUIRE(std::abs(triangular[1]) == CApprox(0.5));
+  REQUIRE(triangular[2] == CApprox(triangular[1]));
+  REQUIRE(triangular[3] == CApprox(1.0));
+}
+
+TEST_CASE("Displacements of the neighbors")
+{
+  auto lattices = { ChainLattice, SquareLattice, TriangularLattice };
+  for (auto const& bravais : lattices) {
+    auto vectors = bravais.GetNeighborVectors();
+    REQUIRE(vectors.size() == bravais.GetGamma());
+    auto point = Bravais::coords_t(bravais.GetDim(), 3L);
+    for (auto idx = 0UL; idx < vectors.size(); idx++) {
+      auto n = bravais.GetNeighbor(point, idx);
+      for (auto d = 0UL; d < bravais.GetDim(); d++) {
+        REQUIRE(n[d] - point[d] == vectors[idx][d]);
+      }
+    }
+  }
+}
@@ -0,0 +1,175 @@
+//===-- ClusterLabelingTest.cpp --------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the ClusterLabeling Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/ClusterLabeling.hpp>
+#include <bwsl/Lattice.hpp>
+#include <bwsl/ThreadPool.hpp>
+
+// std
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// catch
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+namespace {
+
+/// Sizes of the clusters found by a serial flood fill, in the order of their
+/// smallest site
+auto
+flood_fill(Lattice const& lattice, std::vector<int> const& occupations)
+  -> std::vector<std::size_t>
+{
+  const auto n = lattice.GetNumSites();
+  auto seen = std::vector<bool>(n, false);
+  auto sizes = std::vector<std::size_t>{};
+  for (auto i = 0UL; i < n; i++) {
+    if (occupations[i] == 0 || seen[i]) {
+      continue;
+    }
+    auto stack = std::vector<std::size_t>{ i };
+    seen[i] = true;
+    auto size = 0UL;
+    while (!stack.empty()) {
+      auto a = stack.back();
+      stack.pop_back();
+      size++;
+      for (auto b : lattice.GetNeighbors(a)) {
+        if (occupations[b] != 0 && !seen[b]) {
+          seen[b] = true;
+          stack.push_back(b);
+        }
+      }
+    }
+    sizes.push_back(size);
+  }
+  return sizes;
+}
+
+} // namespace
+
+TEST_CASE("Clusters of random occupations", "[lattice][percolation]")
+{
+  auto rng = std::mt19937_64(11UL);
+  auto pool = ThreadPool(4UL);
+  auto lattices = std::vector<Lattice>{
+    Lattice(SquareLattice, { 20UL, 16UL }),
+    Lattice(SquareLattice, { 20UL, 16UL }, GridBoundaries::Open),
+    Lattice(TriangularLattice, { 12UL, 12UL }),
+    Lattice(CubicLattice, { 6UL, 5UL, 7UL }),
+  };
+  for (auto const& lattice : lattices) {
+    const auto n = lattice.GetNumSites();
+    auto labeling = ClusterLabeling(lattice);
+    for (auto fill : { 0.3, 0.5, 0.7 }) {
+      auto coin = std::bernoulli_distribution(fill);
+      auto occupations = std::vector<int>(n);
+      for (auto& x : occupations) {
+        x = coin(rng) ? 1 : 0;
+      }
+      REQUIRE(labeling.Label(pool, occupations) ==
+              flood_fill(lattice, occupations).size());
+      REQUIRE(labeling.GetSizes() == flood_fill(lattice, occupations));
+      for (auto a = 0UL; a < n; a++) {
+        REQUIRE((labeling.GetLabel(a) == ClusterLabeling::NoCluster) ==
+                (occupations[a] == 0));
+        for (auto b : lattice.GetNeighbors(a)) {
+          if (occupations[a] != 0 && occupations[b] != 0) {
+            REQUIRE(labeling.GetLabel(a) == labeling.GetLabel(b));
+          }
+        }
+      }
+
+      // the labels do not depend on the number of threads
+      auto serial = ThreadPool(1UL);
+      auto labels = labeling.GetLabels();
+      labeling.Label(serial, occupations);
+      REQUIRE(labeling.GetLabels() == labels);
+    }
+  }
+}
+
+TEST_CASE("Wrapping and spanning clusters", "[lattice][percolation]")
+{
+  auto pool = ThreadPool(2UL);
+
+  SECTION("Closed boundaries")
+  {
+    auto lattice = Lattice(SquareLattice, { 6UL, 5UL });
+    auto labeling = ClusterLabeling(lattice);
+
+    // a full row along the direction 0
+    auto occupations = std::vector<double>(lattice.GetNumSites(), 0.0);
+    for (auto x = 0L; x < 6L; x++) {
+      occupations[lattice.GetIndex({ x, 2L })] = 0.5;
+    }
+    REQUIRE(labeling.Label(pool, occupations) == 1UL);
+    REQUIRE(labeling.IsWrapping(0UL, 0UL));
+    REQUIRE_FALSE(labeling.IsWrapping(0UL, 1UL));
+    REQUIRE(labeling.Wraps(0UL));
+    REQUIRE(labeling.GetLargestFraction() == 0.2);
+
+    // a row with a hole spans without wrapping
+    occupations[lattice.GetIndex({ 3L, 2L })] = 0.0;
+    REQUIRE(labeling.Label(pool, occupations) == 1UL);
+    REQUIRE_FALSE(labeling.Wraps(0UL));
+    REQUIRE_FALSE(labeling.Spans(0UL));
+
+    // a diagonal staircase winds along both directions
+    auto stairs = std::vector<int>(lattice.GetNumSites(), 0);
+    auto c = lattice.MakeCoords();
+    for (auto step = 0; step < 30; step++) {
+      stairs[lattice.GetIndex(c)] = 1;
+      c[static_cast<std::size_t>(step % 2)]++;
+      lattice.EnforceBoundaries(c);
+    }
+    labeling.Label(pool, stairs);
+    REQUIRE(labeling.Wraps(0UL));
+    REQUIRE(labeling.Wraps(1UL));
+
+    // everything occupied
+    auto full = std::vector<int>(lattice.GetNumSites(), 1);
+    REQUIRE(labeling.Label(pool, full) == 1UL);
+    REQUIRE(labeling.GetWrapping(0UL) == 3U);
+    REQUIRE(labeling.GetLargestFraction() == 1.0);
+  }
+
+  SECTION("Open boundaries")
+  {
+    auto lattice = Lattice(SquareLattice, { 6UL, 5UL }, GridBoundaries::Open);
+    auto labeling = ClusterLabeling(lattice);
+    auto occupations = std::vector<int>(lattice.GetNumSites(), 0);
+    for (auto y = 0L; y < 5L; y++) {
+      occupations[lattice.GetIndex({ 1L, y })] = 1;
+    }
+    REQUIRE(labeling.Label(pool, occupations) == 1UL);
+    REQUIRE(labeling.IsSpanning(0UL, 1UL));
+    REQUIRE_FALSE(labeling.IsSpanning(0UL, 0UL));
+    REQUIRE_FALSE(labeling.Wraps(1UL));
+  }
+
+  SECTION("Empty lattice")
+  {
+    auto lattice = Lattice(ChainLattice, { 10UL });
+    auto labeling = ClusterLabeling(lattice);
+    REQUIRE(labeling.Label(pool, std::vector<int>(10UL, 0)) == 0UL);
+    REQUIRE(labeling.GetLargestFraction() == 0.0);
+  }
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
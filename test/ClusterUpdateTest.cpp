@@ -0,0 +1,156 @@
+//===-- ClusterUpdateTest.cpp ----------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the ClusterUpdate and ConcurrentUnionFind Classes
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/ClusterUpdate.hpp>
+#include <bwsl/Lattice.hpp>
+#include <bwsl/ThreadPool.hpp>
+#include <bwsl/UnionFind.hpp>
+
+// std
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+namespace {
+
+using spins_t = std::vector<std::int8_t>;
+
+/// Energy of @p spins with unit ferromagnetic coupling on the bonds
+auto
+energy(BondTable const& bonds, spins_t const& spins) -> double
+{
+  auto e = 0.0;
+  for (auto k = 0UL; k < bonds.GetNumBonds(); k++) {
+    e -= spins[bonds.GetFirst(k)] * spins[bonds.GetSecond(k)];
+  }
+  return e;
+}
+
+/// Exact average energy by enumeration of all the configurations
+auto
+exact_energy(BondTable const& bonds, double beta) -> double
+{
+  const auto n = bonds.GetNumSites();
+  auto z = 0.0;
+  auto e = 0.0;
+  for (auto c = 0UL; c < (1UL << n); c++) {
+    auto spins = spins_t(n);
+    for (auto i = 0UL; i < n; i++) {
+      spins[i] = ((c >> i) & 1UL) != 0UL ? 1 : -1;
+    }
+    const auto x = energy(bonds, spins);
+    z += std::exp(-beta * x);
+    e += x * std::exp(-beta * x);
+  }
+  return e / z;
+}
+
+} // namespace
+
+TEST_CASE("Concurrent union find", "[cluster]")
+{
+  const auto n = 10000UL;
+  auto sets = ConcurrentUnionFind(n);
+  auto pool = ThreadPool(4UL);
+
+  // join the elements with the same remainder modulo 7
+  pool.ParallelFor(0UL, n - 7UL, [&](std::size_t i) {
+    sets.Unite(n - 1UL - i, n - 8UL - i);
+  });
+  for (auto i = 0UL; i < n; i++) {
+    REQUIRE(sets.Find(i) == i % 7UL);
+    REQUIRE(sets.IsRoot(i) == (i < 7UL));
+  }
+  REQUIRE_FALSE(sets.Unite(3UL, 10UL));
+  REQUIRE(sets.Unite(3UL, 11UL));
+  REQUIRE(sets.Find(11UL) == 3UL);
+  REQUIRE(sets.Find(4UL) == 3UL);
+}
+
+TEST_CASE("Cluster updates", "[lattice][cluster]")
+{
+  auto lattice = Lattice(SquareLattice, { 8UL, 6UL });
+  auto const& bonds = lattice.GetBondTable();
+  const auto n = lattice.GetNumSites();
+  auto pool = ThreadPool(4UL);
+
+  SECTION("Limits of the probability")
+  {
+    auto update = ClusterUpdate(bonds, 7UL);
+    auto spins = spins_t(n, 1);
+    REQUIRE(update.SwendsenWang(pool, spins, 0.0) == n);
+    REQUIRE(update.Wolff(pool, spins, 0.0) == 1UL);
+
+    spins.assign(n, -1);
+    REQUIRE(update.SwendsenWang(pool, spins, 1.0) == 1UL);
+    REQUIRE(update.GetCluster(n - 1UL) == 0UL);
+    REQUIRE(update.Wolff(pool, spins, 1.0) == n);
+    REQUIRE(spins == spins_t(n, spins[0]));
+    REQUIRE(update.GetNumUpdates() == 4UL);
+  }
+
+  SECTION("Independence of the number of threads")
+  {
+    auto run = [&](std::size_t numthreads) {
+      auto threads = ThreadPool(numthreads);
+      auto update = ClusterUpdate(bonds, 42UL);
+      auto spins = spins_t(n, 1);
+      auto sizes = std::vector<std::size_t>{};
+      const auto p = ClusterUpdate::GetBondProbability(0.44);
+      for (auto s = 0; s < 20; s++) {
+        sizes.push_back(update.SwendsenWang(threads, spins, p));
+        sizes.push_back(update.Wolff(threads, spins, p));
+      }
+      return std::make_pair(sizes, spins);
+    };
+    REQUIRE(run(1UL) == run(4UL));
+  }
+}
+
+TEST_CASE("Cluster updates sample the Ising model", "[lattice][cluster]")
+{
+  // a small lattice whose configurations can be enumerated
+  auto lattice = Lattice(SquareLattice, { 4UL, 3UL });
+  auto const& bonds = lattice.GetBondTable();
+  const auto beta = 0.3;
+  const auto p = ClusterUpdate::GetBondProbability(beta);
+  const auto expected = exact_energy(bonds, beta);
+  const auto steps = 40000;
+  auto pool = ThreadPool(2UL);
+
+  auto update = ClusterUpdate(bonds, 1234UL);
+  auto spins = spins_t(lattice.GetNumSites(), 1);
+  auto sw = 0.0;
+  for (auto s = 0; s < steps; s++) {
+    update.SwendsenWang(pool, spins, p);
+    sw += energy(bonds, spins);
+  }
+  REQUIRE(sw / steps == Catch::Approx(expected).epsilon(0.02));
+
+  auto wolff = 0.0;
+  for (auto s = 0; s < steps; s++) {
+    update.Wolff(pool, spins, p);
+    wolff += energy(bonds, spins);
+  }
+  REQUIRE(wolff / steps == Catch::Approx(expected).epsilon(0.02));
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
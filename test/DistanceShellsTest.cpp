@@ -0,0 +1,158 @@
+//===-- DistanceShellsTest.cpp ---------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the DistanceShells Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/DistanceShells.hpp>
+#include <bwsl/Lattice.hpp>
+
+// std
+#include <cmath>
+#include <set>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+namespace {
+
+auto
+check_shells(Lattice const& lattice) -> void
+{
+  auto const& shells = lattice.GetDistanceShells();
+  const auto n = lattice.GetNumSites();
+  REQUIRE(shells.GetNumSites() == n);
+  REQUIRE(shells.GetShell(0UL) == 0UL);
+  REQUIRE(shells.GetMultiplicity(0UL) == 1UL);
+
+  auto total = 0UL;
+  for (auto k = 0UL; k < shells.GetNumShells(); k++) {
+    total += shells.GetMultiplicity(k);
+    if (k > 0UL) {
+      REQUIRE(shells.GetRadius(k) > shells.GetRadius(k - 1UL) + 1e-6);
+    }
+    for (auto s : shells.GetSites(k)) {
+      REQUIRE(lattice.GetDistance(0UL, s) ==
+              Catch::Approx(shells.GetRadius(k)));
+    }
+  }
+  REQUIRE(total == n);
+
+  for (auto k = 1UL; k < shells.GetNumShells(); k++) {
+    auto const& table = lattice.GetShellNeighborTable(k);
+    REQUIRE(table.GetNumSites() == n);
+    REQUIRE(table.HasUniformCoordination());
+    for (auto a = 0UL; a < n; a++) {
+      auto expected = std::set<size_t>{};
+      for (auto b = 0UL; b < n; b++) {
+        if (lattice.GetShell(a, b) == k) {
+          expected.insert(b);
+        }
+      }
+      auto row = table.GetNeighbors(a);
+      REQUIRE(std::set<size_t>(row.begin(), row.end()) == expected);
+      for (auto slot = 0UL; slot < row.size(); slot++) {
+        auto b = row[slot];
+        REQUIRE(table.GetNeighbor(b, table.GetOppositeSlot(a, slot)) == a);
+      }
+    }
+  }
+}
+
+} // namespace
+
+TEST_CASE("Metric scales", "[shells]")
+{
+  REQUIRE(DistanceShells::GetMetricScale({ 1.0, 0.0, 0.0, 1.0 }) == 1L);
+  REQUIRE(DistanceShells::GetMetricScale({ 1.0, 0.5, 0.5, 1.0 }) == 2L);
+  REQUIRE(DistanceShells::GetMetricScale({ 1.0, 0.0, 0.0, 2.0 / 3.0 }) == 3L);
+  REQUIRE(DistanceShells::GetMetricScale({ 1.0, 0.0, 0.0, M_SQRT2 }) == 0L);
+}
+
+TEST_CASE("Shells from squared distances", "[shells]")
+{
+  auto shells =
+    DistanceShells::FromSquaredDistances({ 0.0, 2.0, 1.0, 1.0 + 1e-12, 2.0 });
+  REQUIRE_FALSE(shells.IsExact());
+  REQUIRE(shells.GetNumShells() == 3UL);
+  REQUIRE(shells.GetShell(0UL) == 0UL);
+  REQUIRE(shells.GetShell(2UL) == 1UL);
+  REQUIRE(shells.GetShell(3UL) == 1UL);
+  REQUIRE(shells.GetShell(1UL) == 2UL);
+  REQUIRE(shells.GetMultiplicity(2UL) == 2UL);
+  REQUIRE(shells.GetSites(2UL) == std::vector<size_t>{ 1UL, 4UL });
+}
+
+TEST_CASE("Distance shells of lattices", "[lattice][shells]")
+{
+  SECTION("Square lattice")
+  {
+    auto lattice = Lattice(SquareLattice, { 6UL, 6UL });
+    auto const& shells = lattice.GetDistanceShells();
+    REQUIRE(shells.IsExact());
+
+    // squared norms 0, 1, 2, 4, 5, 8, 9, 10, 13, 18, with the sites at half
+    // the size counted once
+    auto multiplicities = std::vector<size_t>{ 1, 4, 4, 4, 8, 4, 2, 4, 4, 1 };
+    REQUIRE(shells.GetNumShells() == multiplicities.size());
+    for (auto k = 0UL; k < multiplicities.size(); k++) {
+      REQUIRE(shells.GetMultiplicity(k) == multiplicities[k]);
+    }
+    REQUIRE(shells.GetNorm(4UL) == 5L);
+
+    // the first shell are the nearest neighbors
+    auto const& first = lattice.GetShellNeighborTable(1UL);
+    for (auto a = 0UL; a < lattice.GetNumSites(); a++) {
+      for (auto b : first.GetNeighbors(a)) {
+        REQUIRE(lattice.AreNeighbors(a, b));
+      }
+    }
+
+    // a site opposite to itself fills a pair of slots
+    REQUIRE(lattice.GetShellNeighborTable(6UL).GetStride() == 4UL);
+    check_shells(lattice);
+  }
+
+  SECTION("Triangular lattice")
+  {
+    auto lattice = Lattice(TriangularLattice, { 6UL, 4UL });
+    REQUIRE(lattice.GetDistanceShells().IsExact());
+    REQUIRE(lattice.GetDistanceShells().GetMultiplicity(1UL) == 6UL);
+    check_shells(lattice);
+  }
+
+  SECTION("Cubic lattice")
+  {
+    auto lattice = Lattice(CubicLattice, { 4UL, 3UL, 5UL });
+    REQUIRE(lattice.GetDistanceShells().IsExact());
+    check_shells(lattice);
+  }
+
+  SECTION("Lattice with an irrational metric")
+  {
+    const auto side = std::sqrt(M_SQRT2);
+    auto bravais = Bravais(2UL,
+                           4UL,
+                           { 1.0, 0.0, 0.0, side },
+                           { 1.0, 0.0, 0.0, 1.0 / side },
+                           { 1L, 0L, 0L, 1L });
+    auto lattice = Lattice(bravais, { 5UL, 4UL });
+    REQUIRE_FALSE(lattice.GetDistanceShells().IsExact());
+    check_shells(lattice);
+  }
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
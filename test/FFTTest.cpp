@@ -0,0 +1,116 @@
+//===-- FFTTest.cpp --------------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the FFT Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/FFT.hpp>
+#include <bwsl/MathUtils.hpp>
+
+// std
+#include <cmath>
+#include <complex>
+#include <random>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+using CApprox = Catch::Approx;
+using complex_t = FFT::complex_t;
+
+namespace {
+
+/// Reference discrete Fourier transform computed with the definition
+auto
+naive_dft(std::vector<complex_t> const& data,
+          std::vector<size_t> const& size,
+          double sign) -> std::vector<complex_t>
+{
+  auto n = data.size();
+  auto result = std::vector<complex_t>(n);
+  for (auto q = 0UL; q < n; q++) {
+    auto cq = index_to_array<std::vector<long>>(q, size);
+    for (auto x = 0UL; x < n; x++) {
+      auto cx = index_to_array<std::vector<long>>(x, size);
+      auto phase = 0.0;
+      for (auto d = 0UL; d < size.size(); d++) {
+        phase += 2.0 * M_PI * static_cast<double>(cq[d] * cx[d]) /
+                 static_cast<double>(size[d]);
+      }
+      result[q] += data[x] * std::polar(1.0, sign * phase);
+    }
+  }
+  return result;
+}
+
+auto
+random_signal(size_t n) -> std::vector<complex_t>
+{
+  auto rng = std::mt19937_64{ 42UL };
+  auto dist = std::uniform_real_distribution<double>{ -1.0, 1.0 };
+  auto data = std::vector<complex_t>(n);
+  for (auto& x : data) {
+    x = complex_t(dist(rng), dist(rng));
+  }
+  return data;
+}
+
+} // namespace
+
+TEST_CASE("FFT matches the discrete Fourier transform", "[fft]")
+{
+  auto sizes = std::vector<std::vector<size_t>>{
+    { 1 },    { 2 },     { 8 },        { 12 },   { 7 },
+    { 30 },   { 49 },    { 4, 6 },     { 5, 3 }, { 16, 1, 2 },
+    { 3, 4, 5 }, { 11, 13 }, { 2, 2, 2, 2 }, { 9 },  { 25 },
+    { 45 },   { 75, 2 },
+  };
+
+  for (auto const& size : sizes) {
+    auto fft = FFT(size);
+    auto n = accumulate_product(size);
+    REQUIRE(fft.GetNumPoints() == n);
+
+    auto data = random_signal(n);
+
+    // forward transform
+    auto forward = data;
+    auto expected = naive_dft(data, size, -1.0);
+    fft.Transform(forward);
+    for (auto i = 0UL; i < n; i++) {
+      REQUIRE(forward[i].real() == CApprox(expected[i].real()).margin(1e-9));
+      REQUIRE(forward[i].imag() == CApprox(expected[i].imag()).margin(1e-9));
+    }
+
+    // backward transform
+    auto backward = data;
+    expected = naive_dft(data, size, 1.0);
+    fft.Transform(backward, FFT::direction_t::Backward);
+    for (auto i = 0UL; i < n; i++) {
+      REQUIRE(backward[i].real() == CApprox(expected[i].real()).margin(1e-9));
+      REQUIRE(backward[i].imag() == CApprox(expected[i].imag()).margin(1e-9));
+    }
+
+    // round trip
+    fft.Transform(forward, FFT::direction_t::Backward);
+    for (auto i = 0UL; i < n; i++) {
+      auto x = forward[i] / static_cast<double>(n);
+      REQUIRE(x.real() == CApprox(data[i].real()).margin(1e-12));
+      REQUIRE(x.imag() == CApprox(data[i].imag()).margin(1e-12));
+    }
+  }
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,65 @@
+//===-- FastDivisionTest.cpp -----------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the FastDivisor Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/FastDivision.hpp>
+
+// std
+#include <cstdint>
+#include <limits>
+#include <random>
+
+// catch
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+TEST_CASE("Division by invariant integers", "[division]")
+{
+  auto rng = std::mt19937_64(42UL);
+  const auto maxval = std::numeric_limits<std::uint64_t>::max();
+
+  SECTION("Small divisors")
+  {
+    for (auto d = 1UL; d < 1000UL; d++) {
+      auto div = FastDivisor(d);
+      REQUIRE(div.GetDivisor() == d);
+      for (auto n = 0UL; n < 2000UL; n++) {
+        REQUIRE(div.Divide(n) == n / d);
+        REQUIRE(div.Modulo(n) == n % d);
+      }
+      for (auto k = 0UL; k < 100UL; k++) {
+        auto n = rng();
+        REQUIRE(div.Divide(n) == n / d);
+      }
+      REQUIRE(div.Divide(maxval) == maxval / d);
+    }
+  }
+
+  SECTION("Large divisors")
+  {
+    for (auto k = 0UL; k < 10000UL; k++) {
+      auto d = rng() >> (rng() % 64UL);
+      d = d == 0UL ? 1UL : d;
+      auto div = FastDivisor(d);
+      auto n = rng();
+      REQUIRE(div.Divide(n) == n / d);
+      REQUIRE(div.Divide(maxval) == maxval / d);
+      REQUIRE(div.Divide(d - 1UL) == 0UL);
+      REQUIRE(div.Divide(d) == 1UL);
+    }
+  }
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -16,6 +16,7 @@
 #include <bwsl/HyperCubicGrid.hpp>
 
 // std
+#include <array>
 #include <vector>
 
 // catch
@@ -133,4 +134,153 @@ TEST_CASE("Grid with open boundaries addressed with indices and coordinates",
   }
 }
 
+TEST_CASE("Grid with the dimension fixed at compile time",
+          "[index][coordinates]")
+{
+  auto h = HyperCubicGrid2D({ 3UL, 4UL }, GridBoundaries::Closed);
+  auto g = HyperCubicGrid({ 3UL, 4UL }, GridBoundaries::Closed);
+
+  REQUIRE(h.GetNumSites() == 12UL);
+  REQUIRE(h.GetDim() == 2UL);
+
+  for (auto i = 0UL; i < h.GetNumSites(); i++) {
+    auto c = h.GetCoordinates(i);
+    REQUIRE(h.GetIndex(c) == i);
+    REQUIRE(c[0] == g.GetCoordinates(i)[0]);
+    REQUIRE(c[1] == g.GetCoordinates(i)[1]);
+    for (auto j = 0UL; j < h.GetNumSites(); j++) {
+      REQUIRE(h.GetMappedSite(i, j) == g.GetMappedSite(i, j));
+      REQUIRE(h.GetUnMappedSite(h.GetMappedSite(i, j), i) == j);
+      auto jump = h.GetJump(i, j);
+      REQUIRE(jump[0] == g.GetJump(i, j)[0]);
+      REQUIRE(jump[1] == g.GetJump(i, j)[1]);
+    }
+  }
+}
+
+TEST_CASE("Strides and iteration over the sites", "[index][coordinates]")
+{
+  auto h = HyperCubicGrid({ 3UL, 5UL, 4UL }, GridBoundaries::Closed);
+  auto f = HyperCubicGrid3D({ 3UL, 5UL, 4UL }, GridBoundaries::Open);
+
+  REQUIRE(h.GetStrides() == vector<size_t>{ 20UL, 4UL, 1UL });
+  REQUIRE(f.GetStrides()[0] == 20UL);
+
+  SECTION("Coordinates are the same computed with divisions")
+  {
+    for (auto i = 0UL; i < h.GetNumSites(); i++) {
+      auto c = h.GetCoordinates(i);
+      REQUIRE(c == index_to_array<vector<long>>(i, h.GetSize()));
+      REQUIRE(array_to_index(c, h.GetSize()) == i);
+    }
+  }
+
+  SECTION("The sites are visited in order")
+  {
+    auto count = 0UL;
+    for (auto const& site : h.GetSites()) {
+      REQUIRE(site.index == count);
+      REQUIRE(site.coords == h.GetCoordinates(count));
+      count++;
+    }
+    REQUIRE(count == h.GetNumSites());
+
+    count = 0UL;
+    for (auto const& site : f.GetSites()) {
+      REQUIRE(site.index == count);
+      REQUIRE(site.coords == f.GetCoordinates(count));
+      count++;
+    }
+    REQUIRE(count == f.GetNumSites());
+  }
+}
+
+TEST_CASE("Grid with power of two sizes", "[index][coordinates]")
+{
+  auto check = [](auto const& h) {
+    REQUIRE(h.HasPowerOfTwoSizes());
+    auto const& size = h.GetSize();
+    for (auto a = 0UL; a < h.GetNumSites(); a++) {
+      auto ca = h.GetCoordinates(a);
+      for (auto b = 0UL; b < h.GetNumSites(); b++) {
+        auto cb = h.GetCoordinates(b);
+        auto mapped = h.GetCoordinates(h.GetMappedSite(a, b));
+        auto jump = h.GetJump(a, b);
+        for (auto i = 0UL; i < h.GetDim(); i++) {
+          auto s = static_cast<long>(size[i]);
+          auto diff = ((cb[i] - ca[i]) % s + s) % s;
+          REQUIRE(mapped[i] == diff);
+          REQUIRE(jump[i] == (diff > s / 2L ? diff - s : diff));
+        }
+        REQUIRE(h.GetUnMappedSite(h.GetMappedSite(a, b), a) == b);
+      }
+    }
+
+    auto c = h.MakeCoords(-1L);
+    h.EnforceBoundaries(c);
+    for (auto i = 0UL; i < h.GetDim(); i++) {
+      REQUIRE(c[i] == static_cast<long>(size[i]) - 1L);
+    }
+  };
+
+  check(HyperCubicGrid({ 4UL, 8UL, 2UL }, GridBoundaries::Closed));
+  check(HyperCubicGrid2D({ 16UL, 1UL }, GridBoundaries::Closed));
+  check(HyperCubicGrid1D({ 32UL }, GridBoundaries::Closed));
+  REQUIRE_FALSE(
+    HyperCubicGrid({ 4UL, 6UL }, GridBoundaries::Closed).HasPowerOfTwoSizes());
+}
+
+TEST_CASE("Grid numbered along the Morton curve", "[index][morton]")
+{
+  auto check = [](auto const& h) {
+    REQUIRE(h.GetOrdering() == GridOrdering::Morton);
+    auto const& size = h.GetSize();
+    auto rowmajor = std::vector<size_t>(h.GetNumSites());
+    for (auto a = 0UL; a < h.GetNumSites(); a++) {
+      auto ca = h.GetCoordinates(a);
+      REQUIRE(h.GetIndex(ca) == a);
+      REQUIRE(h.GetIndexFromRowMajor(h.GetRowMajorIndex(a)) == a);
+      rowmajor[h.GetRowMajorIndex(a)] = a;
+      for (auto b = 0UL; b < h.GetNumSites() && h.HasClosedBoundaries(); b++) {
+        auto cb = h.GetCoordinates(b);
+        auto mapped = h.GetCoordinates(h.GetMappedSite(a, b));
+        for (auto i = 0UL; i < h.GetDim(); i++) {
+          auto s = static_cast<long>(size[i]);
+          REQUIRE(mapped[i] == ((cb[i] - ca[i]) % s + s) % s);
+        }
+        REQUIRE(h.GetUnMappedSite(h.GetMappedSite(a, b), a) == b);
+      }
+    }
+
+    // the site with each row-major index, in the order of the sites, is the
+    // site itself
+    auto sites = h.FromRowMajor(rowmajor);
+    for (auto a = 0UL; a < h.GetNumSites(); a++) {
+      REQUIRE(sites[a] == a);
+    }
+    REQUIRE(h.ToRowMajor(sites) == rowmajor);
+
+    auto count = 0UL;
+    for (auto const& site : h.GetSites()) {
+      REQUIRE(site.index == count);
+      REQUIRE(site.coords == h.GetCoordinates(count));
+      count++;
+    }
+    REQUIRE(count == h.GetNumSites());
+  };
+
+  auto morton = GridOrdering::Morton;
+  check(HyperCubicGrid({ 4UL, 4UL }, GridBoundaries::Closed, morton));
+  check(HyperCubicGrid({ 3UL, 5UL, 2UL }, GridBoundaries::Closed, morton));
+  check(HyperCubicGrid3D({ 4UL, 2UL, 8UL }, GridBoundaries::Open, morton));
+
+  // the sites of each 2 x 2 block are consecutive
+  auto h = HyperCubicGrid2D({ 4UL, 4UL }, GridBoundaries::Closed, morton);
+  REQUIRE(h.GetCoordinates(0UL) == std::array<long, 2>{ 0L, 0L });
+  REQUIRE(h.GetCoordinates(1UL) == std::array<long, 2>{ 0L, 1L });
+  REQUIRE(h.GetCoordinates(2UL) == std::array<long, 2>{ 1L, 0L });
+  REQUIRE(h.GetCoordinates(3UL) == std::array<long, 2>{ 1L, 1L });
+  REQUIRE(h.GetCoordinates(4UL) == std::array<long, 2>{ 0L, 2L });
+}
+
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,242 @@
+//===-- LatticeFileTest.cpp ------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the LatticeFile Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/Lattice.hpp>
+#include <bwsl/LatticeFile.hpp>
+#include <bwsl/SharedSegment.hpp>
+
+// std
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// catch
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+namespace {
+
+auto
+temp_name(std::string const& name) -> std::string
+{
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+auto
+check_same_tables(Lattice const& built, Lattice const& loaded) -> void
+{
+  auto n = built.GetNumSites();
+  REQUIRE(loaded.GetNumSites() == n);
+  for (auto i = 0UL; i < n; i++) {
+    REQUIRE(loaded.GetPosition(i) == built.GetPosition(i));
+    if (built.HasClosedBoundaries()) {
+      REQUIRE(loaded.GetMomentum(i) == built.GetMomentum(i));
+    }
+    auto nb = built.GetNeighbors(i);
+    auto nl = loaded.GetNeighbors(i);
+    REQUIRE(std::vector<size_t>(nl.begin(), nl.end()) ==
+            std::vector<size_t>(nb.begin(), nb.end()));
+    for (auto s = 0UL; s < nb.size(); s++) {
+      REQUIRE(loaded.GetNeighborDirection(i, s) ==
+              built.GetNeighborDirection(i, s));
+      REQUIRE(loaded.GetOppositeSlot(i, s) == built.GetOppositeSlot(i, s));
+    }
+    REQUIRE(loaded.GetVector(0UL, i) == built.GetVector(0UL, i));
+    REQUIRE(loaded.GetDistance(0UL, i) == built.GetDistance(0UL, i));
+    for (auto j = 0UL; j < n && built.HasClosedBoundaries(); j++) {
+      REQUIRE(loaded.GetVector(i, j) == built.GetVector(i, j));
+      REQUIRE(loaded.GetDistance(i, j) == built.GetDistance(i, j));
+    }
+  }
+
+  auto occupations = std::vector<double>(n, 0.0);
+  for (auto i = 0UL; i < n; i += 3UL) {
+    occupations[i] = 1.0;
+  }
+  REQUIRE(loaded.ComputeSk(occupations) == built.ComputeSk(occupations));
+}
+
+} // namespace
+
+TEST_CASE("Saving and loading lattices", "[lattice][file]")
+{
+  const auto fname = temp_name("bwsl-lattice-file-test.bin");
+
+  SECTION("Closed boundaries")
+  {
+    auto built = Lattice(TriangularLattice, { 6UL, 5UL });
+    built.Save(fname);
+    auto loaded = Lattice::Load(fname, TriangularLattice, { 6UL, 5UL });
+    REQUIRE_FALSE(loaded.GetNeighborTable().GetIndices().IsOwning());
+    check_same_tables(built, loaded);
+  }
+
+  SECTION("Open boundaries and non uniform coordination")
+  {
+    auto open = Lattice::boundaries_t::Open;
+    auto built = Lattice(CubicLattice, { 4UL, 3UL, 2UL }, open);
+    built.Save(fname);
+    auto loaded = Lattice::Load(fname, CubicLattice, { 4UL, 3UL, 2UL }, open);
+    check_same_tables(built, loaded);
+  }
+
+  SECTION("Tables not stored are saved as well")
+  {
+    auto options = LatticeOptions{};
+    options.tables = LatticeTable::None;
+    options.materialize = false;
+    Lattice(TriangularLattice,
+            { 6UL, 5UL },
+            Lattice::boundaries_t::Closed,
+            options)
+      .Save(fname);
+    auto loaded = Lattice::Load(fname, TriangularLattice, { 6UL, 5UL });
+    check_same_tables(Lattice(TriangularLattice, { 6UL, 5UL }), loaded);
+  }
+
+  SECTION("The tables outlive the lattice file")
+  {
+    Lattice(SquareLattice, { 4UL, 4UL }).Save(fname);
+    auto loaded = Lattice::Load(fname, SquareLattice, { 4UL, 4UL });
+    std::remove(fname.c_str());
+    auto copy = loaded;
+    loaded = Lattice();
+    check_same_tables(Lattice(SquareLattice, { 4UL, 4UL }), copy);
+  }
+
+  std::remove(fname.c_str());
+}
+
+TEST_CASE("Rejecting lattice files", "[lattice][file]")
+{
+  const auto fname = temp_name("bwsl-lattice-file-reject.bin");
+  Lattice(SquareLattice, { 4UL, 3UL }).Save(fname);
+
+  SECTION("Different lattices")
+  {
+    REQUIRE_THROWS_AS(Lattice::Load(fname, SquareLattice, { 3UL, 4UL }),
+                      exception::BadLatticeFile);
+    REQUIRE_THROWS_AS(Lattice::Load(fname, TriangularLattice, { 4UL, 3UL }),
+                      exception::BadLatticeFile);
+    REQUIRE_THROWS_AS(Lattice::Load(fname,
+                                    SquareLattice,
+                                    { 4UL, 3UL },
+                                    Lattice::boundaries_t::Open),
+                      exception::BadLatticeFile);
+  }
+
+  SECTION("Corrupted file")
+  {
+    {
+      auto io = std::fstream(fname, std::ios::in | std::ios::out |
+                                      std::ios::binary | std::ios::ate);
+      const auto size = static_cast<long>(io.tellg());
+      io.seekg(size - 70L);
+      auto c = static_cast<char>(io.get());
+      io.seekp(size - 70L);
+      io.put(static_cast<char>(c ^ 0x10));
+    }
+    REQUIRE_THROWS_AS(Lattice::Load(fname, SquareLattice, { 4UL, 3UL }),
+                      exception::BadLatticeFile);
+  }
+
+  SECTION("Truncated or missing file")
+  {
+    std::filesystem::resize_file(fname, 100UL);
+    REQUIRE_THROWS_AS(Lattice::Load(fname, SquareLattice, { 4UL, 3UL }),
+                      exception::BadLatticeFile);
+    std::remove(fname.c_str());
+    REQUIRE_THROWS_AS(Lattice::Load(fname, SquareLattice, { 4UL, 3UL }),
+                      exception::BadLatticeFile);
+  }
+
+  std::remove(fname.c_str());
+}
+
+TEST_CASE("Cache of lattices", "[lattice][file]")
+{
+  const auto dir = std::filesystem::temp_directory_path().string();
+  const auto fname =
+    Lattice::GetCacheFileName(dir, TriangularLattice, { 5UL, 4UL },
+                              Lattice::boundaries_t::Closed);
+  std::remove(fname.c_str());
+
+  auto built = Lattice::LoadOrBuild(dir, TriangularLattice, { 5UL, 4UL });
+  REQUIRE(built.GetNeighborTable().GetIndices().IsOwning());
+  REQUIRE(std::filesystem::exists(fname));
+
+  auto loaded = Lattice::LoadOrBuild(dir, TriangularLattice, { 5UL, 4UL });
+  REQUIRE_FALSE(loaded.GetNeighborTable().GetIndices().IsOwning());
+  check_same_tables(built, loaded);
+
+  // the name depends on all the parameters
+  REQUIRE(Lattice::GetCacheFileName(dir, TriangularLattice, { 4UL, 5UL },
+                                    Lattice::boundaries_t::Closed) != fname);
+  REQUIRE(Lattice::GetCacheFileName(dir, TriangularLattice, { 5UL, 4UL },
+                                    Lattice::boundaries_t::Open) != fname);
+
+  std::remove(fname.c_str());
+}
+
+TEST_CASE("Lattices shared among processes", "[lattice][shared]")
+{
+  const auto size = Lattice::gridsize_t{ 6UL, 4UL };
+  const auto name = Lattice::GetSharedName(TriangularLattice, size,
+                                           Lattice::boundaries_t::Closed);
+  SharedSegment::Remove(name);
+
+  auto reference = Lattice(TriangularLattice, size);
+
+  SECTION("The first process builds the tables, the others attach")
+  {
+    auto first = Lattice::LoadOrBuildShared(TriangularLattice, size);
+    auto second = Lattice::LoadOrBuildShared(TriangularLattice, size);
+    REQUIRE_FALSE(first.GetNeighborTable().GetIndices().IsOwning());
+    REQUIRE_FALSE(second.GetNeighborTable().GetIndices().IsOwning());
+    check_same_tables(reference, first);
+    check_same_tables(reference, second);
+  }
+
+  SECTION("Segments being built for too long are not used")
+  {
+    auto busy = SharedSegment::Create(name);
+    auto options = LatticeOptions{};
+    options.sharedtimeout = 0.01;
+    auto lattice =
+      Lattice::LoadOrBuildShared(TriangularLattice,
+                                 size,
+                                 Lattice::boundaries_t::Closed,
+                                 options);
+    REQUIRE(lattice.GetNeighborTable().GetIndices().IsOwning());
+    check_same_tables(reference, lattice);
+  }
+
+  SECTION("Segments with unusable content are replaced")
+  {
+    auto broken = SharedSegment::Create(name);
+    broken->Allocate(128UL);
+    broken->Publish();
+    auto lattice = Lattice::LoadOrBuildShared(TriangularLattice, size);
+    REQUIRE_FALSE(lattice.GetNeighborTable().GetIndices().IsOwning());
+    check_same_tables(reference, lattice);
+  }
+
+  SharedSegment::Remove(name);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
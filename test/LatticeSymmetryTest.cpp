@@ -0,0 +1,148 @@
+//===-- LatticeSymmetryTest.cpp --------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the LatticeSymmetry and Orbits Classes
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/Lattice.hpp>
+#include <bwsl/LatticeSymmetry.hpp>
+#include <bwsl/Orbits.hpp>
+
+// std
+#include <random>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+namespace {
+
+auto
+check_orbits(Lattice const& lattice) -> void
+{
+  const auto n = lattice.GetNumSites();
+  auto const& symmetry = lattice.GetSymmetry();
+  auto const& sites = lattice.GetSiteOrbits();
+  auto const& momenta = lattice.GetMomentumOrbits();
+  REQUIRE(sites.GetNumElements() == n);
+  REQUIRE(momenta.GetNumElements() == n);
+
+  // the equivalent sites have the same distance from the origin
+  for (auto i = 0UL; i < n; i++) {
+    auto r = sites.GetRepresentative(sites.GetOrbit(i));
+    REQUIRE(lattice.GetDistance(0UL, i) ==
+            Catch::Approx(lattice.GetDistance(0UL, r)));
+  }
+  for (auto a = 0UL; a < n; a++) {
+    for (auto b = 0UL; b < n; b++) {
+      REQUIRE(lattice.GetPairOrbit(a, b) == lattice.GetPairOrbit(b, a));
+    }
+  }
+
+  // averaged over the images of a configuration under the point group the
+  // structure factor is the same on all the momenta of an orbit
+  auto rng = std::mt19937_64(42UL);
+  auto coin = std::bernoulli_distribution(0.4);
+  auto occupations = std::vector<double>(n);
+  for (auto& x : occupations) {
+    x = coin(rng) ? 1.0 : 0.0;
+  }
+  auto sk = std::vector<double>(n, 0.0);
+  for (auto g = 0UL; g < symmetry.GetNumOperations(); g++) {
+    auto image = std::vector<double>(n);
+    for (auto i = 0UL; i < n; i++) {
+      auto c = symmetry.Apply(g, lattice.GetCoordinates(i));
+      lattice.EnforceBoundaries(c);
+      image[lattice.GetIndex(c)] = occupations[i];
+    }
+    lattice.AccumulateSk(image, sk);
+  }
+  for (auto i = 0UL; i < n; i++) {
+    auto r = momenta.GetRepresentative(momenta.GetOrbit(i));
+    REQUIRE(sk[i] == Catch::Approx(sk[r]).margin(1e-9));
+  }
+
+  auto reduced = std::vector<double>(momenta.GetNumOrbits(), 0.0);
+  lattice.AccumulateSkReduced(occupations, reduced);
+  auto expected = momenta.Reduce(lattice.ComputeSk(occupations));
+  for (auto k = 0UL; k < reduced.size(); k++) {
+    REQUIRE(reduced[k] == Catch::Approx(expected[k]));
+  }
+}
+
+} // namespace
+
+TEST_CASE("Orbits of a group", "[symmetry]")
+{
+  // reflection of six elements, i -> 5 - i
+  auto orbits = Orbits(6UL, 1UL, [](std::size_t, std::size_t i) {
+    return 5UL - i;
+  });
+  REQUIRE(orbits.GetNumOrbits() == 3UL);
+  REQUIRE(orbits.GetOrbit(0UL) == orbits.GetOrbit(5UL));
+  REQUIRE(orbits.GetOrbit(2UL) == 2UL);
+  REQUIRE(orbits.GetRepresentative(1UL) == 1UL);
+  REQUIRE(orbits.GetSize(1UL) == 2UL);
+
+  auto reduced = orbits.Reduce(std::vector<int>{ 1, 2, 3, 5, 6, 7 });
+  REQUIRE(reduced == std::vector<double>{ 4.0, 4.0, 4.0 });
+  REQUIRE(orbits.Expand({ 1.0, 2.0, 3.0 }) ==
+          std::vector<double>{ 1.0, 2.0, 3.0, 3.0, 2.0, 1.0 });
+}
+
+TEST_CASE("Point groups of lattices", "[lattice][symmetry]")
+{
+  SECTION("Chain")
+  {
+    auto lattice = Lattice(ChainLattice, { 7UL });
+    REQUIRE(lattice.GetSymmetry().GetNumOperations() == 2UL);
+    REQUIRE(lattice.GetSiteOrbits().GetNumOrbits() == 4UL);
+    check_orbits(lattice);
+  }
+
+  SECTION("Square lattice")
+  {
+    auto lattice = Lattice(SquareLattice, { 4UL, 4UL });
+    auto const& symmetry = lattice.GetSymmetry();
+    REQUIRE(symmetry.GetNumOperations() == 8UL);
+    REQUIRE(symmetry.GetOperation(0UL) ==
+            LatticeSymmetry::matrix_t{ 1L, 0L, 0L, 1L });
+    REQUIRE(lattice.GetSiteOrbits().GetNumOrbits() == 6UL);
+    check_orbits(lattice);
+  }
+
+  SECTION("Rectangular supercell of the square lattice")
+  {
+    auto lattice = Lattice(SquareLattice, { 4UL, 6UL });
+    REQUIRE(lattice.GetSymmetry().GetNumOperations() == 4UL);
+    check_orbits(lattice);
+  }
+
+  SECTION("Triangular lattice")
+  {
+    auto lattice = Lattice(TriangularLattice, { 6UL, 6UL });
+    REQUIRE(lattice.GetSymmetry().GetNumOperations() == 12UL);
+    check_orbits(lattice);
+  }
+
+  SECTION("Cubic lattice")
+  {
+    auto lattice = Lattice(CubicLattice, { 3UL, 3UL, 3UL });
+    REQUIRE(lattice.GetSymmetry().GetNumOperations() == 48UL);
+    check_orbits(lattice);
+  }
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
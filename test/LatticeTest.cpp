@@ -17,7 +17,10 @@
 
 // std
 #include <cmath>
+#include <cstdint>
 #include <random>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 
 // catch
@@ -132,4 +135,499 @@ TEST_CASE("Big Square Lattice")
   }
 }
 
+TEST_CASE("Structure factor with the FFT", "[lattice][sk]")
+{
+  auto lattices = std::vector<Lattice>{
+    Lattice(ChainLattice, { 10UL }),
+    Lattice(SquareLattice, { 6UL, 4UL }),
+    Lattice(SquareLattice, { 5UL, 7UL }),
+    Lattice(TriangularLattice, { 4UL, 6UL }),
+    Lattice(CubicLattice, { 3UL, 4UL, 5UL }),
+  };
+
+  auto rng = std::mt19937_64{ 7UL };
+  auto dist = std::uniform_int_distribution<int>{ 0, 3 };
+
+  for (auto const& structure : lattices) {
+    auto nsites = structure.GetNumSites();
+    auto occupations = std::vector<int>(nsites);
+    for (auto& n : occupations) {
+      n = dist(rng);
+    }
+
+    auto sk = structure.ComputeSk(occupations, 2.0);
+    auto expected = std::vector<double>(nsites, 0.0);
+    structure.AccumulateSkDirect(occupations, expected, 2.0);
+
+    for (auto i = 0UL; i < nsites; i++) {
+      REQUIRE(sk[i] == CApprox(expected[i]).margin(1e-12));
+    }
+  }
+}
+
+TEST_CASE("Density correlation with the FFT", "[lattice][correlation]")
+{
+  auto lattices = std::vector<Lattice>{
+    Lattice(ChainLattice, { 10UL }),
+    Lattice(SquareLattice, { 6UL, 4UL }),
+    Lattice(TriangularLattice, { 5UL, 3UL }),
+    Lattice(CubicLattice, { 3UL, 4UL, 5UL }),
+  };
+
+  auto rng = std::mt19937_64{ 11UL };
+  auto dist = std::uniform_int_distribution<int>{ 0, 3 };
+
+  for (auto const& structure : lattices) {
+    auto nsites = structure.GetNumSites();
+    auto occupations = std::vector<int>(nsites);
+    for (auto& n : occupations) {
+      n = dist(rng);
+    }
+
+    auto cr = structure.ComputeCorrelation(occupations, 2.0);
+    auto expected = std::vector<double>(nsites, 0.0);
+    structure.AccumulateCorrelationDirect(occupations, expected, 2.0);
+    for (auto r = 0UL; r < nsites; r++) {
+      REQUIRE(cr[r] == CApprox(expected[r]).margin(1e-12));
+    }
+
+    // floating occupations give the same correlation
+    auto real = std::vector<double>(occupations.begin(), occupations.end());
+    auto again = std::vector<double>(nsites, 0.0);
+    structure.AccumulateCorrelation(real, again, 2.0);
+    for (auto r = 0UL; r < nsites; r++) {
+      REQUIRE(again[r] == CApprox(cr[r]).margin(1e-12));
+    }
+
+    // the average over the shells weighs each site of the shell equally
+    auto const& shells = structure.GetDistanceShells();
+    auto reduced = std::vector<double>(shells.GetNumShells(), 0.0);
+    structure.AccumulateCorrelationReduced(occupations, reduced, 2.0);
+    for (auto k = 0UL; k < shells.GetNumShells(); k++) {
+      auto average = 0.0;
+      for (auto r : shells.GetSites(k)) {
+        average += expected[r];
+      }
+      average /= static_cast<double>(shells.GetMultiplicity(k));
+      REQUIRE(reduced[k] == CApprox(average).margin(1e-12));
+    }
+  }
+
+  SECTION("Morton numbering")
+  {
+    auto options = LatticeOptions{};
+    options.ordering = GridOrdering::Morton;
+    auto morton = Lattice(
+      SquareLattice, { 6UL, 5UL }, Lattice::boundaries_t::Closed, options);
+    auto occupations = std::vector<double>(morton.GetNumSites());
+    auto coin = std::bernoulli_distribution(0.4);
+    for (auto& x : occupations) {
+      x = coin(rng) ? 1.0 : 0.0;
+    }
+    auto cr = morton.ComputeCorrelation(occupations);
+    auto expected = std::vector<double>(morton.GetNumSites(), 0.0);
+    morton.AccumulateCorrelationDirect(occupations, expected);
+    for (auto r = 0UL; r < cr.size(); r++) {
+      REQUIRE(cr[r] == CApprox(expected[r]).margin(1e-12));
+    }
+  }
+}
+
+TEST_CASE("Neighbor slots", "[lattice][neighbors]")
+{
+  auto check_slots = [](Lattice const& structure) {
+    for (auto a = 0UL; a < structure.GetNumSites(); a++) {
+      auto nn = structure.GetNeighbors(a);
+      REQUIRE(nn.size() == structure.GetCoordination(a));
+      for (auto s = 0UL; s < nn.size(); s++) {
+        auto b = structure.GetNeighbor(a, s);
+        REQUIRE(b == nn[s]);
+        REQUIRE(structure.AreNeighbors(a, b));
+        REQUIRE(structure.GetNeighbor(a, structure.GetNeighborSlot(a, b)) ==
+                b);
+
+        // going back along the opposite slot returns to the first site
+        auto t = structure.GetOppositeSlot(a, s);
+        REQUIRE(structure.GetNeighbor(b, t) == a);
+        REQUIRE((structure.GetNeighborDirection(b, t) ^ 1UL) ==
+                structure.GetNeighborDirection(a, s));
+        REQUIRE(structure.GetOppositeSlot(b, t) == s);
+      }
+    }
+  };
+
+  SECTION("closed boundaries have uniform coordination")
+  {
+    auto structure = Lattice(TriangularLattice, { 4UL, 5UL });
+    REQUIRE(structure.GetNeighborTable().HasUniformCoordination());
+    REQUIRE(structure.GetCoordination() == 6UL);
+    REQUIRE(structure.GetNeighborSlot(0UL, 7UL) == Lattice::NoSlot);
+    REQUIRE_FALSE(structure.AreNeighbors(0UL, 7UL));
+    check_slots(structure);
+  }
+
+  SECTION("open boundaries")
+  {
+    auto structure =
+      Lattice(SquareLattice, { 4UL, 3UL }, Lattice::boundaries_t::Open);
+    REQUIRE_FALSE(structure.GetNeighborTable().HasUniformCoordination());
+    REQUIRE(structure.GetCoordination(0UL) == 2UL);
+    REQUIRE(structure.GetCoordination(4UL) == 4UL);
+    REQUIRE(structure.GetNeighborSlot(0UL, 2UL) == Lattice::NoSlot);
+    check_slots(structure);
+  }
+}
+
+TEST_CASE("Translation tables", "[lattice][translations]")
+{
+  auto check_translations = [](Lattice const& structure, TranslationMode mode) {
+    auto const& map = structure.GetTranslationMap();
+    REQUIRE(map.GetMode() == mode);
+    auto const& grid = static_cast<HyperCubicGrid const&>(structure);
+    for (auto a = 0UL; a < structure.GetNumSites(); a++) {
+      for (auto b = 0UL; b < structure.GetNumSites(); b++) {
+        auto i = grid.GetMappedSite(a, b);
+        REQUIRE(structure.GetMappedSite(a, b) == i);
+        REQUIRE(structure.GetUnMappedSite(i, a) == b);
+        REQUIRE(structure.GetUnMappedSite(a, b) == grid.GetUnMappedSite(a, b));
+      }
+    }
+  };
+
+  auto options = LatticeOptions{};
+  auto size = std::vector<size_t>{ 3UL, 5UL, 6UL };
+
+  SECTION("explicit storage")
+  {
+    for (auto mode : { TranslationMode::None,
+                       TranslationMode::Dense,
+                       TranslationMode::Decomposed }) {
+      options.translations = mode;
+      check_translations(
+        Lattice(CubicLattice, size, Lattice::boundaries_t::Closed, options),
+        mode);
+    }
+  }
+
+  SECTION("decomposed storage of a Morton numbering")
+  {
+    options.ordering = GridOrdering::Morton;
+    options.translations = TranslationMode::Decomposed;
+    REQUIRE_THROWS_AS(
+      Lattice(CubicLattice, size, Lattice::boundaries_t::Closed, options),
+      std::invalid_argument);
+
+    options.translations = TranslationMode::Auto;
+    auto structure =
+      Lattice(CubicLattice, size, Lattice::boundaries_t::Closed, options);
+    REQUIRE(structure.GetTranslationMap().GetMode() !=
+            TranslationMode::Decomposed);
+  }
+
+  SECTION("no table by default")
+  {
+    check_translations(Lattice(CubicLattice, size), TranslationMode::None);
+  }
+
+  SECTION("automatic choice with a memory budget")
+  {
+    options.translations = TranslationMode::Auto;
+    options.translationbudget = TranslationMap::DenseMemory(90UL);
+    check_translations(
+      Lattice(CubicLattice, size, Lattice::boundaries_t::Closed, options),
+      TranslationMode::Dense);
+
+    options.translationbudget = TranslationMap::DenseMemory(90UL) - 1UL;
+    auto structure =
+      Lattice(CubicLattice, size, Lattice::boundaries_t::Closed, options);
+    REQUIRE(structure.GetTranslationMap().GetMemoryUsage() <=
+            options.translationbudget);
+    check_translations(structure, TranslationMode::Decomposed);
+
+    options.translationbudget = 0UL;
+    check_translations(
+      Lattice(CubicLattice, size, Lattice::boundaries_t::Closed, options),
+      TranslationMode::None);
+
+    // power of two sizes already have a fast mapping
+    options.translationbudget = DefaultTranslationBudget;
+    check_translations(Lattice(SquareLattice,
+                               { 4UL, 8UL },
+                               Lattice::boundaries_t::Closed,
+                               options),
+                       TranslationMode::None);
+  }
+}
+
+TEST_CASE("Lattice built with several threads", "[lattice][threads]")
+{
+  auto check_same_tables = [](Lattice const& serial, Lattice const& parallel) {
+    auto n = serial.GetNumSites();
+    for (auto i = 0UL; i < n; i++) {
+      REQUIRE(parallel.GetPosition(i) == serial.GetPosition(i));
+      REQUIRE(parallel.GetVector(0UL, i) == serial.GetVector(0UL, i));
+      REQUIRE(parallel.GetDistance(0UL, i) == serial.GetDistance(0UL, i));
+      if (serial.HasClosedBoundaries()) {
+        REQUIRE(parallel.GetMomentum(i) == serial.GetMomentum(i));
+      }
+      auto ns = serial.GetNeighbors(i);
+      auto np = parallel.GetNeighbors(i);
+      REQUIRE(std::vector<size_t>(np.begin(), np.end()) ==
+              std::vector<size_t>(ns.begin(), ns.end()));
+      for (auto s = 0UL; s < ns.size(); s++) {
+        REQUIRE(parallel.GetNeighborDirection(i, s) ==
+                serial.GetNeighborDirection(i, s));
+      }
+    }
+  };
+
+  auto options = LatticeOptions{};
+  options.numthreads = 4UL;
+  check_same_tables(Lattice(TriangularLattice, { 12UL, 10UL }),
+                    Lattice(TriangularLattice,
+                            { 12UL, 10UL },
+                            Lattice::boundaries_t::Closed,
+                            options));
+  check_same_tables(
+    Lattice(CubicLattice, { 6UL, 5UL, 4UL }, Lattice::boundaries_t::Open),
+    Lattice(
+      CubicLattice, { 6UL, 5UL, 4UL }, Lattice::boundaries_t::Open, options));
+}
+
+template<class L>
+auto
+check_same_lattice(Lattice const& dynamic, L const& fixed) -> void
+{
+  auto nsites = dynamic.GetNumSites();
+  REQUIRE(fixed.GetNumSites() == nsites);
+  REQUIRE(fixed.GetDim() == dynamic.GetDim());
+
+  for (auto i = 0UL; i < nsites; i++) {
+    auto nd = dynamic.GetNeighbors(i);
+    auto nf = fixed.GetNeighbors(i);
+    REQUIRE(std::vector<size_t>(nf.begin(), nf.end()) ==
+            std::vector<size_t>(nd.begin(), nd.end()));
+
+    auto cd = dynamic.GetCoordinates(i);
+    auto cf = fixed.GetCoordinates(i);
+    REQUIRE(std::vector<long>(cf.begin(), cf.end()) == cd);
+
+    auto pd = dynamic.GetPosition(i);
+    auto pf = fixed.GetPosition(i);
+    REQUIRE(std::vector<double>(pf.begin(), pf.end()) == pd);
+
+    for (auto j = 0UL; j < nsites; j++) {
+      if (dynamic.HasClosedBoundaries()) {
+        REQUIRE(fixed.GetMappedSite(i, j) == dynamic.GetMappedSite(i, j));
+        REQUIRE(fixed.GetDistance(i, j) == dynamic.GetDistance(i, j));
+      }
+      auto jd = dynamic.GetJump(i, j);
+      auto jf = fixed.GetJump(i, j);
+      REQUIRE(std::vector<long>(jf.begin(), jf.end()) == jd);
+    }
+  }
+
+  auto occupations = std::vector<double>(nsites, 0.0);
+  for (auto i = 0UL; i < nsites; i += 3UL) {
+    occupations[i] = 1.0;
+  }
+  REQUIRE(fixed.ComputeSk(occupations) == dynamic.ComputeSk(occupations));
+}
+
+TEST_CASE("Lattices with the dimension fixed at compile time", "[lattice]")
+{
+  static_assert(SquareLattice.GetDim() == 2UL);
+  static_assert(TriangularLattice.GetGamma() == 6UL);
+
+  check_same_lattice(Lattice(ChainLattice, { 7UL }),
+                     Lattice1D(ChainLattice, { 7UL }));
+  check_same_lattice(Lattice(SquareLattice, { 4UL, 5UL }),
+                     Lattice2D(SquareLattice, { 4UL, 5UL }));
+  check_same_lattice(Lattice(TriangularLattice, { 6UL, 6UL }),
+                     Lattice2D(TriangularLattice, { 6UL, 6UL }));
+  check_same_lattice(
+    Lattice(SquareLattice, { 4UL, 3UL }, Lattice::boundaries_t::Open),
+    Lattice2D(SquareLattice, { 4UL, 3UL }, Lattice2D::boundaries_t::Open));
+  check_same_lattice(Lattice(CubicLattice, { 3UL, 4UL, 2UL }),
+                     Lattice3D(CubicLattice, { 3UL, 4UL, 2UL }));
+}
+
+TEST_CASE("Lattice tables computed on demand", "[lattice][lazy]")
+{
+  auto check_same_tables = [](Lattice const& full, Lattice const& lazy) {
+    auto n = full.GetNumSites();
+    for (auto i = 0UL; i < n; i++) {
+      REQUIRE(lazy.GetPosition(i) == full.GetPosition(i));
+      REQUIRE(lazy.GetMomentum(i) == full.GetMomentum(i));
+      REQUIRE(lazy.GetCoordination(i) == full.GetCoordination(i));
+      for (auto j = 0UL; j < n; j++) {
+        REQUIRE(lazy.GetVector(i, j) == full.GetVector(i, j));
+        REQUIRE(lazy.GetDistance(i, j) == CApprox(full.GetDistance(i, j)));
+        REQUIRE(lazy.AreNeighbors(i, j) == full.AreNeighbors(i, j));
+      }
+    }
+
+    auto occupations = std::vector<int>(n, 0);
+    for (auto i = 0UL; i < n; i += 2UL) {
+      occupations[i] = 1;
+    }
+    auto expected = std::vector<double>(n, 0.0);
+    auto sk = std::vector<double>(n, 0.0);
+    full.AccumulateSkDirect(occupations, expected);
+    lazy.AccumulateSkDirect(occupations, sk);
+    REQUIRE(sk == expected);
+  };
+
+  const auto size = Lattice::gridsize_t{ 5UL, 4UL };
+  auto full = Lattice(TriangularLattice, size);
+
+  SECTION("Tables stored at their first use")
+  {
+    auto options = LatticeOptions{};
+    options.tables = LatticeTable::Neighbors | LatticeTable::Distances;
+    auto lazy =
+      Lattice(TriangularLattice, size, Lattice::boundaries_t::Closed, options);
+    REQUIRE(lazy.IsStored(LatticeTable::Positions));
+
+    // copies made before the first use share the stored tables
+    auto copy = lazy;
+    check_same_tables(full, lazy);
+    check_same_tables(full, copy);
+  }
+
+  SECTION("Tables computed at each query")
+  {
+    auto options = LatticeOptions{};
+    options.tables = LatticeTable::None;
+    options.materialize = false;
+    auto lazy =
+      Lattice(TriangularLattice, size, Lattice::boundaries_t::Closed, options);
+    REQUIRE_FALSE(lazy.IsStored(LatticeTable::Vectors));
+    REQUIRE_FALSE(lazy.IsStored(LatticeTable::Momenta));
+    check_same_tables(full, lazy);
+  }
+
+  SECTION("Concurrent first uses")
+  {
+    auto options = LatticeOptions{};
+    options.tables = LatticeTable::None;
+    auto lazy =
+      Lattice(TriangularLattice, size, Lattice::boundaries_t::Closed, options);
+    auto threads = std::vector<std::thread>{};
+    auto positions = std::vector<Lattice::realvec_t>(4UL);
+    for (auto t = 0UL; t < positions.size(); t++) {
+      threads.emplace_back(
+        [&lazy, &positions, t]() { positions[t] = lazy.GetPosition(t); });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (auto t = 0UL; t < positions.size(); t++) {
+      REQUIRE(positions[t] == full.GetPosition(t));
+    }
+    check_same_tables(full, lazy);
+  }
+}
+
+TEST_CASE("Tables viewed as planes", "[lattice][planes]")
+{
+  auto options = LatticeOptions{};
+  options.tables = LatticeTable::None;
+  options.materialize = false;
+  auto lattice = Lattice(
+    TriangularLattice, { 7UL, 5UL }, Lattice::boundaries_t::Closed, options);
+  const auto n = lattice.GetNumSites();
+  REQUIRE(lattice.GetPlaneStride() % 8UL == 0UL);
+  REQUIRE(lattice.GetPlaneStride() >= n);
+
+  auto aligned = [](auto const& plane) {
+    return reinterpret_cast<std::uintptr_t>(plane.data()) % 64UL == 0UL;
+  };
+
+  for (auto d = 0UL; d < lattice.GetDim(); d++) {
+    auto positions = lattice.GetPositions(d);
+    auto vectors = lattice.GetVectors(d);
+    auto momenta = lattice.GetMomenta(d);
+    REQUIRE(positions.size() == n);
+    REQUIRE(vectors.size() == n);
+    REQUIRE(momenta.size() == n);
+    REQUIRE(aligned(positions));
+    REQUIRE(aligned(vectors));
+    REQUIRE(aligned(momenta));
+    for (auto i = 0UL; i < n; i++) {
+      REQUIRE(positions[i] == lattice.GetPosition(i)[d]);
+      REQUIRE(vectors[i] == lattice.GetVector(0UL, i)[d]);
+      REQUIRE(momenta[i] == lattice.GetMomentum(i)[d]);
+    }
+  }
+
+  auto distances = lattice.GetDistances();
+  REQUIRE(distances.size() == n);
+  REQUIRE(aligned(distances));
+  for (auto i = 0UL; i < n; i++) {
+    REQUIRE(distances[i] == lattice.GetDistance(0UL, i));
+  }
+}
+
+TEST_CASE("Lattices numbered along the Morton curve", "[lattice][morton]")
+{
+  auto options = LatticeOptions{};
+  options.ordering = GridOrdering::Morton;
+
+  auto check = [&options](Bravais const& bravais,
+                          Lattice::gridsize_t const& size) {
+    auto rowmajor = Lattice(bravais, size);
+    auto morton =
+      Lattice(bravais, size, Lattice::boundaries_t::Closed, options);
+    REQUIRE(morton.GetOrdering() == GridOrdering::Morton);
+    const auto n = morton.GetNumSites();
+
+    // the same site in the two numberings
+    auto same = [&](size_t i) {
+      return rowmajor.GetIndex(morton.GetCoordinates(i));
+    };
+    for (auto i = 0UL; i < n; i++) {
+      REQUIRE(same(i) == morton.GetRowMajorIndex(i));
+      REQUIRE(morton.GetPosition(i) == rowmajor.GetPosition(same(i)));
+      REQUIRE(morton.GetMomentum(i) == rowmajor.GetMomentum(same(i)));
+      auto neighbors = morton.GetNeighbors(i);
+      auto expected = rowmajor.GetNeighbors(same(i));
+      REQUIRE(neighbors.size() == expected.size());
+      for (auto slot = 0UL; slot < neighbors.size(); slot++) {
+        REQUIRE(same(neighbors[slot]) == expected[slot]);
+      }
+      for (auto j = 0UL; j < n; j++) {
+        REQUIRE(same(morton.GetMappedSite(i, j)) ==
+                rowmajor.GetMappedSite(same(i), same(j)));
+        REQUIRE(morton.GetDistance(i, j) ==
+                rowmajor.GetDistance(same(i), same(j)));
+      }
+    }
+
+    // the structure factor with the FFT is the direct one
+    auto rng = std::mt19937_64(7UL);
+    auto coin = std::bernoulli_distribution(0.3);
+    auto occupations = std::vector<double>(n);
+    for (auto& x : occupations) {
+      x = coin(rng) ? 1.0 : 0.0;
+    }
+    auto fft = morton.ComputeSk(occupations);
+    auto direct = std::vector<double>(n, 0.0);
+    morton.AccumulateSkDirect(occupations, direct);
+    for (auto k = 0UL; k < n; k++) {
+      REQUIRE(fft[k] == CApprox(direct[k]).margin(1e-12));
+    }
+    auto reference = rowmajor.ComputeSk(morton.ToRowMajor(occupations));
+    REQUIRE(morton.ToRowMajor(fft).size() == reference.size());
+    for (auto k = 0UL; k < n; k++) {
+      REQUIRE(morton.ToRowMajor(fft)[k] ==
+              CApprox(reference[k]).margin(1e-12));
+    }
+  };
+
+  check(SquareLattice, { 8UL, 8UL });
+  check(TriangularLattice, { 6UL, 4UL });
+  check(CubicLattice, { 4UL, 3UL, 4UL });
+}
+
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
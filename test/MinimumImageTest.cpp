@@ -0,0 +1,116 @@
+//===-- MinimumImageTest.cpp -----------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the MinimumImage Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/HyperCubicGrid.hpp>
+#include <bwsl/MinimumImage.hpp>
+
+// std
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+using CApprox = Catch::Approx;
+
+/// Shortest image searching explicitly among the images with shifts up to
+/// @p range times the size along each dimension
+auto
+brute_force(Bravais const& bravais,
+            std::vector<size_t> const& size,
+            std::vector<long> const& coords,
+            long range) -> double
+{
+  auto const dim = size.size();
+  auto const imgsize = std::vector<size_t>(dim, 2UL * range + 1UL);
+  auto const origin = std::vector<long>(dim, 0L);
+  auto best = bravais.GetDistance(origin, coords);
+  for (auto k = 0UL; k < accumulate_product(imgsize); k++) {
+    auto img = index_to_array<std::vector<long>>(k, imgsize);
+    auto c = coords;
+    for (auto d = 0UL; d < dim; d++) {
+      c[d] += (img[d] - range) * static_cast<long>(size[d]);
+    }
+    best = std::min(best, bravais.GetDistance(origin, c));
+  }
+  return best;
+}
+
+auto
+check_images(Bravais const& bravais, std::vector<size_t> const& size) -> void
+{
+  auto images = MinimumImage(bravais, size);
+  auto grid = HyperCubicGrid(size, GridBoundaries::Closed);
+  auto const origin = std::vector<long>(size.size(), 0L);
+
+  // at most 2 (2^d - 1) relevant vectors
+  REQUIRE(images.GetNumRelevant() <= 2UL * ((1UL << size.size()) - 1UL));
+
+  for (auto i = 0UL; i < grid.GetNumSites(); i++) {
+    auto c = grid.GetCoordinates(i);
+    auto r = c;
+    images.Reduce(r);
+
+    // still an image of the same site
+    auto w = r;
+    grid.EnforceBoundaries(w);
+    REQUIRE(w == c);
+
+    auto range = size.size() <= 2UL ? 3L : 1L;
+    REQUIRE(bravais.GetDistance(origin, r) ==
+            CApprox(brute_force(bravais, size, c, range)));
+
+    // reducing again does not change anything
+    auto rr = r;
+    images.Reduce(rr);
+    REQUIRE(rr == r);
+  }
+}
+
+TEST_CASE("Shortest periodic images", "[minimumimage]")
+{
+  SECTION("hypercubic lattices")
+  {
+    check_images(ChainLattice, { 7UL });
+    check_images(SquareLattice, { 4UL, 5UL });
+    check_images(CubicLattice, { 4UL, 3UL, 5UL });
+    check_images(HyperCubicLattice4D, { 3UL, 4UL, 2UL, 3UL });
+    check_images(HyperCubicLattice5D, { 3UL, 2UL, 3UL, 2UL, 3UL });
+  }
+
+  SECTION("skewed cells")
+  {
+    check_images(TriangularLattice, { 6UL, 6UL });
+    check_images(TriangularLattice, { 9UL, 2UL });
+    check_images(TriangularLattice, { 3UL, 11UL });
+    check_images(TriangularLattice, { 1UL, 8UL });
+  }
+
+  SECTION("the reduced basis spans the superlattice")
+  {
+    auto images = MinimumImage(TriangularLattice, std::vector<size_t>{ 9, 2 });
+    auto basis = images.GetReducedBasis();
+    REQUIRE(basis.size() == 2UL);
+    auto det = basis[0][0] * basis[1][1] - basis[0][1] * basis[1][0];
+    REQUIRE((det == 18L || det == -18L));
+    for (auto const& b : basis) {
+      REQUIRE(b[0] % 9L == 0L);
+      REQUIRE(b[1] % 2L == 0L);
+    }
+  }
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
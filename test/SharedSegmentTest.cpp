@@ -0,0 +1,181 @@
+//===-- SharedSegmentTest.cpp ----------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the SharedSegment Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/SharedSegment.hpp>
+
+// posix
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/statvfs.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// std
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+// catch
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+using State = SharedSegment::State;
+
+TEST_CASE("Shared memory segments", "[shared]")
+{
+  const auto name = "/bwsl-segment-test-" + std::to_string(::getpid());
+  SharedSegment::Remove(name);
+
+  REQUIRE(SharedSegment::Attach(name, 0.0).first == State::Missing);
+
+  auto created = SharedSegment::Create(name);
+  REQUIRE(created != nullptr);
+  REQUIRE(SharedSegment::Create(name) == nullptr);
+
+  // the creator is alive, the others wait for it
+  auto [building, none] = SharedSegment::Attach(name, 0.01);
+  REQUIRE(building == State::Building);
+  REQUIRE(none == nullptr);
+
+  created->Allocate(6UL);
+  std::memcpy(created->GetPayload(), "hello", 6UL);
+  created->Publish();
+
+  auto [ready, segment] = SharedSegment::Attach(name, 0.0);
+  REQUIRE(ready == State::Ready);
+  REQUIRE(segment->GetPayloadSize() == 6UL);
+  REQUIRE(std::strcmp(static_cast<char const*>(segment->GetPayload()),
+                      "hello") == 0);
+
+  // the mappings survive the removal of the name
+  REQUIRE(SharedSegment::Remove(name));
+  REQUIRE_FALSE(SharedSegment::Remove(name));
+  REQUIRE(SharedSegment::Attach(name, 0.0).first == State::Missing);
+  REQUIRE(std::strcmp(static_cast<char const*>(segment->GetPayload()),
+                      "hello") == 0);
+}
+
+TEST_CASE("Segments abandoned by their creator", "[shared]")
+{
+  const auto name = "/bwsl-segment-stale-" + std::to_string(::getpid());
+  SharedSegment::Remove(name);
+
+  const auto child = ::fork();
+  REQUIRE(child >= 0);
+  if (child == 0) {
+    auto created = SharedSegment::Create(name);
+    ::_exit(created != nullptr ? 0 : 1);
+  }
+  auto status = 0;
+  ::waitpid(child, &status, 0);
+  REQUIRE(WIFEXITED(status));
+  REQUIRE(WEXITSTATUS(status) == 0);
+
+  REQUIRE(SharedSegment::Attach(name, 1.0).first == State::Stale);
+  REQUIRE(SharedSegment::Remove(name));
+}
+
+TEST_CASE("Segments abandoned while being created", "[shared]")
+{
+  const auto name = "/bwsl-segment-unowned-" + std::to_string(::getpid());
+  SharedSegment::Remove(name);
+
+  // a creator dying right after creating the segment, or before writing
+  // its process id, leaves the control block empty
+  auto leave = [&name](std::size_t size) {
+    const auto fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    REQUIRE(fd >= 0);
+    REQUIRE(::ftruncate(fd, static_cast<off_t>(size)) == 0);
+    ::close(fd);
+  };
+
+  SECTION("Without control block")
+  {
+    leave(0UL);
+    REQUIRE(SharedSegment::Attach(name, 0.0).first == State::Building);
+    REQUIRE(SharedSegment::Attach(name, 10.0).first == State::Stale);
+  }
+
+  SECTION("Without owner")
+  {
+    leave(SharedSegment::ControlSize);
+    REQUIRE(SharedSegment::Attach(name, 0.0).first == State::Building);
+    REQUIRE(SharedSegment::Attach(name, 10.0).first == State::Stale);
+  }
+
+  REQUIRE(SharedSegment::Remove(name));
+}
+
+TEST_CASE("Segments whose creator fails", "[shared]")
+{
+  const auto name = "/bwsl-segment-failed-" + std::to_string(::getpid());
+  SharedSegment::Remove(name);
+
+  SECTION("Published once filled")
+  {
+    auto created = SharedSegment::CreateAndPublish(
+      name, [](SharedSegment& segment) { segment.Allocate(8UL); });
+    REQUIRE(created != nullptr);
+    REQUIRE(SharedSegment::Attach(name, 0.0).first == State::Ready);
+    REQUIRE(SharedSegment::CreateAndPublish(
+              name, [](SharedSegment&) { FAIL("filled twice"); }) ==
+            nullptr);
+  }
+
+  SECTION("Removed when the creator throws")
+  {
+    REQUIRE_THROWS_AS(
+      SharedSegment::CreateAndPublish(name,
+                                      [](SharedSegment& segment) {
+                                        segment.Allocate(8UL);
+                                        throw std::runtime_error("failed");
+                                      }),
+      std::runtime_error);
+
+    // the creator is alive but the others do not wait for it
+    REQUIRE(SharedSegment::Attach(name, 10.0).first == State::Missing);
+  }
+
+  SECTION("Removed whatever the exception")
+  {
+    REQUIRE_THROWS_AS(SharedSegment::CreateAndPublish(
+                        name, [](SharedSegment&) { throw std::bad_alloc(); }),
+                      std::bad_alloc);
+    REQUIRE(SharedSegment::Attach(name, 10.0).first == State::Missing);
+    REQUIRE(SharedSegment::Create(name) != nullptr);
+  }
+
+  SECTION("Payloads larger than the free space")
+  {
+    struct statvfs fs = {};
+    REQUIRE(::statvfs("/dev/shm", &fs) == 0);
+    const auto available = static_cast<std::size_t>(fs.f_bavail) * fs.f_frsize;
+
+    // the error is reported by Allocate instead of a SIGBUS on the first
+    // write, and the segment is removed
+    REQUIRE_THROWS_AS(SharedSegment::CreateAndPublish(
+                        name,
+                        [&](SharedSegment& segment) {
+                          segment.Allocate(available + (1UL << 30UL));
+                        }),
+                      std::runtime_error);
+    REQUIRE(SharedSegment::Attach(name, 10.0).first == State::Missing);
+  }
+
+  SharedSegment::Remove(name);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,162 @@
+//===-- SiteColoringTest.cpp -----------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the SiteColoring Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/Lattice.hpp>
+#include <bwsl/SiteColoring.hpp>
+#include <bwsl/ThreadPool.hpp>
+
+// std
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// catch
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+namespace {
+
+auto
+check_coloring(Lattice const& lattice, std::size_t numcolors) -> void
+{
+  auto const& coloring = lattice.GetColoring();
+  REQUIRE(coloring.GetNumSites() == lattice.GetNumSites());
+  REQUIRE(coloring.GetNumColors() == numcolors);
+  REQUIRE(coloring.IsProper(lattice.GetNeighborTable()));
+
+  auto total = 0UL;
+  for (auto c = 0UL; c < coloring.GetNumColors(); c++) {
+    auto sites = coloring.GetSites(static_cast<SiteColoring::color_t>(c));
+    total += sites.size();
+    for (auto k = 0UL; k < sites.size(); k++) {
+      REQUIRE(coloring.GetColor(sites[k]) == c);
+      if (k > 0UL) {
+        REQUIRE(sites[k - 1UL] < sites[k]);
+      }
+    }
+  }
+  REQUIRE(total == lattice.GetNumSites());
+}
+
+} // namespace
+
+TEST_CASE("Coloring from the neighbors", "[coloring]")
+{
+  // ring of five sites, an odd cycle needs three colors
+  auto offsets = NeighborTable::vectorindex_t{ 0, 2, 4, 6, 8, 10 };
+  auto indices =
+    NeighborTable::vectorindex_t{ 1, 4, 2, 0, 3, 1, 4, 2, 0, 3 };
+  auto directions =
+    NeighborTable::vectorslot_t{ 0, 1, 0, 1, 0, 1, 0, 1, 0, 1 };
+  auto table =
+    NeighborTable(offsets, Buffer<NeighborTable::index_t>(indices), directions);
+  auto coloring = SiteColoring::FromNeighbors(table);
+  REQUIRE(coloring.GetNumColors() == 3UL);
+  REQUIRE(coloring.IsProper(table));
+
+  auto colors = std::vector<SiteColoring::color_t>{ 1, 0, 2, 0, 1 };
+  auto given = SiteColoring(colors);
+  REQUIRE(given.GetSites(0U).size() == 2UL);
+  REQUIRE(given.GetSites(1U)[1] == 4UL);
+  REQUIRE(given.GetSize(2U) == 1UL);
+  REQUIRE_FALSE(given.IsProper(table));
+}
+
+TEST_CASE("Colorings of lattices", "[lattice][coloring]")
+{
+  SECTION("Checkerboards")
+  {
+    check_coloring(Lattice(ChainLattice, { 8UL }), 2UL);
+    check_coloring(Lattice(SquareLattice, { 4UL, 6UL }), 2UL);
+    check_coloring(Lattice(CubicLattice, { 4UL, 2UL, 6UL }), 2UL);
+    check_coloring(
+      Lattice(SquareLattice, { 5UL, 3UL }, GridBoundaries::Open), 2UL);
+
+    auto lattice = Lattice(SquareLattice, { 4UL, 4UL });
+    for (auto i = 0UL; i < lattice.GetNumSites(); i++) {
+      auto c = lattice.GetCoordinates(i);
+      REQUIRE(lattice.GetColoring().GetColor(i) ==
+              static_cast<std::size_t>(c[0] + c[1]) % 2UL);
+    }
+  }
+
+  SECTION("Triangular lattice")
+  {
+    check_coloring(Lattice(TriangularLattice, { 6UL, 3UL }), 3UL);
+  }
+
+  SECTION("Odd sizes")
+  {
+    // no periodic coloring exists, the greedy one is still proper
+    auto lattice = Lattice(SquareLattice, { 5UL, 5UL });
+    auto const& coloring = lattice.GetColoring();
+    REQUIRE(coloring.GetNumColors() == 3UL);
+    REQUIRE(coloring.IsProper(lattice.GetNeighborTable()));
+
+    auto triangular = Lattice(TriangularLattice, { 4UL, 5UL });
+    REQUIRE(triangular.GetColoring().IsProper(triangular.GetNeighborTable()));
+  }
+
+  SECTION("Morton ordering")
+  {
+    auto options = LatticeOptions{};
+    options.ordering = GridOrdering::Morton;
+    check_coloring(
+      Lattice(CubicLattice, { 4UL, 4UL, 4UL }, GridBoundaries::Closed, options),
+      2UL);
+  }
+}
+
+TEST_CASE("Parallel sweeps", "[coloring]")
+{
+  auto lattice = Lattice(TriangularLattice, { 12UL, 9UL });
+  auto const& coloring = lattice.GetColoring();
+  const auto n = lattice.GetNumSites();
+
+  // each site is updated once per sweep
+  auto pool = ThreadPool(4UL);
+  auto visits = std::vector<std::atomic<int>>(n);
+  coloring.Sweep(pool, [&](std::size_t i) { visits[i]++; });
+  for (auto const& v : visits) {
+    REQUIRE(v.load() == 1);
+  }
+
+  // a deterministic update reading the neighbors gives the same result with
+  // any number of threads
+  auto run = [&](std::size_t numthreads) {
+    auto threads = ThreadPool(numthreads);
+    auto state = std::vector<std::int64_t>(n);
+    for (auto i = 0UL; i < n; i++) {
+      state[i] = static_cast<std::int64_t>(i % 7UL);
+    }
+    for (auto sweep = 0; sweep < 5; sweep++) {
+      coloring.Sweep(
+        threads,
+        [&](std::size_t i) {
+          auto sum = std::int64_t{ 0 };
+          for (auto j : lattice.GetNeighbors(i)) {
+            sum += state[j];
+          }
+          state[i] = (3 * state[i] + sum) % 1009;
+        },
+        1UL);
+    }
+    return state;
+  };
+  REQUIRE(run(1UL) == run(4UL));
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,213 @@
+//===-- StiffnessAccumulatorTest.cpp ---------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the StiffnessAccumulator Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/accumulators/KnuthWelfordAccumulator.hpp>
+#include <bwsl/accumulators/StiffnessAccumulator.hpp>
+
+// boost
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+
+// std
+#include <array>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl::accumulators;
+using Catch::Approx;
+
+TEST_CASE("stiffness of fixed windings", "[StiffnessAccumulator]")
+{
+  const auto beta = 0.5;
+
+  SECTION("Cubic grid")
+  {
+    const auto sizes = std::vector<unsigned long>{ 4, 4, 4 };
+    auto acc = StiffnessAccumulator(sizes, beta);
+    acc.Add(std::vector<long>{ 1, 0, -1 });
+    acc.Add(std::vector<long>{ 0, 2, 0 });
+
+    REQUIRE(acc.GetDim() == 3UL);
+    REQUIRE(acc.Count() == 2UL);
+    REQUIRE(acc.MeanWindingSquared(0) == Approx(0.5));
+    REQUIRE(acc.MeanWindingSquared(1) == Approx(2.0));
+    REQUIRE(acc.MeanWindingSquared(2) == Approx(0.5));
+
+    // <W^2> L^(2 - d) / (d beta)
+    REQUIRE(acc.Stiffness() == Approx(3.0 / 4.0 / (3.0 * beta)));
+  }
+
+  SECTION("Rectangular grid")
+  {
+    auto acc = StiffnessAccumulator(std::array<std::size_t, 2>{ 2, 8 }, beta);
+    acc.Add(std::array<long, 2>{ 3, -1 });
+    const auto expected = (9.0 * 4.0 + 64.0) / (2.0 * beta * 16.0);
+    REQUIRE(acc.Stiffness() == Approx(expected));
+  }
+
+  SECTION("Empty accumulator")
+  {
+    auto acc = StiffnessAccumulator(std::vector<unsigned long>{ 4, 4 }, beta);
+    REQUIRE(acc.Count() == 0UL);
+    REQUIRE(acc.MeanWindingSquared(0) == 0.0);
+    REQUIRE(acc.Stiffness() == 0.0);
+  }
+
+  SECTION("Reset")
+  {
+    auto acc = StiffnessAccumulator(std::vector<unsigned long>{ 4 }, beta, 2UL);
+    acc.Add(std::vector<long>{ 1 });
+    acc.Add(std::vector<long>{ 1 });
+    acc.Add(std::vector<long>{ 1 });
+    REQUIRE(acc.NumBins() == 1UL);
+    acc.Reset();
+    REQUIRE(acc.Count() == 0UL);
+    REQUIRE(acc.NumBins() == 0UL);
+    acc.Add(std::vector<long>{ 2 });
+    REQUIRE(acc.MeanWindingSquared(0) == Approx(4.0));
+  }
+}
+
+TEST_CASE("binning errors", "[StiffnessAccumulator]")
+{
+  const auto sizes = std::vector<unsigned long>{ 6, 6 };
+  const auto beta = 2.0;
+  const auto binsize = 10UL;
+  auto rng = std::mt19937_64(1234UL);
+  auto dist = std::uniform_int_distribution<long>(-3L, 3L);
+
+  auto acc = StiffnessAccumulator(sizes, beta, binsize);
+  auto bins = KnuthWelfordAccumulator();
+  auto bin = std::array<double, 2>{ 0.0, 0.0 };
+  for (auto i = 0UL; i < 1000UL; i++) {
+    const auto w = std::array<long, 2>{ dist(rng), dist(rng) };
+    acc.Add(w);
+    bin[0] += static_cast<double>(w[0] * w[0]);
+    bin[1] += static_cast<double>(w[1] * w[1]);
+    if ((i + 1UL) % binsize == 0UL) {
+      bins.Add((bin[0] + bin[1]) / static_cast<double>(binsize) /
+               (2.0 * beta));
+      bin = { 0.0, 0.0 };
+    }
+  }
+
+  REQUIRE(acc.NumBins() == 100UL);
+  REQUIRE(acc.Stiffness() == Approx(bins.Mean()));
+  REQUIRE(acc.StiffnessError() == Approx(bins.Error(true)));
+  REQUIRE(acc.MeanWindingSquared(0) == Approx(4.0).epsilon(0.1));
+  REQUIRE(acc.WindingSquaredError(0) > 0.0);
+}
+
+TEST_CASE("merging accumulators", "[StiffnessAccumulator]")
+{
+  const auto sizes = std::vector<unsigned long>{ 8, 8, 8 };
+  const auto binsize = 4UL;
+  auto rng = std::mt19937_64(42UL);
+  auto dist = std::uniform_int_distribution<long>(-2L, 2L);
+
+  auto all = StiffnessAccumulator(sizes, 1.0, binsize);
+  auto first = StiffnessAccumulator(sizes, 1.0, binsize);
+  auto second = StiffnessAccumulator(sizes, 1.0, binsize);
+  for (auto i = 0UL; i < 400UL; i++) {
+    const auto w = std::vector<long>{ dist(rng), dist(rng), dist(rng) };
+    all.Add(w);
+    (i < 200UL ? first : second).Add(w);
+  }
+  first.Merge(second);
+
+  REQUIRE(first.Count() == all.Count());
+  REQUIRE(first.NumBins() == all.NumBins());
+  REQUIRE(first.Stiffness() == Approx(all.Stiffness()));
+  REQUIRE(first.StiffnessError() == Approx(all.StiffnessError()));
+  for (auto d = 0UL; d < 3UL; d++) {
+    REQUIRE(first.MeanWindingSquared(d) == Approx(all.MeanWindingSquared(d)));
+    REQUIRE(first.WindingSquaredError(d) ==
+            Approx(all.WindingSquaredError(d)));
+  }
+
+  SECTION("Incomplete bins are carried over")
+  {
+    auto a = StiffnessAccumulator(sizes, 1.0, binsize);
+    auto b = StiffnessAccumulator(sizes, 1.0, binsize);
+    for (auto i = 0UL; i < 3UL; i++) {
+      a.Add(std::vector<long>{ 1, 0, 0 });
+      b.Add(std::vector<long>{ 0, 1, 0 });
+    }
+    a.Merge(b);
+    REQUIRE(a.NumBins() == 0UL);
+    REQUIRE(a.Count() == 6UL);
+    REQUIRE(a.MeanWindingSquared(0) == Approx(0.5));
+
+    // the open bin of a is completed by its own measurements only
+    a.Add(std::vector<long>{ 1, 0, 0 });
+    REQUIRE(a.NumBins() == 1UL);
+    REQUIRE(a.Count() == 7UL);
+    REQUIRE(a.MeanWindingSquared(0) == Approx(4.0 / 7.0));
+    REQUIRE(a.Stiffness() == Approx(7.0 / 7.0 / 3.0 * 64.0 / 512.0));
+  }
+}
+
+TEST_CASE("serialization round trip", "[StiffnessAccumulator]")
+{
+  const auto sizes = std::vector<unsigned long>{ 6, 4 };
+  auto rng = std::mt19937_64(7UL);
+  auto dist = std::uniform_int_distribution<long>(-3L, 3L);
+
+  auto acc = StiffnessAccumulator(sizes, 0.25, 5UL);
+  for (auto i = 0UL; i < 53UL; i++) {
+    acc.Add(std::array<long, 2>{ dist(rng), dist(rng) });
+  }
+  auto other = StiffnessAccumulator(sizes, 0.25, 5UL);
+  other.Add(std::array<long, 2>{ 2, -1 });
+  acc.Merge(other);
+
+  auto stream = std::stringstream();
+  {
+    auto oa = boost::archive::text_oarchive(stream);
+    oa << acc;
+  }
+  auto loaded = StiffnessAccumulator();
+  {
+    auto ia = boost::archive::text_iarchive(stream);
+    ia >> loaded;
+  }
+
+  REQUIRE(loaded.GetDim() == acc.GetDim());
+  REQUIRE(loaded.Count() == acc.Count());
+  REQUIRE(loaded.NumBins() == acc.NumBins());
+  REQUIRE(loaded.Stiffness() == Approx(acc.Stiffness()));
+  REQUIRE(loaded.StiffnessError() == Approx(acc.StiffnessError()));
+  for (auto d = 0UL; d < sizes.size(); d++) {
+    REQUIRE(loaded.MeanWindingSquared(d) == Approx(acc.MeanWindingSquared(d)));
+    REQUIRE(loaded.WindingSquaredError(d) ==
+            Approx(acc.WindingSquaredError(d)));
+  }
+
+  // the loaded accumulator keeps binning where the saved one stopped
+  for (auto i = 0UL; i < 2UL; i++) {
+    acc.Add(std::array<long, 2>{ 1, 1 });
+    loaded.Add(std::array<long, 2>{ 1, 1 });
+  }
+  REQUIRE(loaded.NumBins() == acc.NumBins());
+  REQUIRE(loaded.StiffnessError() == Approx(acc.StiffnessError()));
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
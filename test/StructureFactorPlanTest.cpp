@@ -0,0 +1,84 @@
+//===-- StructureFactorPlanTest.cpp ----------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the StructureFactorPlan Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/Lattice.hpp>
+#include <bwsl/StructureFactorPlan.hpp>
+
+// std
+#include <random>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+using CApprox = Catch::Approx;
+
+TEST_CASE("Batched structure factor", "[sk]")
+{
+  auto structure = Lattice(TriangularLattice, { 6UL, 5UL });
+  auto nsites = structure.GetNumSites();
+
+  auto rng = std::mt19937_64{ 11UL };
+  auto dist = std::uniform_int_distribution<int>{ 0, 2 };
+
+  // more snapshots than a single batch
+  auto snapshots = std::vector<std::vector<int>>(70, std::vector<int>(nsites));
+  for (auto& snapshot : snapshots) {
+    for (auto& n : snapshot) {
+      n = dist(rng);
+    }
+  }
+
+  SECTION("All the momenta")
+  {
+    auto plan = StructureFactorPlan(structure);
+    REQUIRE(plan.GetNumMomenta() == nsites);
+
+    auto sks = plan.Compute(snapshots, 0.5);
+    auto total = std::vector<double>(nsites, 0.0);
+    plan.Accumulate(snapshots, total);
+
+    auto expected_total = std::vector<double>(nsites, 0.0);
+    for (auto s = 0UL; s < snapshots.size(); s++) {
+      auto expected = structure.ComputeSk(snapshots[s], 0.5);
+      structure.AccumulateSk(snapshots[s], expected_total);
+      for (auto k = 0UL; k < nsites; k++) {
+        REQUIRE(sks[s][k] == CApprox(expected[k]).margin(1e-12));
+      }
+    }
+    for (auto k = 0UL; k < nsites; k++) {
+      REQUIRE(total[k] == CApprox(expected_total[k]).margin(1e-10));
+    }
+  }
+
+  SECTION("A subset of the momenta")
+  {
+    auto momenta = std::vector<size_t>{ 0UL, 7UL, 13UL, 29UL };
+    auto plan = StructureFactorPlan(structure, momenta);
+    REQUIRE(plan.GetNumMomenta() == momenta.size());
+
+    auto sks = plan.Compute(snapshots);
+    for (auto s = 0UL; s < snapshots.size(); s++) {
+      auto expected = structure.ComputeSk(snapshots[s]);
+      for (auto k = 0UL; k < momenta.size(); k++) {
+        REQUIRE(sks[s][k] == CApprox(expected[momenta[k]]).margin(1e-12));
+      }
+    }
+  }
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
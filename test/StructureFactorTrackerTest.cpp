@@ -0,0 +1,82 @@
+//===-- StructureFactorTrackerTest.cpp -------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the StructureFactorTracker Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/Lattice.hpp>
+#include <bwsl/StructureFactorTracker.hpp>
+
+// std
+#include <random>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+using CApprox = Catch::Approx;
+
+TEST_CASE("Incremental structure factor", "[sk]")
+{
+  auto morton = LatticeOptions{};
+  morton.ordering = GridOrdering::Morton;
+  auto lattices = std::vector<Lattice>{
+    Lattice(ChainLattice, { 9UL }),
+    Lattice(TriangularLattice, { 4UL, 6UL }),
+    Lattice(CubicLattice, { 3UL, 4UL, 2UL }),
+    Lattice(TriangularLattice, { 4UL, 6UL }, GridBoundaries::Closed, morton),
+    Lattice(CubicLattice, { 3UL, 4UL, 2UL }, GridBoundaries::Closed, morton),
+  };
+
+  auto rng = std::mt19937_64{ 3UL };
+
+  for (auto const& structure : lattices) {
+    auto nsites = structure.GetNumSites();
+    auto site = std::uniform_int_distribution<size_t>{ 0UL, nsites - 1UL };
+    auto occupations = std::vector<int>(nsites, 0);
+    for (auto i = 0UL; i < nsites; i += 2UL) {
+      occupations[i] = 1;
+    }
+
+    auto tracker = StructureFactorTracker(structure);
+    REQUIRE(tracker.GetNumMomenta() == nsites);
+    tracker.Reset(occupations);
+
+    auto expected = structure.ComputeSk(occupations);
+    for (auto k = 0UL; k < nsites; k++) {
+      REQUIRE(tracker.GetSk(k) == CApprox(expected[k]).margin(1e-12));
+    }
+
+    for (auto step = 0; step < 50; step++) {
+      auto from = site(rng);
+      auto to = site(rng);
+      if (occupations[from] == 0) {
+        occupations[to] += 1;
+        tracker.Update(to, 1.0);
+      } else {
+        occupations[from] -= 1;
+        occupations[to] += 1;
+        tracker.Move(from, to);
+      }
+    }
+
+    auto sk = tracker.ComputeSk(3.0);
+    expected = structure.ComputeSk(occupations, 3.0);
+    for (auto k = 0UL; k < nsites; k++) {
+      REQUIRE(sk[k] == CApprox(expected[k]).margin(1e-10));
+    }
+  }
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
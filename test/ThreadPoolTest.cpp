@@ -0,0 +1,101 @@
+//===-- ThreadPoolTest.cpp -------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the ThreadPool Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/ThreadPool.hpp>
+
+// std
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+// catch
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+TEST_CASE("Parallel loops", "[threads]")
+{
+  for (auto numthreads : { 1UL, 2UL, 4UL, 0UL }) {
+    auto pool = ThreadPool(numthreads);
+    REQUIRE(pool.GetNumThreads() >= 1UL);
+
+    // every iteration is executed exactly once
+    for (auto grain : { 0UL, 1UL, 7UL, 1000UL }) {
+      auto counts = std::vector<int>(1000UL, 0);
+      pool.ParallelFor(
+        0UL, counts.size(), [&](size_t i) { counts[i]++; }, grain);
+      for (auto c : counts) {
+        REQUIRE(c == 1);
+      }
+    }
+
+    // the pool can be reused and ranges can start anywhere
+    auto sum = std::atomic<size_t>(0UL);
+    pool.ParallelFor(10UL, 20UL, [&](size_t i) { sum += i; });
+    REQUIRE(sum == 145UL);
+    pool.ParallelFor(5UL, 5UL, [&](size_t /*i*/) { sum += 1UL; });
+    REQUIRE(sum == 145UL);
+
+    // exceptions are propagated to the caller
+    REQUIRE_THROWS_AS(pool.ParallelFor(0UL,
+                                       100UL,
+                                       [](size_t i) {
+                                         if (i == 42UL) {
+                                           throw std::runtime_error("42");
+                                         }
+                                       }),
+                      std::runtime_error);
+  }
+}
+
+TEST_CASE("Nested parallel loops", "[threads]")
+{
+  auto pool = ThreadPool(4UL);
+  auto other = ThreadPool(2UL);
+
+  // the inner loops run serially instead of waiting for the busy threads
+  for (auto* inner : { &pool, &other }) {
+    auto counts = std::vector<std::atomic<int>>(64UL * 64UL);
+    pool.ParallelFor(
+      0UL,
+      64UL,
+      [&](size_t i) {
+        inner->ParallelFor(
+          0UL, 64UL, [&](size_t j) { counts[i * 64UL + j]++; }, 1UL);
+      },
+      1UL);
+    for (auto const& c : counts) {
+      REQUIRE(c.load() == 1);
+    }
+  }
+
+  // exceptions of the inner loops reach the outer caller
+  auto throwing = [&](size_t i) {
+    pool.ParallelFor(0UL, 8UL, [&](size_t j) {
+      if (i * j == 21UL) {
+        throw std::runtime_error("21");
+      }
+    });
+  };
+  REQUIRE_THROWS_AS(pool.ParallelFor(0UL, 8UL, throwing, 1UL),
+                    std::runtime_error);
+
+  // the pool is still usable in parallel afterwards
+  auto sum = std::atomic<size_t>(0UL);
+  pool.ParallelFor(0UL, 100UL, [&](size_t i) { sum += i; }, 1UL);
+  REQUIRE(sum == 4950UL);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,174 @@
+//===-- TileDecompositionTest.cpp ------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the TileDecomposition Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/Lattice.hpp>
+#include <bwsl/ThreadPool.hpp>
+#include <bwsl/TileDecomposition.hpp>
+
+// std
+#include <atomic>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+// catch
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+namespace {
+
+template<class... Tables>
+auto
+check_tiles(Lattice const& lattice,
+            TileDecomposition const& tiles,
+            Tables const&... tables) -> void
+{
+  const auto n = lattice.GetNumSites();
+  REQUIRE(tiles.GetNumSites() == n);
+
+  auto total = 0UL;
+  for (auto t = 0UL; t < tiles.GetNumTiles(); t++) {
+    auto sites = tiles.GetSites(t);
+    total += sites.size();
+
+    // the halo holds the neighbors outside of the tile
+    auto expected = std::set<std::size_t>{};
+    for (auto i : sites) {
+      REQUIRE(tiles.GetTile(i) == t);
+      auto collect = [&](auto const& table) {
+        for (auto j : table.GetNeighbors(i)) {
+          if (tiles.GetTile(j) != t) {
+            expected.insert(j);
+          }
+        }
+      };
+      (collect(tables), ...);
+    }
+    auto halo = tiles.GetHalo(t);
+    REQUIRE(std::set<std::size_t>(halo.begin(), halo.end()) == expected);
+  }
+  REQUIRE(total == n);
+
+  // the tiles of a phase do not touch their halos
+  for (auto p = 0UL; p < tiles.GetNumPhases(); p++) {
+    for (auto t : tiles.GetTiles(p)) {
+      REQUIRE(tiles.GetPhase(t) == p);
+      for (auto j : tiles.GetHalo(t)) {
+        REQUIRE(tiles.GetPhase(tiles.GetTile(j)) != p);
+      }
+    }
+  }
+}
+
+} // namespace
+
+TEST_CASE("Tile sizes", "[tiles]")
+{
+  // 8 bytes per site, (62 + 2)^2 * 8 = 32 KiB
+  REQUIRE(TileDecomposition::GetTileSide(2UL, 8UL, 1UL, 32768UL) == 62UL);
+  REQUIRE(TileDecomposition::GetTileSide(3UL, 8UL, 2UL, 1UL) == 1UL);
+  auto side = TileDecomposition::GetTileSide(3UL, 16UL);
+  REQUIRE((side + 2UL) * (side + 2UL) * (side + 2UL) * 16UL <=
+          TileDecomposition::DefaultCacheBytes);
+}
+
+TEST_CASE("Tiles of lattices", "[lattice][tiles]")
+{
+  SECTION("Square lattice")
+  {
+    auto lattice = Lattice(SquareLattice, { 16UL, 16UL });
+    auto tiles = TileDecomposition(
+      lattice, { 4UL, 4UL }, lattice.GetNeighborTable());
+    REQUIRE(tiles.GetNumTiles() == 16UL);
+    REQUIRE(tiles.GetNumPhases() == 2UL);
+    for (auto t = 0UL; t < tiles.GetNumTiles(); t++) {
+      REQUIRE(tiles.GetSites(t).size() == 16UL);
+      REQUIRE(tiles.GetHalo(t).size() == 16UL);
+    }
+    check_tiles(lattice, tiles, lattice.GetNeighborTable());
+  }
+
+  SECTION("Next nearest neighbors")
+  {
+    auto lattice = Lattice(SquareLattice, { 12UL, 12UL });
+    auto const& diagonal = lattice.GetShellNeighborTable(2UL);
+    auto tiles = TileDecomposition(
+      lattice, { 4UL, 4UL }, lattice.GetNeighborTable(), diagonal);
+    REQUIRE(tiles.GetHalo(0UL).size() == 20UL);
+    REQUIRE(tiles.GetNumPhases() > 2UL);
+    check_tiles(lattice, tiles, lattice.GetNeighborTable(), diagonal);
+  }
+
+  SECTION("Uneven tiles")
+  {
+    auto lattice = Lattice(TriangularLattice, { 10UL, 7UL });
+    auto tiles = TileDecomposition(
+      lattice, { 4UL, 3UL }, lattice.GetNeighborTable());
+    REQUIRE(tiles.GetNumTiles() == 9UL);
+    check_tiles(lattice, tiles, lattice.GetNeighborTable());
+  }
+
+  SECTION("Open boundaries and Morton ordering")
+  {
+    auto options = LatticeOptions{};
+    options.ordering = GridOrdering::Morton;
+    auto lattice =
+      Lattice(CubicLattice, { 8UL, 8UL, 8UL }, GridBoundaries::Open, options);
+    auto tiles = TileDecomposition(
+      lattice, { 4UL, 4UL, 4UL }, lattice.GetNeighborTable());
+    REQUIRE(tiles.GetNumTiles() == 8UL);
+    REQUIRE(tiles.GetHalo(0UL).size() == 48UL);
+    check_tiles(lattice, tiles, lattice.GetNeighborTable());
+  }
+}
+
+TEST_CASE("Tiled sweeps", "[tiles]")
+{
+  auto lattice = Lattice(SquareLattice, { 24UL, 20UL });
+  auto tiles =
+    TileDecomposition(lattice, { 6UL, 5UL }, lattice.GetNeighborTable());
+  const auto n = lattice.GetNumSites();
+
+  auto pool = ThreadPool(4UL);
+  auto visits = std::vector<std::atomic<int>>(n);
+  tiles.Sweep(pool, [&](std::size_t i) { visits[i]++; });
+  for (auto const& v : visits) {
+    REQUIRE(v.load() == 1);
+  }
+
+  // updates in order inside each tile give the same result with any number
+  // of threads
+  auto run = [&](std::size_t numthreads) {
+    auto threads = ThreadPool(numthreads);
+    auto state = std::vector<std::int64_t>(n);
+    for (auto i = 0UL; i < n; i++) {
+      state[i] = static_cast<std::int64_t>(i % 11UL);
+    }
+    for (auto sweep = 0; sweep < 5; sweep++) {
+      tiles.Sweep(threads, [&](std::size_t i) {
+        auto sum = std::int64_t{ 0 };
+        for (auto j : lattice.GetNeighbors(i)) {
+          sum += state[j];
+        }
+        state[i] = (5 * state[i] + sum) % 1013;
+      });
+    }
+    return state;
+  };
+  REQUIRE(run(1UL) == run(4UL));
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
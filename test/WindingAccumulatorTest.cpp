@@ -0,0 +1,212 @@
+//===-- WindingAccumulatorTest.cpp -----------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the JumpTable and BasicWindingAccumulator Classes
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/JumpTable.hpp>
+#include <bwsl/Lattice.hpp>
+#include <bwsl/WindingAccumulator.hpp>
+
+// std
+#include <random>
+#include <vector>
+
+// catch
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+namespace {
+
+/// Walk @p numsteps random hops on @p lattice , checking the accumulated
+/// displacement and winding against GetJump and GetWinding
+template<class L, std::size_t D>
+auto
+check_walk(L const& lattice,
+           BasicWindingAccumulator<D> winding,
+           std::size_t numsteps) -> void
+{
+  auto const& table = lattice.GetNeighborTable();
+  auto const& jumps = lattice.GetJumpTable();
+  const auto dim = lattice.GetDim();
+  REQUIRE(jumps.GetNumSites() == lattice.GetNumSites());
+  REQUIRE(jumps.GetDim() == dim);
+
+  auto rng = std::mt19937_64(42UL);
+  auto a = 0UL;
+  auto path = std::vector<std::pair<std::size_t, std::size_t>>{};
+  auto sum = std::vector<long>(dim, 0L);
+  for (auto step = 0UL; step < numsteps; step++) {
+    const auto slot = rng() % table.GetCoordination(a);
+    const auto b = table.GetNeighbor(a, slot);
+    const auto jump = lattice.GetJump(a, b);
+    for (auto d = 0UL; d < dim; d++) {
+      sum[d] += jump[d];
+    }
+    winding.Hop(jumps, a, slot);
+    path.emplace_back(a, slot);
+    a = b;
+
+    // the displacement differs from the minimal images by whole windings
+    const auto x = lattice.GetCoordinates(a);
+    for (auto d = 0UL; d < dim; d++) {
+      const auto size = static_cast<long>(lattice.GetSize()[d]);
+      REQUIRE(winding.GetDisplacement(d) ==
+              x[d] - lattice.GetCoordinates(0UL)[d] +
+                winding.GetWinding(d) * size);
+      REQUIRE((winding.GetDisplacement(d) - sum[d]) % size == 0L);
+    }
+  }
+
+  // back to the origin along the shortest path, the loop is then closed
+  while (a != 0UL) {
+    auto best = 0UL;
+    auto distance = lattice.GetDistance(a, 0UL);
+    for (auto slot = 0UL; slot < table.GetCoordination(a); slot++) {
+      const auto d = lattice.GetDistance(table.GetNeighbor(a, slot), 0UL);
+      if (d < distance) {
+        best = slot;
+        distance = d;
+      }
+    }
+    const auto b = table.GetNeighbor(a, best);
+    const auto jump = lattice.GetJump(a, b);
+    for (auto d = 0UL; d < dim; d++) {
+      sum[d] += jump[d];
+    }
+    winding.Hop(jumps, a, best);
+    path.emplace_back(a, best);
+    a = b;
+  }
+  for (auto d = 0UL; d < dim; d++) {
+    const auto size = static_cast<long>(lattice.GetSize()[d]);
+    REQUIRE(winding.GetDisplacement(d) == winding.GetWinding(d) * size);
+  }
+
+  // with sides longer than two the minimal images follow the path
+  auto sides = true;
+  for (auto d = 0UL; d < dim; d++) {
+    sides = sides && lattice.GetSize()[d] > 2UL;
+  }
+  if (sides) {
+    auto coords = typename L::coords_t{};
+    if constexpr (D == DynamicDim) {
+      coords.resize(dim);
+    }
+    std::copy(sum.begin(), sum.end(), coords.begin());
+    const auto expected = lattice.GetWinding(coords);
+    for (auto d = 0UL; d < dim; d++) {
+      REQUIRE(winding.GetWinding(d) == expected[d]);
+    }
+  }
+
+  // retracting the path forgets everything
+  while (!path.empty()) {
+    winding.Unhop(jumps, path.back().first, path.back().second);
+    path.pop_back();
+  }
+  REQUIRE(winding.IsZero());
+  for (auto d = 0UL; d < dim; d++) {
+    REQUIRE(winding.GetDisplacement(d) == 0L);
+  }
+}
+
+} // namespace
+
+TEST_CASE("JumpTable", "[JumpTable]")
+{
+  SECTION("Square lattice")
+  {
+    auto lattice = Lattice(SquareLattice, { 4UL, 3UL });
+    auto const& jumps = lattice.GetJumpTable();
+    auto const& table = lattice.GetNeighborTable();
+
+    // right from the last column and up from the last row wrap around
+    const auto a = lattice.GetIndex({ 3L, 2L });
+    for (auto slot = 0UL; slot < table.GetCoordination(a); slot++) {
+      const auto v = jumps.GetDisplacement(a, slot);
+      const auto w = jumps.GetWinding(a, slot);
+      REQUIRE(w[0] == (v[0] > 0 ? 1 : 0));
+      REQUIRE(w[1] == (v[1] > 0 ? 1 : 0));
+      REQUIRE(jumps.CrossesBoundary(a, slot) == (v[0] > 0 || v[1] > 0));
+    }
+    const auto o = lattice.GetIndex({ 0L, 0L });
+    for (auto slot = 0UL; slot < table.GetCoordination(o); slot++) {
+      const auto v = jumps.GetDisplacement(o, slot);
+      const auto w = jumps.GetWinding(o, slot);
+      REQUIRE(w[0] == (v[0] < 0 ? -1 : 0));
+      REQUIRE(w[1] == (v[1] < 0 ? -1 : 0));
+    }
+  }
+
+  SECTION("Open boundaries")
+  {
+    auto lattice = Lattice(SquareLattice, { 4UL, 3UL }, GridBoundaries::Open);
+    auto const& jumps = lattice.GetJumpTable();
+    auto const& table = lattice.GetNeighborTable();
+    for (auto a = 0UL; a < lattice.GetNumSites(); a++) {
+      for (auto slot = 0UL; slot < table.GetCoordination(a); slot++) {
+        REQUIRE(!jumps.CrossesBoundary(a, slot));
+      }
+    }
+  }
+}
+
+TEST_CASE("WindingAccumulator", "[WindingAccumulator]")
+{
+  SECTION("Square lattice")
+  {
+    auto lattice = Lattice(SquareLattice, { 5UL, 4UL });
+    check_walk(lattice, WindingAccumulator(2UL), 2000UL);
+  }
+
+  SECTION("Triangular lattice")
+  {
+    auto lattice = Lattice(TriangularLattice, { 6UL, 3UL });
+    check_walk(lattice, WindingAccumulator(2UL), 2000UL);
+  }
+
+  SECTION("Small chain")
+  {
+    auto lattice = Lattice(ChainLattice, { 2UL });
+    check_walk(lattice, WindingAccumulator(1UL), 100UL);
+  }
+
+  SECTION("Cubic lattice with fixed dimension")
+  {
+    auto lattice = Lattice3D(CubicLattice, { 3UL, 4UL, 5UL });
+    check_walk(lattice, WindingAccumulator3D(), 2000UL);
+  }
+
+  SECTION("Open boundaries")
+  {
+    auto lattice = Lattice(SquareLattice, { 4UL, 3UL }, GridBoundaries::Open);
+    auto winding = WindingAccumulator(2UL);
+    auto const& jumps = lattice.GetJumpTable();
+    auto const& table = lattice.GetNeighborTable();
+    auto rng = std::mt19937_64(7UL);
+    auto a = 0UL;
+    for (auto step = 0UL; step < 500UL; step++) {
+      const auto slot = rng() % table.GetCoordination(a);
+      winding.Hop(jumps, a, slot);
+      a = table.GetNeighbor(a, slot);
+      REQUIRE(winding.IsZero());
+      REQUIRE(winding.GetDisplacement(0UL) == lattice.GetCoordinates(a)[0]);
+      REQUIRE(winding.GetDisplacement(1UL) == lattice.GetCoordinates(a)[1]);
+    }
+    winding.Reset();
+    REQUIRE(winding.GetDisplacement(0UL) == 0L);
+  }
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //